@@ -12,14 +12,23 @@ from esphome.const import (
        CONF_TRIGGER_ID,
        CONF_TYPE,
        CONF_NUMBER,
+       CONF_SIZE,
        CONF_VALUE,
        ENTITY_CATEGORY_DIAGNOSTIC,
        STATE_CLASS_MEASUREMENT,
+       STATE_CLASS_TOTAL_INCREASING,
+       UNIT_MILLISECOND,
+       UNIT_PERCENT,
 )
 
 DEPENDENCIES = ["uart"]
 
 CONF_IGNORE_MCU_UPDATE_ON_DATAPOINTS = "ignore_mcu_update_on_datapoints"
+CONF_DATAPOINT_POLICIES = "datapoint_policies"
+CONF_IGNORE = "ignore"
+CONF_DROP_DUPLICATES = "drop_duplicates"
+CONF_MIN_INTERVAL = "min_interval"
+CONF_INTEGER_DEADBAND = "integer_deadband"
 
 CONF_REPORT_AP_NAME = "report_ap_name"
 CONF_ON_DATAPOINT_UPDATE = "on_datapoint_update"
@@ -33,6 +42,49 @@ CONF_UNKNOWN_EXTENDED_COMMANDS = "unknown_extended_commands"
 CONF_UNHANDLED_DATAPOINTS = "unhandled_datapoints"
 CONF_PAIRING_MODE = "pairing_mode"
 CONF_PRODUCT = "product"
+CONF_FRAMES_RECEIVED = "frames_received"
+CONF_FRAMES_SENT = "frames_sent"
+CONF_CHECKSUM_ERRORS = "checksum_errors"
+CONF_RESPONSE_TIMEOUTS = "response_timeouts"
+CONF_COMMAND_RETRIES = "command_retries"
+CONF_DROPPED_COMMANDS = "dropped_commands"
+CONF_QUEUE_HIGH_WATER_MARK = "queue_high_water_mark"
+CONF_RX_BYTES_PER_SECOND = "rx_bytes_per_second"
+CONF_TX_BYTES_PER_SECOND = "tx_bytes_per_second"
+CONF_RX_UTILISATION = "rx_utilisation"
+CONF_TX_UTILISATION = "tx_utilisation"
+CONF_DATAPOINT_WRITE_HEADROOM = "datapoint_write_headroom"
+CONF_COMMAND_STATISTICS = "command_statistics"
+CONF_PUBLISH_INTERVAL = "publish_interval"
+CONF_DATAPOINT_STATISTICS = "datapoint_statistics"
+CONF_RX_TO_DISPATCH_LATENCY = "rx_to_dispatch_latency"
+CONF_SET_TO_TX_LATENCY = "set_to_tx_latency"
+CONF_TX_TO_REPORT_LATENCY = "tx_to_report_latency"
+CONF_P50 = "p50"
+CONF_P95 = "p95"
+CONF_MAX = "max"
+LATENCY_INTERVALS = (
+    CONF_RX_TO_DISPATCH_LATENCY,
+    CONF_SET_TO_TX_LATENCY,
+    CONF_TX_TO_REPORT_LATENCY,
+)
+LATENCY_STATISTICS = (CONF_P50, CONF_P95, CONF_MAX)
+CONF_MEMORY_USAGE = "memory_usage"
+CONF_MEMORY_USED = "memory_used"
+CONF_MEMORY_PEAK = "memory_peak"
+
+CONF_PROFILER = "profiler"
+CONF_FRAME_TRACE = "frame_trace"
+CONF_PAYLOAD_BYTES = "payload_bytes"
+CONF_FORMAT = "format"
+CONF_WINDOW = "window"
+CONF_SLOW_LISTENER_THRESHOLD = "slow_listener_threshold"
+CONF_SUMMARY = "summary"
+CONF_MAX_LOOP_TIME = "max_loop_time"
+
+UNIT_BYTES_PER_SECOND = "B/s"
+UNIT_BYTES = "B"
+UNIT_WRITES_PER_SECOND = "writes/s"
 CONF_UYAT_ID = "uyat_id"
 
 uyat_ns = cg.esphome_ns.namespace("uyat")
@@ -44,7 +96,14 @@ UyatDatapoint = uyat_ns.class_("UyatDatapoint")
 FactoryResetType = uyat_ns.enum("FactoryResetType")
 Uyat = uyat_ns.class_("Uyat", cg.Component, uart.UARTDevice)
 MatchingDatapoint = uyat_ns.class_("MatchingDatapoint")
+DatapointPolicy = uyat_ns.struct("DatapointPolicy")
 UyatFactoryResetAction = uyat_ns.class_("FactoryResetAction", automation.Action)
+UyatDumpFrameTraceAction = uyat_ns.class_("DumpFrameTraceAction", automation.Action)
+FrameTraceDumpFormat = uyat_ns.enum("FrameTraceDumpFormat", is_class=True)
+FRAME_TRACE_DUMP_FORMATS = {
+    "TEXT": FrameTraceDumpFormat.TEXT,
+    "HEX": FrameTraceDumpFormat.HEX,
+}
 
 FACTORY_RESET_TYPES = {
     "HW": FactoryResetType.BY_HW,
@@ -155,6 +214,9 @@ def assign_declare_id(value):
 
 UYAT_DIAGNOSTIC_SENSORS_SCHEMA = cv.Schema(
     {
+        cv.Optional(
+            CONF_PUBLISH_INTERVAL, default="1s"
+        ): cv.positive_time_period_milliseconds,
         cv.Optional(CONF_PRODUCT): esphome_text_sensor.text_sensor_schema(
             entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
         ),
@@ -175,20 +237,162 @@ UYAT_DIAGNOSTIC_SENSORS_SCHEMA = cv.Schema(
         cv.Optional(CONF_PAIRING_MODE): esphome_text_sensor.text_sensor_schema(
             entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
         ),
+        **{
+            cv.Optional(counter): esphome_sensor.sensor_schema(
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            )
+            for counter in (
+                CONF_FRAMES_RECEIVED,
+                CONF_FRAMES_SENT,
+                CONF_CHECKSUM_ERRORS,
+                CONF_RESPONSE_TIMEOUTS,
+                CONF_COMMAND_RETRIES,
+                CONF_DROPPED_COMMANDS,
+            )
+        },
+        cv.Optional(CONF_QUEUE_HIGH_WATER_MARK): esphome_sensor.sensor_schema(
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        **{
+            cv.Optional(rate): esphome_sensor.sensor_schema(
+                unit_of_measurement=UNIT_BYTES_PER_SECOND,
+                accuracy_decimals=1,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            )
+            for rate in (CONF_RX_BYTES_PER_SECOND, CONF_TX_BYTES_PER_SECOND)
+        },
+        **{
+            cv.Optional(utilisation): esphome_sensor.sensor_schema(
+                unit_of_measurement=UNIT_PERCENT,
+                accuracy_decimals=1,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            )
+            for utilisation in (CONF_RX_UTILISATION, CONF_TX_UTILISATION)
+        },
+        cv.Optional(CONF_DATAPOINT_WRITE_HEADROOM): esphome_sensor.sensor_schema(
+            unit_of_measurement=UNIT_WRITES_PER_SECOND,
+            accuracy_decimals=1,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_COMMAND_STATISTICS): esphome_text_sensor.text_sensor_schema(
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_DATAPOINT_STATISTICS): esphome_text_sensor.text_sensor_schema(
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        **{
+            cv.Optional(interval): cv.Schema(
+                {
+                    cv.Optional(statistic): esphome_sensor.sensor_schema(
+                        unit_of_measurement=UNIT_MILLISECOND,
+                        accuracy_decimals=3,
+                        state_class=STATE_CLASS_MEASUREMENT,
+                        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+                    )
+                    for statistic in LATENCY_STATISTICS
+                }
+            )
+            for interval in LATENCY_INTERVALS
+        },
+        cv.Optional(CONF_MEMORY_USAGE): esphome_text_sensor.text_sensor_schema(
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        **{
+            cv.Optional(memory): esphome_sensor.sensor_schema(
+                unit_of_measurement=UNIT_BYTES,
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            )
+            for memory in (CONF_MEMORY_USED, CONF_MEMORY_PEAK)
+        },
+    }
+)
+
+
+DATAPOINT_POLICY_SCHEMA = cv.Schema(
+    {
+        cv.Required(CONF_DATAPOINT): cv.uint8_t,
+        cv.Optional(CONF_IGNORE, default=False): cv.boolean,
+        cv.Optional(CONF_DROP_DUPLICATES, default=False): cv.boolean,
+        cv.Optional(
+            CONF_MIN_INTERVAL, default="0ms"
+        ): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_INTEGER_DEADBAND, default=0): cv.uint32_t,
+    }
+)
+
+
+def validate_datapoint_policies(config):
+    # one policy per datapoint, the C++ table keeps only the last one set for a datapoint
+    ignored = set(config.get(CONF_IGNORE_MCU_UPDATE_ON_DATAPOINTS, []))
+    seen = set()
+    for policy in config.get(CONF_DATAPOINT_POLICIES, []):
+        dp = policy[CONF_DATAPOINT]
+        if dp in seen:
+            raise cv.Invalid(
+                f"Datapoint {dp} has more than one entry in {CONF_DATAPOINT_POLICIES}"
+            )
+        if dp in ignored:
+            raise cv.Invalid(
+                f"Datapoint {dp} is in both {CONF_IGNORE_MCU_UPDATE_ON_DATAPOINTS} and {CONF_DATAPOINT_POLICIES}, "
+                f"use '{CONF_IGNORE}: true' in its policy instead"
+            )
+        seen.add(dp)
+    return config
+
+
+UYAT_PROFILER_SCHEMA = cv.Schema(
+    {
+        cv.Optional(
+            CONF_WINDOW, default="60s"
+        ): cv.positive_time_period_milliseconds,
+        cv.Optional(
+            CONF_SLOW_LISTENER_THRESHOLD, default="10ms"
+        ): cv.positive_time_period_microseconds,
+        cv.Optional(CONF_SUMMARY): esphome_text_sensor.text_sensor_schema(
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_MAX_LOOP_TIME): esphome_sensor.sensor_schema(
+            unit_of_measurement=UNIT_MILLISECOND,
+            accuracy_decimals=3,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+    }
+)
+
+
+UYAT_FRAME_TRACE_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_SIZE, default=64): cv.int_range(min=1, max=1024),
+        cv.Optional(CONF_PAYLOAD_BYTES, default=8): cv.int_range(min=0, max=255),
     }
 )
 
 
-CONFIG_SCHEMA = (
+CONFIG_SCHEMA = cv.All(
     cv.Schema(
         {
             cv.GenerateID(): cv.declare_id(Uyat),
             cv.Optional(CONF_DIAGNOSTICS): UYAT_DIAGNOSTIC_SENSORS_SCHEMA,
+            cv.Optional(CONF_PROFILER): UYAT_PROFILER_SCHEMA,
+            cv.Optional(CONF_FRAME_TRACE): UYAT_FRAME_TRACE_SCHEMA,
             cv.Optional(CONF_TIME_ID): cv.use_id(time.RealTimeClock),
             cv.Optional(CONF_REPORT_AP_NAME, default="smartlife"): cv.string,
             cv.Optional(CONF_IGNORE_MCU_UPDATE_ON_DATAPOINTS): cv.ensure_list(
                 cv.uint8_t
             ),
+            cv.Optional(CONF_DATAPOINT_POLICIES): cv.ensure_list(
+                DATAPOINT_POLICY_SCHEMA
+            ),
             cv.Optional(CONF_STATUS_PIN): pins.gpio_output_pin_schema,
             cv.Optional(CONF_ON_DATAPOINT_UPDATE): automation.validate_automation(
                 {
@@ -205,7 +409,8 @@ CONFIG_SCHEMA = (
         }
     )
     .extend(cv.COMPONENT_SCHEMA)
-    .extend(uart.UART_DEVICE_SCHEMA)
+    .extend(uart.UART_DEVICE_SCHEMA),
+    validate_datapoint_policies,
 )
 
 
@@ -223,6 +428,19 @@ async def to_code(config):
     if CONF_IGNORE_MCU_UPDATE_ON_DATAPOINTS in config:
         for dp in config[CONF_IGNORE_MCU_UPDATE_ON_DATAPOINTS]:
             cg.add(var.add_ignore_mcu_update_on_datapoints(dp))
+    for policy in config.get(CONF_DATAPOINT_POLICIES, []):
+        cg.add(
+            var.add_datapoint_policy(
+                policy[CONF_DATAPOINT],
+                cg.StructInitializer(
+                    DatapointPolicy,
+                    ("ignore", policy[CONF_IGNORE]),
+                    ("drop_duplicates", policy[CONF_DROP_DUPLICATES]),
+                    ("min_interval_ms", policy[CONF_MIN_INTERVAL].total_milliseconds),
+                    ("integer_deadband", policy[CONF_INTEGER_DEADBAND]),
+                ),
+            )
+        )
     for conf in config.get(CONF_ON_DATAPOINT_UPDATE, []):
         trigger = cg.new_Pvariable(
             conf[CONF_TRIGGER_ID], var, conf[CONF_DATAPOINT]
@@ -232,6 +450,11 @@ async def to_code(config):
         )
     if diagnostics_config := config.get(CONF_DIAGNOSTICS):
         cg.add_define("UYAT_DIAGNOSTICS_ENABLED")
+        cg.add(
+            var.set_diagnostics_publish_interval(
+                diagnostics_config[CONF_PUBLISH_INTERVAL].total_milliseconds
+            )
+        )
         if CONF_PRODUCT in diagnostics_config:
             tsens = await esphome_text_sensor.new_text_sensor(
                 diagnostics_config[CONF_PRODUCT]
@@ -262,6 +485,72 @@ async def to_code(config):
                 diagnostics_config[CONF_PAIRING_MODE]
             )
             cg.add(var.set_pairing_mode_text_sensor(tsens))
+        for key in (
+            CONF_FRAMES_RECEIVED,
+            CONF_FRAMES_SENT,
+            CONF_CHECKSUM_ERRORS,
+            CONF_RESPONSE_TIMEOUTS,
+            CONF_COMMAND_RETRIES,
+            CONF_DROPPED_COMMANDS,
+            CONF_QUEUE_HIGH_WATER_MARK,
+            CONF_RX_BYTES_PER_SECOND,
+            CONF_TX_BYTES_PER_SECOND,
+            CONF_RX_UTILISATION,
+            CONF_TX_UTILISATION,
+            CONF_DATAPOINT_WRITE_HEADROOM,
+        ):
+            if key in diagnostics_config:
+                sens = await esphome_sensor.new_sensor(diagnostics_config[key])
+                cg.add(getattr(var, f"set_{key}_sensor")(sens))
+        if CONF_COMMAND_STATISTICS in diagnostics_config:
+            tsens = await esphome_text_sensor.new_text_sensor(
+                diagnostics_config[CONF_COMMAND_STATISTICS]
+            )
+            cg.add(var.set_command_statistics_text_sensor(tsens))
+        if CONF_DATAPOINT_STATISTICS in diagnostics_config:
+            cg.add_define("UYAT_DATAPOINT_STATS_ENABLED")
+            tsens = await esphome_text_sensor.new_text_sensor(
+                diagnostics_config[CONF_DATAPOINT_STATISTICS]
+            )
+            cg.add(var.set_datapoint_statistics_text_sensor(tsens))
+        for interval in LATENCY_INTERVALS:
+            for statistic, sensor_config in diagnostics_config.get(interval, {}).items():
+                cg.add_define("UYAT_LATENCY_ENABLED")
+                sens = await esphome_sensor.new_sensor(sensor_config)
+                cg.add(getattr(var, f"set_{interval}_{statistic}_sensor")(sens))
+        if CONF_MEMORY_USAGE in diagnostics_config:
+            cg.add_define("UYAT_MEMORY_STATS_ENABLED")
+            tsens = await esphome_text_sensor.new_text_sensor(
+                diagnostics_config[CONF_MEMORY_USAGE]
+            )
+            cg.add(var.set_memory_usage_text_sensor(tsens))
+        for key in (CONF_MEMORY_USED, CONF_MEMORY_PEAK):
+            if key in diagnostics_config:
+                cg.add_define("UYAT_MEMORY_STATS_ENABLED")
+                sens = await esphome_sensor.new_sensor(diagnostics_config[key])
+                cg.add(getattr(var, f"set_{key}_sensor")(sens))
+    if frame_trace_config := config.get(CONF_FRAME_TRACE):
+        cg.add_define("UYAT_FRAME_TRACE_ENABLED")
+        cg.add_define("UYAT_FRAME_TRACE_SIZE", frame_trace_config[CONF_SIZE])
+        cg.add_define(
+            "UYAT_FRAME_TRACE_PAYLOAD_BYTES", frame_trace_config[CONF_PAYLOAD_BYTES]
+        )
+    if profiler_config := config.get(CONF_PROFILER):
+        cg.add_define("UYAT_PROFILER_ENABLED")
+        cg.add(var.set_profiler_window(profiler_config[CONF_WINDOW].total_milliseconds))
+        cg.add(
+            var.set_slow_listener_threshold(
+                profiler_config[CONF_SLOW_LISTENER_THRESHOLD].total_microseconds
+            )
+        )
+        if CONF_SUMMARY in profiler_config:
+            tsens = await esphome_text_sensor.new_text_sensor(
+                profiler_config[CONF_SUMMARY]
+            )
+            cg.add(var.set_profiler_summary_text_sensor(tsens))
+        if CONF_MAX_LOOP_TIME in profiler_config:
+            sens = await esphome_sensor.new_sensor(profiler_config[CONF_MAX_LOOP_TIME])
+            cg.add(var.set_max_loop_time_sensor(sens))
 
 
 
@@ -290,3 +579,24 @@ async def uyat_factory_reset_to_code(config, action_id, template_arg, args):
     var = cg.new_Pvariable(action_id, template_arg, paren)
     cg.add(var.set_reset_type(config[CONF_TYPE]))
     return var
+
+
+UYAT_DUMP_FRAME_TRACE_SCHEMA = automation.maybe_simple_id(
+    UYAT_ACTION_SCHEMA.extend(
+        cv.Schema(
+            {
+                cv.Optional(CONF_FORMAT, default="TEXT"): cv.enum(FRAME_TRACE_DUMP_FORMATS, upper=True),
+            }
+        )
+    )
+)
+
+
+@automation.register_action(
+    "uyat.dump_frame_trace", UyatDumpFrameTraceAction, UYAT_DUMP_FRAME_TRACE_SCHEMA
+)
+async def uyat_dump_frame_trace_to_code(config, action_id, template_arg, args):
+    paren = await cg.get_variable(config[CONF_ID])
+    var = cg.new_Pvariable(action_id, template_arg, paren)
+    cg.add(var.set_format(config[CONF_FORMAT]))
+    return var
@@ -58,41 +58,34 @@ void UyatClimate::on_switch_value(const bool value)
     }
   }
 
-  this->compute_state_();
-  this->publish_state();
+  this->request_publish_();
 }
 
 void UyatClimate::on_sleep_value(const bool value)
 {
   ESP_LOGV(UyatClimate::TAG, "Sleep of %s is now %s", this->get_name().c_str(), ONOFF(value));
   this->preset = this->presets_.get_active_preset();
-  this->select_target_temperature_to_report_();
-  this->publish_state();
+  this->request_publish_();
 }
 
 void UyatClimate::on_eco_value(const bool value)
 {
   ESP_LOGV(UyatClimate::TAG, "Eco of %s is now %s", this->get_name().c_str(), ONOFF(value));
   this->preset = this->presets_.get_active_preset();
-  this->select_target_temperature_to_report_();
-  this->publish_state();
+  this->request_publish_();
 }
 
 void UyatClimate::on_boost_value(const bool value)
 {
   ESP_LOGV(UyatClimate::TAG, "Boost of %s is now %s", this->get_name().c_str(), ONOFF(value));
   this->preset = this->presets_.get_active_preset();
-  this->select_target_temperature_to_report_();
-  this->publish_state();
+  this->request_publish_();
 }
 
 void UyatClimate::on_target_temperature_value(const float value)
 {
   ESP_LOGV(UyatClimate::TAG, "Target temperature of %s reported: %.1f", this->get_name().c_str(), value);
-
-  this->select_target_temperature_to_report_();
-  this->compute_state_();
-  this->publish_state();
+  this->request_publish_();
 }
 
 void UyatClimate::on_current_temperature_value(const float value)
@@ -100,40 +93,65 @@ void UyatClimate::on_current_temperature_value(const float value)
   this->current_temperature = *(this->temperatures_->get_current_temperature());
 
   ESP_LOGV(UyatClimate::TAG, "Current Temperature of %s is now %.1f", this->get_name().c_str(), this->current_temperature);
-  this->compute_state_();
-  this->publish_state();
+  this->request_publish_();
 }
 
 void UyatClimate::on_active_state_value(const float value)
 {
   ESP_LOGV(UyatClimate::TAG, "MCU reported active state is: %.0f", value);
-  this->compute_state_();
-  this->publish_state();
+  this->request_publish_();
 }
 
 void UyatClimate::on_fan_modes_value(const float value)
 {
   ESP_LOGV(UyatClimate::TAG, "MCU reported fan speed is: %.0f", value);
-
-  this->compute_fanmode_();
-  this->publish_state();
+  this->request_publish_();
 }
 
 void UyatClimate::on_horizontal_swing(const bool value)
 {
   ESP_LOGV(UyatClimate::TAG, "MCU reported horizontal swing is: %s", ONOFF(value));
-  this->compute_swingmode_();
-  this->publish_state();
+  this->request_publish_();
 }
 
 void UyatClimate::on_vertical_swing(const bool value)
 {
   ESP_LOGV(UyatClimate::TAG, "MCU reported vertical swing is: %s", ONOFF(value));
+  this->request_publish_();
+}
+
+void UyatClimate::request_publish_()
+{
+  if (this->parent_.is_processing_frame())
+  {
+    // several datapoints of this climate may come in one frame, publish once at its end
+    this->publish_pending_ = true;
+    return;
+  }
+
+  this->publish_computed_state_();
+}
+
+void UyatClimate::on_frame_end_()
+{
+  if (this->publish_pending_)
+  {
+    this->publish_pending_ = false;
+    this->publish_computed_state_();
+  }
+}
+
+void UyatClimate::publish_computed_state_()
+{
+  this->select_target_temperature_to_report_();
+  this->compute_fanmode_();
   this->compute_swingmode_();
+  this->compute_state_();
   this->publish_state();
 }
 
 void UyatClimate::setup() {
+  this->parent_.register_frame_end_listener([this]{ this->on_frame_end_(); });
   if (this->dp_switch_.has_value()) {
     this->dp_switch_->init(this->parent_);
   }
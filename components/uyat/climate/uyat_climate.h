@@ -843,6 +843,15 @@ class UyatClimate : public climate::Climate, public Component {
   /// Switch the climate device to the given climate mode.
   void switch_to_action_(climate::ClimateAction action);
 
+  /// Publish the re-computed state now, or at the end of the MCU frame being processed.
+  void request_publish_();
+
+  /// Publish the state deferred while the MCU frame was processed.
+  void on_frame_end_();
+
+  /// Re-compute everything derived from the datapoints and publish it.
+  void publish_computed_state_();
+
   Uyat& parent_;
   bool supports_heat_;
   bool supports_cool_;
@@ -853,6 +862,7 @@ class UyatClimate : public climate::Climate, public Component {
   std::optional<TemperaturesHandler> temperatures_{};
   std::optional<FanModesHandler> fan_modes_{};
   SwingModesHandler swing_modes_{};
+  bool publish_pending_{false};
 };
 
 }  // namespace uyat
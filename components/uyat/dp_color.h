@@ -1,9 +1,8 @@
 #pragma once
 
-#include "esphome/core/helpers.h"
+#include "uyat_platform.h"
 #include "uyat_datapoint_types.h"
-
-#include <functional>
+#include "uyat_log.h"
 
 namespace esphome::uyat
 {
@@ -56,7 +55,7 @@ struct DpColor
       }
    };
 
-   using Callback = std::function<void(const Value&)>;
+   using Callback = Delegate<void(const Value&)>;
 
    DpColor(Callback callback, MatchingDatapoint color_dp, const UyatColorType color_type):
    config_{std::move(color_dp), color_type},
@@ -66,39 +65,35 @@ struct DpColor
    void init(DatapointHandler& handler)
    {
       handler_ = &handler;
-      handler.register_datapoint_listener(this->config_.matching_dp, [this](const UyatDatapoint &datapoint) {
-         ESP_LOGV(DpColor::TAG, "%s processing as color", datapoint.to_string().c_str());
+      handler.register_typed_listener<StringDatapointValue>(this->config_.matching_dp, [this](const auto& dp_value) {
+         using ValueType = std::decay_t<decltype(dp_value)>;
+         if (log_enabled(ESPHOME_LOG_LEVEL_VERBOSE, DpColor::TAG))
+         {
+            ESP_LOGV(DpColor::TAG, "Datapoint %u: %s processing as color", this->config_.matching_dp.number, DatapointText(dp_value).c_str());
+         }
 
-         if (!this->config_.matching_dp.matches(datapoint.get_type()))
+         if (!this->config_.matching_dp.matches(ValueType::dp_type))
          {
-            ESP_LOGW(DpColor::TAG, "Non-matching datapoint type %s!", datapoint.get_type_name());
+            ESP_LOGW(DpColor::TAG, "Non-matching datapoint type %s!", MatchingDatapoint::get_type_name(ValueType::dp_type));
             return;
          }
 
-         if (auto * dp_value = std::get_if<StringDatapointValue>(&datapoint.value))
+         if (this->config_.matching_dp.resolve_type(ValueType::dp_type))
          {
-            if (!this->config_.matching_dp.allows_single_type())
-            {
-               this->config_.matching_dp.types = {UyatDatapointType::STRING};
-               ESP_LOGI(DpColor::TAG, "Resolved %s", this->config_.matching_dp.to_string().c_str());
-            }
-            auto new_value = this->decode_(dp_value->value);
-            if (new_value)
-            {
-               this->last_received_value_ = new_value;
-               callback_(*new_value);
-            }
-            else
-            {
-               ESP_LOGW(DpColor::TAG, "Failed to decode color %s!", datapoint.to_string().c_str());
-            }
+            ESP_LOGI(DpColor::TAG, "Resolved %s", this->config_.matching_dp.to_string().c_str());
+         }
+         auto new_value = this->decode_(dp_value.value);
+         if (new_value)
+         {
+            this->last_received_value_ = new_value;
+            callback_(*new_value);
          }
          else
          {
-            ESP_LOGW(DpColor::TAG, "Unhandled datapoint type %s!", datapoint.get_type_name());
-            return;
+            ESP_LOGW(DpColor::TAG, "Failed to decode color %s!", dp_value.value.c_str());
          }
       });
+      handler.register_entity_memory(*this);
    }
 
    void set_value(const Value& v)
@@ -202,6 +197,11 @@ private:
 
    std::optional<Value> decode_as_rgb_(const std::string& raw_value) const
    {
+      if (raw_value.size() < 6u)
+      {
+         return std::nullopt;
+      }
+
       const auto rgb = parse_hex<uint32_t>(raw_value.substr(0, 6));
       if (!rgb.has_value())
       {
@@ -215,6 +215,12 @@ private:
 
    std::optional<Value> decode_as_hsv_(const std::string& raw_value) const
    {
+      // substr() throws when the position is past the end
+      if (raw_value.size() < 12u)
+      {
+         return std::nullopt;
+      }
+
       const auto hue = parse_hex<uint16_t>(raw_value.substr(0, 4));
       const auto saturation = parse_hex<uint16_t>(raw_value.substr(4, 4));
       const auto value = parse_hex<uint16_t>(raw_value.substr(8, 4));
@@ -1,18 +1,18 @@
 #pragma once
 
 #include "uyat_datapoint_types.h"
+#include "uyat_log.h"
 #include "dp_number.h"
 
 #include <optional>
 #include <cstdint>
-#include <functional>
 
 namespace esphome::uyat
 {
 
 struct DpDimmer
 {
-   using BrightnessChangedCallback = std::function<void(const float)>;
+   using BrightnessChangedCallback = Delegate<void(const float)>;
    static constexpr const char* TAG = "uyat.DpDimmer";
 
    struct Config
@@ -43,49 +43,31 @@ struct DpDimmer
    void init(DatapointHandler& handler)
    {
       handler_ = &handler;
-      handler.register_datapoint_listener(this->config_.matching_dp, [this](const UyatDatapoint &datapoint) {
-         ESP_LOGV(DpNumber::TAG, "%s processing as dimmer", datapoint.to_string().c_str());
-         if (!this->config_.matching_dp.matches(datapoint.get_type()))
+      handler.register_typed_listener<UIntDatapointValue, EnumDatapointValue>(this->config_.matching_dp, [this](const auto& dp_value) {
+         using ValueType = std::decay_t<decltype(dp_value)>;
+         if (log_enabled(ESPHOME_LOG_LEVEL_VERBOSE, DpNumber::TAG))
          {
-            ESP_LOGW(DpNumber::TAG, "Non-matching datapoint type %s!", datapoint.get_type_name());
-            return;
+            ESP_LOGV(DpNumber::TAG, "Datapoint %u: %s processing as dimmer", this->config_.matching_dp.number, DatapointText(dp_value).c_str());
          }
 
-         if (auto * dp_value = std::get_if<UIntDatapointValue>(&datapoint.value))
+         if (!this->config_.matching_dp.matches(ValueType::dp_type))
          {
-            if (!this->config_.matching_dp.allows_single_type())
-            {
-               this->config_.matching_dp.types = {UyatDatapointType::INTEGER};
-               ESP_LOGI(DpNumber::TAG, "Resolved %s", this->config_.matching_dp.to_string().c_str());
-            }
-            last_received_value_ = mcu_value_to_percent(dp_value->value);
-            if (config_.inverted)
-            {
-               last_received_value_ = 1.0f - *last_received_value_;
-            }
-            callback_(*last_received_value_);
+            ESP_LOGW(DpNumber::TAG, "Non-matching datapoint type %s!", MatchingDatapoint::get_type_name(ValueType::dp_type));
+            return;
          }
-         else
-         if (auto * dp_value = std::get_if<EnumDatapointValue>(&datapoint.value))
+
+         if (this->config_.matching_dp.resolve_type(ValueType::dp_type))
          {
-            if (!this->config_.matching_dp.allows_single_type())
-            {
-               this->config_.matching_dp.types = {UyatDatapointType::ENUM};
-               ESP_LOGI(DpNumber::TAG, "Resolved %s", this->config_.matching_dp.to_string().c_str());
-            }
-            last_received_value_ = mcu_value_to_percent(dp_value->value);
-            if (config_.inverted)
-            {
-               last_received_value_ = 1.0f - *last_received_value_;
-            }
-            callback_(*last_received_value_);
+            ESP_LOGI(DpNumber::TAG, "Resolved %s", this->config_.matching_dp.to_string().c_str());
          }
-         else
+         last_received_value_ = mcu_value_to_percent(dp_value.value);
+         if (config_.inverted)
          {
-            ESP_LOGW(DpNumber::TAG, "Unhandled datapoint type %s!", datapoint.get_type_name());
-            return;
+            last_received_value_ = 1.0f - *last_received_value_;
          }
+         callback_(*last_received_value_);
       });
+      handler.register_entity_memory(*this);
    }
 
    void set_value(float value_percent)
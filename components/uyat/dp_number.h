@@ -1,8 +1,7 @@
 #pragma once
 
-#include <functional>
-
 #include "uyat_datapoint_types.h"
+#include "uyat_log.h"
 
 namespace esphome::uyat
 {
@@ -11,7 +10,7 @@ struct DpNumber
 {
    static constexpr const char * TAG = "uyat.DpNumber";
 
-   using OnValueCallback = std::function<void(const float)>;
+   using OnValueCallback = Delegate<void(const float)>;
 
    struct Config
    {
@@ -28,64 +27,27 @@ struct DpNumber
    void init(DatapointHandler& handler)
    {
       handler_ = &handler;
-      handler.register_datapoint_listener(this->config_.matching_dp, [this](const UyatDatapoint &datapoint) {
-         ESP_LOGV(DpNumber::TAG, "%s processing as number", datapoint.to_string().c_str());
-
-         if (!this->config_.matching_dp.matches(datapoint.get_type()))
+      handler.register_typed_listener<BoolDatapointValue, UIntDatapointValue, EnumDatapointValue, BitmapDatapointValue>(this->config_.matching_dp, [this](const auto& dp_value) {
+         using ValueType = std::decay_t<decltype(dp_value)>;
+         if (log_enabled(ESPHOME_LOG_LEVEL_VERBOSE, DpNumber::TAG))
          {
-            ESP_LOGW(DpNumber::TAG, "Non-matching datapoint type %s!", datapoint.get_type_name());
-            return;
+            ESP_LOGV(DpNumber::TAG, "Datapoint %u: %s processing as number", this->config_.matching_dp.number, DatapointText(dp_value).c_str());
          }
 
-         if (auto * dp_value = std::get_if<BoolDatapointValue>(&datapoint.value))
-         {
-            if (!this->config_.matching_dp.allows_single_type())
-            {
-               this->config_.matching_dp.types = {UyatDatapointType::BOOLEAN};
-               ESP_LOGI(DpNumber::TAG, "Resolved %s", this->config_.matching_dp.to_string().c_str());
-            }
-            this->last_received_value_ = calculate_logical_value(dp_value->value);
-            callback_(last_received_value_.value());
-         }
-         else
-         if (auto * dp_value = std::get_if<UIntDatapointValue>(&datapoint.value))
-         {
-            if (!this->config_.matching_dp.allows_single_type())
-            {
-               this->config_.matching_dp.types = {UyatDatapointType::INTEGER};
-               ESP_LOGI(DpNumber::TAG, "Resolved %s", this->config_.matching_dp.to_string().c_str());
-            }
-            this->last_received_value_ = calculate_logical_value(dp_value->value);
-            callback_(last_received_value_.value());
-         }
-         else
-         if (auto * dp_value = std::get_if<EnumDatapointValue>(&datapoint.value))
-         {
-            if (!this->config_.matching_dp.allows_single_type())
-            {
-               this->config_.matching_dp.types = {UyatDatapointType::ENUM};
-               ESP_LOGI(DpNumber::TAG, "Resolved %s", this->config_.matching_dp.to_string().c_str());
-            }
-            this->last_received_value_ = calculate_logical_value(dp_value->value);
-            callback_(last_received_value_.value());
-         }
-         else
-         if (auto * dp_value = std::get_if<BitmapDatapointValue>(&datapoint.value))
+         if (!this->config_.matching_dp.matches(ValueType::dp_type))
          {
-            if (!this->config_.matching_dp.allows_single_type())
-            {
-               this->config_.matching_dp.types = {UyatDatapointType::BITMAP};
-               ESP_LOGI(DpNumber::TAG, "Resolved %s", this->config_.matching_dp.to_string().c_str());
-            }
-            this->last_received_value_ = calculate_logical_value(dp_value->value);
-            callback_(last_received_value_.value());
+            ESP_LOGW(DpNumber::TAG, "Non-matching datapoint type %s!", MatchingDatapoint::get_type_name(ValueType::dp_type));
+            return;
          }
-         else
+
+         if (this->config_.matching_dp.resolve_type(ValueType::dp_type))
          {
-            ESP_LOGW(DpNumber::TAG, "Unhandled datapoint type %s!", datapoint.get_type_name());
-            return;
+            ESP_LOGI(DpNumber::TAG, "Resolved %s", this->config_.matching_dp.to_string().c_str());
          }
+         this->last_received_value_ = calculate_logical_value(dp_value.value);
+         callback_(last_received_value_.value());
       });
+      handler.register_entity_memory(*this);
    }
 
    std::optional<float> get_last_received_value() const
@@ -1,8 +1,7 @@
 #pragma once
 
-#include <functional>
-
 #include "uyat_datapoint_types.h"
+#include "uyat_log.h"
 
 namespace esphome::uyat
 {
@@ -11,7 +10,7 @@ struct DpSwitch
 {
    static constexpr const char * TAG = "uyat.DpSwitch";
 
-   using OnValueCallback = std::function<void(const bool)>;
+   using OnValueCallback = Delegate<void(const bool)>;
 
    struct Config
    {
@@ -27,54 +26,27 @@ struct DpSwitch
    void init(DatapointHandler& handler)
    {
       this->handler_ = &handler;
-      this->handler_->register_datapoint_listener(this->config_.matching_dp, [this](const UyatDatapoint &datapoint) {
-         ESP_LOGV(DpSwitch::TAG, "%s processing as switch", datapoint.to_string().c_str());
-
-         if (!this->config_.matching_dp.matches(datapoint.get_type()))
+      this->handler_->register_typed_listener<BoolDatapointValue, UIntDatapointValue, EnumDatapointValue>(this->config_.matching_dp, [this](const auto& dp_value) {
+         using ValueType = std::decay_t<decltype(dp_value)>;
+         if (log_enabled(ESPHOME_LOG_LEVEL_VERBOSE, DpSwitch::TAG))
          {
-            ESP_LOGW(DpSwitch::TAG, "Non-matching datapoint type %s!", datapoint.get_type_name());
-            return;
+            ESP_LOGV(DpSwitch::TAG, "Datapoint %u: %s processing as switch", this->config_.matching_dp.number, DatapointText(dp_value).c_str());
          }
 
-         if (auto * dp_value = std::get_if<BoolDatapointValue>(&datapoint.value))
-         {
-            if (!this->config_.matching_dp.allows_single_type())
-            {
-               this->config_.matching_dp.types = {UyatDatapointType::BOOLEAN};
-               ESP_LOGI(DpSwitch::TAG, "Resolved %s", this->config_.matching_dp.to_string().c_str());
-            }
-            received_value_ = invert_if_needed(dp_value->value);
-            callback_(received_value_.value());
-         }
-         else
-         if (auto * dp_value = std::get_if<UIntDatapointValue>(&datapoint.value))
+         if (!this->config_.matching_dp.matches(ValueType::dp_type))
          {
-            if (!this->config_.matching_dp.allows_single_type())
-            {
-               this->config_.matching_dp.types = {UyatDatapointType::INTEGER};
-               ESP_LOGI(DpSwitch::TAG, "Resolved %s", this->config_.matching_dp.to_string().c_str());
-            }
-
-            received_value_ = invert_if_needed(dp_value->value != 0);
-            callback_(received_value_.value());
-         }
-         else
-         if (auto * dp_value = std::get_if<EnumDatapointValue>(&datapoint.value))
-         {
-            if (!this->config_.matching_dp.allows_single_type())
-            {
-               this->config_.matching_dp.types = {UyatDatapointType::ENUM};
-               ESP_LOGI(DpSwitch::TAG, "Resolved %s", this->config_.matching_dp.to_string().c_str());
-            }
-            received_value_ = invert_if_needed(dp_value->value != 0);
-            callback_(received_value_.value());
+            ESP_LOGW(DpSwitch::TAG, "Non-matching datapoint type %s!", MatchingDatapoint::get_type_name(ValueType::dp_type));
+            return;
          }
-         else
+
+         if (this->config_.matching_dp.resolve_type(ValueType::dp_type))
          {
-            ESP_LOGW(DpSwitch::TAG, "Unhandled datapoint type %s!", datapoint.get_type_name());
-            return;
+            ESP_LOGI(DpSwitch::TAG, "Resolved %s", this->config_.matching_dp.to_string().c_str());
          }
+         received_value_ = invert_if_needed(dp_value.value != 0);
+         callback_(received_value_.value());
       });
+      handler.register_entity_memory(*this);
    }
 
    std::optional<bool> get_last_received_value() const
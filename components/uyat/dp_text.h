@@ -1,12 +1,13 @@
 #pragma once
 
-#include "esphome/core/helpers.h"
+#include "uyat_platform.h"
 
-#include <functional>
 #include <string>
 #include <optional>
 
 #include "uyat_datapoint_types.h"
+#include "uyat_log.h"
+#include "uyat_memory.h"
 
 namespace esphome::uyat
 {
@@ -37,7 +38,7 @@ struct DpText
 {
    static constexpr const char * TAG = "uyat.DpText";
 
-   using OnValueCallback = std::function<void(const std::string&)>;
+   using OnValueCallback = Delegate<void(const std::string&)>;
 
    struct Config
    {
@@ -53,43 +54,34 @@ struct DpText
    void init(DatapointHandler& handler)
    {
       this->handler_ = &handler;
-      this->handler_->register_datapoint_listener(this->config_.matching_dp, [this](const UyatDatapoint &datapoint) {
-         ESP_LOGV(DpText::TAG, "%s processing as text_sensor", datapoint.to_string().c_str());
+      this->handler_->register_typed_listener<RawDatapointValue, StringDatapointValue>(this->config_.matching_dp, [this](const auto& dp_value) {
+         using ValueType = std::decay_t<decltype(dp_value)>;
+         if (log_enabled(ESPHOME_LOG_LEVEL_VERBOSE, DpText::TAG))
+         {
+            ESP_LOGV(DpText::TAG, "Datapoint %u: %s processing as text_sensor", this->config_.matching_dp.number, DatapointText(dp_value).c_str());
+         }
 
-         if (!this->config_.matching_dp.matches(datapoint.get_type()))
+         if (!this->config_.matching_dp.matches(ValueType::dp_type))
          {
-            ESP_LOGW(DpText::TAG, "Non-matching datapoint type %s!", datapoint.get_type_name());
+            ESP_LOGW(DpText::TAG, "Non-matching datapoint type %s!", MatchingDatapoint::get_type_name(ValueType::dp_type));
             return;
          }
 
-         if (auto * dp_value = std::get_if<RawDatapointValue>(&datapoint.value))
+         if (this->config_.matching_dp.resolve_type(ValueType::dp_type))
          {
-            if (!this->config_.matching_dp.allows_single_type())
-            {
-               this->config_.matching_dp.types = {UyatDatapointType::RAW};
-               ESP_LOGI(DpText::TAG, "Resolved %s", this->config_.matching_dp.to_string().c_str());
-            }
-            this->last_received_value_ = std::string(dp_value->value.begin(), dp_value->value.end());
-            this->last_received_value_ = this->decode_(this->last_received_value_);
-            callback_(this->last_received_value_);
+            ESP_LOGI(DpText::TAG, "Resolved %s", this->config_.matching_dp.to_string().c_str());
          }
-         else
-         if (auto * dp_value = std::get_if<StringDatapointValue>(&datapoint.value))
+         if constexpr (std::is_same_v<ValueType, RawDatapointValue>)
          {
-            if (!this->config_.matching_dp.allows_single_type())
-            {
-               this->config_.matching_dp.types = {UyatDatapointType::STRING};
-               ESP_LOGI(DpText::TAG, "Resolved %s", this->config_.matching_dp.to_string().c_str());
-            }
-            this->last_received_value_ = this->decode_(dp_value->value);
-            callback_(this->last_received_value_);
+            this->last_received_value_ = this->decode_(std::string(dp_value.value.begin(), dp_value.value.end()));
          }
          else
          {
-            ESP_LOGW(DpText::TAG, "Unhandled datapoint type %s!", datapoint.get_type_name());
-            return;
+            this->last_received_value_ = this->decode_(dp_value.value);
          }
+         callback_(this->last_received_value_);
       });
+      handler.register_entity_memory(*this);
    }
 
    std::string get_last_received_value() const
@@ -107,6 +99,11 @@ struct DpText
       return config_;
    }
 
+   std::size_t heap_bytes() const
+   {
+      return uyat::heap_bytes(this->last_received_value_) + uyat::heap_bytes(this->last_set_value_);
+   }
+
    void set_value(const std::string& value)
    {
       if (this->handler_ == nullptr)
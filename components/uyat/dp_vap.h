@@ -1,8 +1,7 @@
 #pragma once
 
-#include <functional>
-
 #include "uyat_datapoint_types.h"
+#include "uyat_log.h"
 
 namespace esphome::uyat
 {
@@ -20,7 +19,7 @@ struct DpVAP
          return str_sprintf("V: %u, A: %u, P: %u", v, a, p);
       }
    };
-   using OnValueCallback = std::function<void(const VAPValue&)>;
+   using OnValueCallback = Delegate<void(const VAPValue&)>;
 
    struct Config
    {
@@ -35,33 +34,30 @@ struct DpVAP
    void init(DatapointHandler& handler)
    {
       handler_ = &handler;
-      handler.register_datapoint_listener(this->config_.matching_dp, [this](const UyatDatapoint &datapoint) {
-         ESP_LOGV(DpVAP::TAG, "%s processing as VAP", datapoint.to_string().c_str());
+      handler.register_typed_listener<RawDatapointValue>(this->config_.matching_dp, [this](const auto& dp_value) {
+         using ValueType = std::decay_t<decltype(dp_value)>;
+         if (log_enabled(ESPHOME_LOG_LEVEL_VERBOSE, DpVAP::TAG))
+         {
+            ESP_LOGV(DpVAP::TAG, "Datapoint %u: %s processing as VAP", this->config_.matching_dp.number, DatapointText(dp_value).c_str());
+         }
 
-         if (!this->config_.matching_dp.matches(datapoint.get_type()))
+         if (!this->config_.matching_dp.matches(ValueType::dp_type))
          {
-            ESP_LOGW(DpVAP::TAG, "Non-matching datapoint type %s!", datapoint.get_type_name());
+            ESP_LOGW(DpVAP::TAG, "Non-matching datapoint type %s!", MatchingDatapoint::get_type_name(ValueType::dp_type));
             return;
          }
 
-         if (auto * dp_value = std::get_if<RawDatapointValue>(&datapoint.value))
+         if (auto decoded = decode_(dp_value.value))
          {
-            if (auto decoded = decode_(dp_value->value))
-            {
-               this->received_value_ = decoded;
-               callback_(received_value_.value());
-            }
-            else
-            {
-               ESP_LOGW(DpVAP::TAG, "Failed to decode VAP from datapoint %s", datapoint.to_string().c_str());
-            }
+            this->received_value_ = decoded;
+            callback_(received_value_.value());
          }
          else
          {
-            ESP_LOGW(DpVAP::TAG, "Unhandled datapoint type %s!", datapoint.get_type_name());
-            return;
+            ESP_LOGW(DpVAP::TAG, "Failed to decode VAP from datapoint %u: %s", this->config_.matching_dp.number, dp_value.to_string().c_str());
          }
       });
+      handler.register_entity_memory(*this);
    }
 
    std::optional<VAPValue> get_last_received_value() const
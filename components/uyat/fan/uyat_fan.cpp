@@ -27,6 +27,7 @@ parent_(*parent)
 
 
 void UyatFan::setup() {
+  this->parent_.register_frame_end_listener([this]{ this->on_frame_end_(); });
   if (this->speed_.has_value()) {
     this->speed_->dp_speed.init(this->parent_);
   }
@@ -97,7 +98,7 @@ void UyatFan::on_switch_value(const bool value)
 {
   ESP_LOGV(UyatFan::TAG, "MCU reported switch %s is: %s", get_name().c_str(), ONOFF(value));
   this->state = value;
-  this->publish_state();
+  this->request_publish_();
 }
 
 void UyatFan::on_oscillation_value(const bool value)
@@ -105,7 +106,7 @@ void UyatFan::on_oscillation_value(const bool value)
   ESP_LOGV(UyatFan::TAG, "MCU reported oscillation is: %s", ONOFF(value));
 
   this->oscillating = value;
-  this->publish_state();
+  this->request_publish_();
 }
 
 void UyatFan::on_direction_value(const bool value)
@@ -113,7 +114,7 @@ void UyatFan::on_direction_value(const bool value)
   ESP_LOGV(UyatFan::TAG, "MCU reported direction is: %s", ONOFF(value));
 
   this->direction = value ? fan::FanDirection::FORWARD : fan::FanDirection::REVERSE;
-  this->publish_state();
+  this->request_publish_();
 }
 
 void UyatFan::on_speed_value(const float value)
@@ -136,9 +137,30 @@ void UyatFan::on_speed_value(const float value)
     this->speed = static_cast<int>(value) - this->speed_->min_value + 1;
   }
 
+  this->request_publish_();
+}
+
+void UyatFan::request_publish_()
+{
+  if (this->parent_.is_processing_frame())
+  {
+    // several datapoints of this fan may come in one frame, publish once at its end
+    this->publish_pending_ = true;
+    return;
+  }
+
   this->publish_state();
 }
 
+void UyatFan::on_frame_end_()
+{
+  if (this->publish_pending_)
+  {
+    this->publish_pending_ = false;
+    this->publish_state();
+  }
+}
+
 void UyatFan::configure_speed(SpeedConfig&& config)
 {
   this->speed_.emplace(
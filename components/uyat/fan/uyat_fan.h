@@ -81,6 +81,9 @@ class UyatFan : public Component, public fan::Fan {
   void on_oscillation_value(const bool);
   void on_direction_value(const bool);
 
+  void request_publish_();
+  void on_frame_end_();
+
 
   Uyat& parent_;
 
@@ -88,6 +91,7 @@ class UyatFan : public Component, public fan::Fan {
   std::optional<DpSwitch> dp_switch_{};
   std::optional<DpSwitch> dp_oscillation_{};
   std::optional<DpSwitch> dp_direction_{};
+  bool publish_pending_{false};
 };
 
 }  // namespace uyat
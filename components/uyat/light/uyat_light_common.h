@@ -1,5 +1,8 @@
 #pragma once
 
+#include "esphome/components/light/light_state.h"
+
+#include "../uyat.h"
 #include "../uyat_datapoint_types.h"
 #include "../dp_color.h"
 #include <cstdint>
@@ -39,4 +42,41 @@ struct ConfigColor
    UyatColorType color_type;
 };
 
+// Collects the changes reported by the MCU in a single frame into one LightCall,
+// so the light state is updated once per frame instead of once per datapoint.
+class FrameLightCall
+{
+public:
+   light::LightCall& get(light::LightState* state)
+   {
+      if (!this->call_)
+      {
+         this->call_.emplace(state->make_call());
+      }
+      return *this->call_;
+   }
+
+   // performs the call right away, unless the MCU frame is still being processed
+   void commit(const Uyat& uyat)
+   {
+      if (!uyat.is_processing_frame())
+      {
+         this->flush();
+      }
+   }
+
+   void flush()
+   {
+      if (this->call_)
+      {
+         auto call = std::move(*this->call_);
+         this->call_.reset();
+         call.perform();
+      }
+   }
+
+private:
+   std::optional<light::LightCall> call_;
+};
+
 }
@@ -34,6 +34,7 @@ warm_white_temperature_(config.wt_config.warm_white_temperature)
 }
 
 void UyatLightCT::setup() {
+  this->parent_.register_frame_end_listener([this]{ this->frame_call_.flush(); });
   this->dp_dimmer_.init(this->parent_);
   if (this->dimmer_min_value_)
   {
@@ -87,9 +88,9 @@ void UyatLightCT::on_dimmer_value(const float value_percent)
     return;
   }
 
-  auto call = this->state_->make_call();
+  auto &call = this->frame_call_.get(this->state_);
   call.set_brightness(value_percent);
-  call.perform();
+  this->frame_call_.commit(this->parent_);
 }
 
 void UyatLightCT::on_switch_value(const bool value)
@@ -100,9 +101,9 @@ void UyatLightCT::on_switch_value(const bool value)
     return;
   }
 
-  auto call = this->state_->make_call();
+  auto &call = this->frame_call_.get(this->state_);
   call.set_state(value);
-  call.perform();
+  this->frame_call_.commit(this->parent_);
 }
 
 void UyatLightCT::on_white_temperature_value(const float value_percent)
@@ -113,10 +114,10 @@ void UyatLightCT::on_white_temperature_value(const float value_percent)
     return;
   }
 
-  auto call = this->state_->make_call();
+  auto &call = this->frame_call_.get(this->state_);
   call.set_color_temperature(this->cold_white_temperature_ +
                               (this->warm_white_temperature_ - this->cold_white_temperature_) * value_percent);
-  call.perform();
+  this->frame_call_.commit(this->parent_);
 }
 
 }  // namespace esphome::uyat
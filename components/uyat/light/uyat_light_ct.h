@@ -47,6 +47,7 @@ class UyatLightCT : public EntityBase, public Component, public light::LightOutp
   float cold_white_temperature_;
   float warm_white_temperature_;
   light::LightState *state_{nullptr};
+  FrameLightCall frame_call_;
 };
 
 }  // namespace esphome::uyat
@@ -27,6 +27,7 @@ dp_dimmer_{[this](const float brightness_percent){ this->on_dimmer_value(brightn
 }
 
 void UyatLightDimmer::setup() {
+  this->parent_.register_frame_end_listener([this]{ this->frame_call_.flush(); });
   this->dp_dimmer_.init(this->parent_);
   if (this->dimmer_min_value_)
   {
@@ -76,9 +77,9 @@ void UyatLightDimmer::on_dimmer_value(const float value_percent)
     return;
   }
 
-  auto call = this->state_->make_call();
+  auto &call = this->frame_call_.get(this->state_);
   call.set_brightness(value_percent);
-  call.perform();
+  this->frame_call_.commit(this->parent_);
 }
 
 void UyatLightDimmer::on_switch_value(const bool value)
@@ -89,9 +90,9 @@ void UyatLightDimmer::on_switch_value(const bool value)
     return;
   }
 
-  auto call = this->state_->make_call();
+  auto &call = this->frame_call_.get(this->state_);
   call.set_state(value);
-  call.perform();
+  this->frame_call_.commit(this->parent_);
 }
 
 }  // namespace esphome::uyat
@@ -41,6 +41,7 @@ class UyatLightDimmer : public EntityBase, public Component, public light::Light
   DpDimmer dp_dimmer_;
   std::optional<DpNumber> dimmer_min_value_;
   light::LightState *state_{nullptr};
+  FrameLightCall frame_call_;
 };
 
 }  // namespace esphome::uyat
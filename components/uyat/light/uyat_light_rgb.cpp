@@ -17,6 +17,7 @@ dp_color_{[this](const DpColor::Value& value){ this->on_color_value(value);},
 {}
 
 void UyatLightRGB::setup() {
+  this->parent_.register_frame_end_listener([this]{ this->frame_call_.flush(); });
   this->dp_switch_.init(this->parent_);
   this->dp_color_.init(this->parent_);
 }
@@ -57,9 +58,9 @@ void UyatLightRGB::on_switch_value(const bool value)
     return;
   }
 
-  auto call = this->state_->make_call();
+  auto &call = this->frame_call_.get(this->state_);
   call.set_state(value);
-  call.perform();
+  this->frame_call_.commit(this->parent_);
 }
 
 void UyatLightRGB::on_color_value(const DpColor::Value& value)
@@ -75,9 +76,9 @@ void UyatLightRGB::on_color_value(const DpColor::Value& value)
   this->state_->current_values_as_rgb(&current_red, &current_green, &current_blue);
   if (value.r == current_red && value.g == current_green && value.b == current_blue)
     return;
-  auto rgb_call = this->state_->make_call();
+  auto &rgb_call = this->frame_call_.get(this->state_);
   rgb_call.set_rgb(value.r, value.g, value.b);
-  rgb_call.perform();
+  this->frame_call_.commit(this->parent_);
 }
 
 }  // namespace esphome::uyat
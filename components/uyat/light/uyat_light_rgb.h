@@ -39,6 +39,7 @@ class UyatLightRGB : public EntityBase, public Component, public light::LightOut
   DpSwitch dp_switch_;
   DpColor dp_color_;
   light::LightState *state_{nullptr};
+  FrameLightCall frame_call_;
 };
 
 }  // namespace esphome::uyat
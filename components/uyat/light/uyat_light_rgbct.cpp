@@ -37,6 +37,7 @@ color_interlock_(config.color_interlock)
 }
 
 void UyatLightRGBCT::setup() {
+  this->parent_.register_frame_end_listener([this]{ this->frame_call_.flush(); });
   this->dp_dimmer_.init(this->parent_);
   if (this->dimmer_min_value_)
   {
@@ -103,9 +104,9 @@ void UyatLightRGBCT::on_dimmer_value(const float value_percent)
     return;
   }
 
-  auto call = this->state_->make_call();
+  auto &call = this->frame_call_.get(this->state_);
   call.set_brightness(value_percent);
-  call.perform();
+  this->frame_call_.commit(this->parent_);
 }
 
 void UyatLightRGBCT::on_switch_value(const bool value)
@@ -116,9 +117,9 @@ void UyatLightRGBCT::on_switch_value(const bool value)
     return;
   }
 
-  auto call = this->state_->make_call();
+  auto &call = this->frame_call_.get(this->state_);
   call.set_state(value);
-  call.perform();
+  this->frame_call_.commit(this->parent_);
 }
 
 void UyatLightRGBCT::on_color_value(const DpColor::Value& value)
@@ -134,9 +135,9 @@ void UyatLightRGBCT::on_color_value(const DpColor::Value& value)
   this->state_->current_values_as_rgb(&current_red, &current_green, &current_blue);
   if (value.r == current_red && value.g == current_green && value.b == current_blue)
     return;
-  auto rgb_call = this->state_->make_call();
+  auto &rgb_call = this->frame_call_.get(this->state_);
   rgb_call.set_rgb(value.r, value.g, value.b);
-  rgb_call.perform();
+  this->frame_call_.commit(this->parent_);
 
 }
 
@@ -148,10 +149,10 @@ void UyatLightRGBCT::on_white_temperature_value(const float value_percent)
     return;
   }
 
-  auto call = this->state_->make_call();
+  auto &call = this->frame_call_.get(this->state_);
   call.set_color_temperature(this->cold_white_temperature_ +
                               (this->warm_white_temperature_ - this->cold_white_temperature_) * value_percent);
-  call.perform();
+  this->frame_call_.commit(this->parent_);
 }
 
 }  // namespace esphome::uyat
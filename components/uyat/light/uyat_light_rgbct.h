@@ -58,6 +58,7 @@ class UyatLightRGBCT : public EntityBase, public Component, public light::LightO
   const float warm_white_temperature_;
   const bool color_interlock_{false};
   light::LightState *state_{nullptr};
+  FrameLightCall frame_call_;
 };
 
 }  // namespace esphome::uyat
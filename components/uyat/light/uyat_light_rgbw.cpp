@@ -31,6 +31,7 @@ color_interlock_(config.color_interlock)
 }
 
 void UyatLightRGBW::setup() {
+  this->parent_.register_frame_end_listener([this]{ this->frame_call_.flush(); });
   this->dp_dimmer_.init(this->parent_);
   if (this->dimmer_min_value_)
   {
@@ -94,9 +95,9 @@ void UyatLightRGBW::on_dimmer_value(const float value_percent)
     return;
   }
 
-  auto call = this->state_->make_call();
+  auto &call = this->frame_call_.get(this->state_);
   call.set_brightness(value_percent);
-  call.perform();
+  this->frame_call_.commit(this->parent_);
 }
 
 void UyatLightRGBW::on_switch_value(const bool value)
@@ -107,9 +108,9 @@ void UyatLightRGBW::on_switch_value(const bool value)
     return;
   }
 
-  auto call = this->state_->make_call();
+  auto &call = this->frame_call_.get(this->state_);
   call.set_state(value);
-  call.perform();
+  this->frame_call_.commit(this->parent_);
 }
 
 void UyatLightRGBW::on_color_value(const DpColor::Value& value)
@@ -125,9 +126,9 @@ void UyatLightRGBW::on_color_value(const DpColor::Value& value)
   this->state_->current_values_as_rgb(&current_red, &current_green, &current_blue);
   if (value.r == current_red && value.g == current_green && value.b == current_blue)
     return;
-  auto rgb_call = this->state_->make_call();
+  auto &rgb_call = this->frame_call_.get(this->state_);
   rgb_call.set_rgb(value.r, value.g, value.b);
-  rgb_call.perform();
+  this->frame_call_.commit(this->parent_);
 
 }
 
@@ -46,6 +46,7 @@ class UyatLightRGBW : public EntityBase, public Component, public light::LightOu
   DpColor dp_color_;
   const bool color_interlock_;
   light::LightState *state_{nullptr};
+  FrameLightCall frame_call_;
 };
 
 }  // namespace esphome::uyat
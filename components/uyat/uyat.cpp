@@ -8,66 +8,56 @@
 namespace esphome::uyat {
 
 static const char *const TAG = "uyat";
-static const int COMMAND_DELAY = 10;
-static const int RECEIVE_TIMEOUT = 300;
-static const int MAX_RETRIES = 5;
-
-static const uint8_t NET_STATUS_WIFI_CONNECTED = 0x03;
-static const uint8_t NET_STATUS_CLOUD_CONNECTED = 0x04;
-static const uint8_t FAKE_WIFI_RSSI = 100;
-static const uint64_t UART_MAX_POLL_TIME_MS = 50;
 
 #ifdef UYAT_DIAGNOSTICS_ENABLED
-static void add_unique_to_vector(std::vector<uint8_t> &vec, const uint8_t value) {
-  if (std::find(vec.begin(), vec.end(), value) == vec.end()) {
-    vec.push_back(value);
+// header + version + command + length + checksum, plus the datapoint header and a single byte value
+static const std::size_t MIN_DATAPOINT_FRAME_SIZE = 7u + 4u + 1u;
+
+
+// Same output as format_hex_pretty(ids, ' ', false), but into a reused buffer.
+static void format_ids_into(std::string &buffer, const std::vector<uint8_t> &ids) {
+  static const char *const HEX_DIGITS = "0123456789ABCDEF";
+  buffer.clear();
+  for (const auto id : ids) {
+    if (!buffer.empty()) {
+      buffer += ' ';
+    }
+    buffer += HEX_DIGITS[id >> 4];
+    buffer += HEX_DIGITS[id & 0x0F];
+  }
+}
+
+static void publish_if_changed(sensor::Sensor *sensor, const float value) {
+  if ((sensor != nullptr) && (!sensor->has_state() || (sensor->get_raw_state() != value))) {
+    sensor->publish_state(value);
   }
 }
 
-static bool remove_from_vector(std::vector<uint8_t> &vec, const uint8_t value) {
-  auto it = std::find(vec.begin(), vec.end(), value);
-  if (it != vec.end()) {
-    vec.erase(it);
-    return true;
+#ifdef UYAT_LATENCY_ENABLED
+static void publish_latency(sensor::Sensor *p50, sensor::Sensor *p95, sensor::Sensor *max,
+                            const TimingHistogram &histogram) {
+  if (histogram.count() == 0u) {
+    return;
   }
-  return false;
+  publish_if_changed(p50, histogram.percentile_us(50u) / 1000.0f);
+  publish_if_changed(p95, histogram.percentile_us(95u) / 1000.0f);
+  publish_if_changed(max, histogram.max_us() / 1000.0f);
 }
 #endif
+#endif
 
 void Uyat::setup() {
-  schedule_heartbeat_(true);
+  this->start();
   if (this->status_pin_ != nullptr) {
     this->status_pin_->digital_write(false);
   }
 
 #ifdef UYAT_DIAGNOSTICS_ENABLED
-  if ((this->num_garbage_bytes_sensor_) || (this->unknown_commands_text_sensor_) ||
-      (this->unknown_extended_commands_text_sensor_) || (this->unhandled_datapoints_text_sensor_))
+  if (this->has_periodic_diag_sensors_())
   {
-    this->set_interval("diag_sensors_update", 1000, [this]{
-      if (this->num_garbage_bytes_sensor_)
-      {
-        this->num_garbage_bytes_sensor_->publish_state(this->num_garbage_bytes_);
-      }
-
-      if (this->unknown_commands_text_sensor_)
-      {
-        const auto cmd_ids = format_hex_pretty(this->unknown_commands_set_, ' ', false);
-        this->unknown_commands_text_sensor_->publish_state(cmd_ids);
-      }
-
-      if (this->unknown_extended_commands_text_sensor_)
-      {
-        const auto cmd_ids = format_hex_pretty(this->unknown_extended_commands_set_, ' ', false);
-        this->unknown_extended_commands_text_sensor_->publish_state(cmd_ids);
-      }
-
-      if (this->unhandled_datapoints_text_sensor_)
-      {
-        const auto dp_ids = format_hex_pretty(this->unhandled_datapoints_set_, ' ', false);
-        this->unhandled_datapoints_text_sensor_->publish_state(dp_ids);
-      }
-
+    // the interval only limits the publishing rate, sensors are published when their value changes
+    this->set_interval("diag_sensors_update", this->diag_publish_interval_ms_, [this]{
+      this->publish_periodic_diag_sensors_();
     });
   }
 
@@ -75,599 +65,254 @@ void Uyat::setup() {
     update_pairing_mode_sensor_();
   });
 #endif
-}
-
-void Uyat::loop() {
-  const auto start_ts = millis();
-  uint64_t now = start_ts;
-  auto number_of_bytes = this->available();
-  while (number_of_bytes > 0)
-  {
-    uint8_t c;
-    this->read_byte(&c);
-    this->rx_message_.push_back(c);
-    this->last_rx_char_timestamp_ = millis();
-    if (now >= (start_ts + UART_MAX_POLL_TIME_MS))
-    {
-      break;
-    }
 
-    --number_of_bytes;
-  }
-  this->handle_input_buffer_();
-  process_command_queue_();
+#ifdef UYAT_PROFILER_ENABLED
+  this->set_interval("profiler_report", this->profiler_window_ms_, [this]{
+    this->report_profiler_window_();
+  });
+#endif
 }
 
-void Uyat::dump_config() {
-  ESP_LOGCONFIG(TAG, "Uyat:");
-  if (this->init_state_ != UyatInitState::INIT_DONE) {
-    if (this->init_failed_) {
-      ESP_LOGCONFIG(TAG, "  Initialization failed. Current init_state: %u",
-                    static_cast<uint8_t>(this->init_state_));
-    } else {
-      ESP_LOGCONFIG(TAG,
-                    "  Configuration will be reported when setup is complete. "
-                    "Current init_state: %u",
-                    static_cast<uint8_t>(this->init_state_));
-    }
-    ESP_LOGCONFIG(TAG, "  If no further output is received, confirm that this "
-                       "is a supported Uyat device.");
-  }
-
-  ESP_LOGCONFIG(TAG, "  Listeners:");
-  for (const auto &dp : this->listeners_) {
-    ESP_LOGCONFIG(TAG, "    %s", dp.configured.to_string().c_str());
-  }
+#ifdef UYAT_DIAGNOSTICS_ENABLED
+// the latency and memory tracking is only compiled in when some of its sensors are configured
+#if defined(UYAT_LATENCY_ENABLED) || defined(UYAT_MEMORY_STATS_ENABLED)
+static constexpr bool LATENCY_OR_MEMORY_SENSORS = true;
+#else
+static constexpr bool LATENCY_OR_MEMORY_SENSORS = false;
+#endif
 
-  if (this->init_state_ > UyatInitState::INIT_CONF) {
-    if ((this->status_pin_reported_ != -1) || (this->reset_pin_reported_ != -1)) {
-      ESP_LOGCONFIG(TAG, "  GPIO Configuration: status: pin %d, reset: pin %d",
-                    this->status_pin_reported_, this->reset_pin_reported_);
-    }
-    LOG_PIN("  Status Pin: ", this->status_pin_);
-    ESP_LOGCONFIG(TAG, "  Product: '%s'", this->product_.c_str());
-  }
+bool Uyat::has_periodic_diag_sensors_() const {
+  return LATENCY_OR_MEMORY_SENSORS || (this->num_garbage_bytes_sensor_) || (this->unknown_commands_text_sensor_) ||
+         (this->unknown_extended_commands_text_sensor_) || (this->unhandled_datapoints_text_sensor_) ||
+         (this->frames_received_sensor_) || (this->frames_sent_sensor_) || (this->checksum_errors_sensor_) ||
+         (this->response_timeouts_sensor_) || (this->command_retries_sensor_) || (this->dropped_commands_sensor_) ||
+         (this->queue_high_water_mark_sensor_) || (this->rx_bytes_per_second_sensor_) ||
+         (this->tx_bytes_per_second_sensor_) || (this->rx_utilisation_sensor_) || (this->tx_utilisation_sensor_) ||
+         (this->datapoint_write_headroom_sensor_) || (this->command_statistics_text_sensor_) ||
+         (this->datapoint_statistics_text_sensor_);
 }
 
-std::size_t Uyat::validate_message_() {
+void Uyat::publish_periodic_diag_sensors_() {
+  publish_if_changed(this->num_garbage_bytes_sensor_, this->num_garbage_bytes_);
 
-  const auto current_size = this->rx_message_.size();
-  if (current_size < (2u + 1u + 1u + 2u + 1u)) // header + version + command + length + checksum
-  {
-    return 0u;  // don't remove anything yet
-  }
-
-  if (this->rx_message_.at(0u) != 0x55)
-  {
-    return 1u;
+  if (this->diag_dirty_ & DIAG_DIRTY_UNKNOWN_COMMANDS) {
+    this->publish_ids_(this->unknown_commands_text_sensor_, this->unknown_commands_set_);
   }
-
-  if (this->rx_message_.at(1u) != 0xAA)
-  {
-    return 1u;  // remove just the first 0x55, in case it is followed by another 0x55
+  if (this->diag_dirty_ & DIAG_DIRTY_UNKNOWN_EXTENDED_COMMANDS) {
+    this->publish_ids_(this->unknown_extended_commands_text_sensor_, this->unknown_extended_commands_set_);
   }
-
-  const uint8_t version = this->rx_message_.at(2u);
-  const uint8_t command = this->rx_message_.at(3u);
-  const uint16_t length = (uint16_t(this->rx_message_.at(4u)) << 8) | (uint16_t(this->rx_message_.at(5u)));
-  const auto checksum_offset = 6u + length;
-  if ((checksum_offset + 1u) > current_size)  // offset of data field + length + checksum
-  {
-    return 0u;
+  if (this->diag_dirty_ & DIAG_DIRTY_UNHANDLED_DATAPOINTS) {
+    this->publish_ids_(this->unhandled_datapoints_text_sensor_, this->unhandled_datapoints_set_);
   }
-
-  // Byte 6+LEN: CHECKSUM - sum of all bytes (including header) modulo 256
-  const uint8_t rx_checksum = this->rx_message_.at(checksum_offset);
-  uint8_t calc_checksum = 0;
-  for (std::size_t i = 0; i < checksum_offset; ++i)
-    calc_checksum += this->rx_message_.at(i);
-
-  if (rx_checksum != calc_checksum) {
-    ESP_LOGW(TAG, "Received invalid message checksum %02X!=%02X",
-             rx_checksum, calc_checksum);
-    return 1u;
+#ifdef UYAT_DATAPOINT_STATS_ENABLED
+  if ((this->diag_dirty_ & DIAG_DIRTY_DATAPOINT_STATS) && (this->datapoint_statistics_text_sensor_)) {
+    this->datapoint_stats_.format_json_into(this->diag_text_buffer_, this->clock_.get_millis());
+    this->datapoint_statistics_text_sensor_->publish_state(this->diag_text_buffer_);
   }
-
-  // valid message
-  const size_t data_offset = 6u;
-  const size_t data_len = checksum_offset - data_offset;
-  ESP_LOGV(TAG, "Received Uyat: CMD=0x%02X VERSION=%u LEN=%zu INIT_STATE=%u",
-           command, version, data_len,
-           static_cast<uint8_t>(this->init_state_));
-  this->handle_command_(command, version, this->rx_message_, data_offset, data_len);
-
-  // the whole message can now be removed
-  return (checksum_offset + 1u);
-}
-
-void Uyat::handle_input_buffer_() {
-  do
-  {
-    auto bytes_to_remove = this->validate_message_();
-    if (bytes_to_remove == 0)
-    {
-      break;
-    }
-    if (bytes_to_remove > this->rx_message_.size()) // just for safety, in case the validate_message_() is buggy
-    {
-      ESP_LOGW(TAG, "BUG: tryng to remove more bytes than possible %zu > %zu",
-        bytes_to_remove, this->rx_message_.size());
-      bytes_to_remove = this->rx_message_.size();
-    }
-
-#ifdef UYAT_DIAGNOSTICS_ENABLED
-    if (bytes_to_remove <= 1u)
-    {
-      this->num_garbage_bytes_ += bytes_to_remove;
-    }
 #endif
-    this->rx_message_.erase(this->rx_message_.begin(), this->rx_message_.begin() + bytes_to_remove);
-  } while ((this->command_queue_.empty()) && (!this->rx_message_.empty()));  // stop if there's message to be sent or no input
+  this->diag_dirty_ = 0;
+
+  this->statistics_.update_rates(this->clock_.get_millis());
+  publish_if_changed(this->frames_received_sensor_, this->statistics_.get_frames_received());
+  publish_if_changed(this->frames_sent_sensor_, this->statistics_.get_frames_sent());
+  publish_if_changed(this->checksum_errors_sensor_, this->statistics_.get_checksum_errors());
+  publish_if_changed(this->response_timeouts_sensor_, this->statistics_.get_response_timeouts());
+  publish_if_changed(this->command_retries_sensor_, this->statistics_.get_retries());
+  publish_if_changed(this->dropped_commands_sensor_, this->statistics_.get_dropped_commands());
+  publish_if_changed(this->queue_high_water_mark_sensor_, this->statistics_.get_queue_high_water_mark());
+  publish_if_changed(this->rx_bytes_per_second_sensor_, this->statistics_.get_rx_bytes_per_second());
+  publish_if_changed(this->tx_bytes_per_second_sensor_, this->statistics_.get_tx_bytes_per_second());
+  const auto baud_rate = this->parent_->get_baud_rate();
+  publish_if_changed(this->rx_utilisation_sensor_,
+                     UyatStatistics::utilisation_percent(this->statistics_.get_rx_bytes_per_second(), baud_rate));
+  publish_if_changed(this->tx_utilisation_sensor_,
+                     UyatStatistics::utilisation_percent(this->statistics_.get_tx_bytes_per_second(), baud_rate));
+  if (this->datapoint_write_headroom_sensor_) {
+    const auto write_size = this->statistics_.get_average_frame_size(
+        static_cast<uint8_t>(UyatCommandType::DATAPOINT_DELIVER), true, MIN_DATAPOINT_FRAME_SIZE);
+    const auto report_size = this->statistics_.get_average_frame_size(
+        static_cast<uint8_t>(UyatCommandType::DATAPOINT_REPORT_ASYNC), false, MIN_DATAPOINT_FRAME_SIZE);
+    publish_if_changed(this->datapoint_write_headroom_sensor_,
+                       this->statistics_.get_datapoint_write_headroom(baud_rate, write_size, report_size));
+  }
+
+  const auto total_frames = this->statistics_.get_frames_received() + this->statistics_.get_frames_sent();
+  if ((this->command_statistics_text_sensor_) && (total_frames != this->published_total_frames_)) {
+    this->published_total_frames_ = total_frames;
+    this->statistics_.format_commands_into(this->diag_text_buffer_);
+    this->command_statistics_text_sensor_->publish_state(this->diag_text_buffer_);
+  }
+
+#ifdef UYAT_LATENCY_ENABLED
+  this->publish_latency_sensors_();
+#endif
+#ifdef UYAT_MEMORY_STATS_ENABLED
+  this->publish_memory_sensors_();
+#endif
 }
 
-void Uyat::handle_command_(uint8_t command, uint8_t version,
-                           const std::deque<uint8_t> &buffer,
-                           size_t offset, size_t len) {
-  UyatCommandType command_type = (UyatCommandType)command;
-
-  if (this->expected_response_.has_value() &&
-      this->expected_response_ == command_type) {
-    this->expected_response_.reset();
-    this->command_queue_.erase(command_queue_.begin());
-    this->init_retries_ = 0;
+#ifdef UYAT_LATENCY_ENABLED
+void Uyat::publish_latency_sensors_() {
+  if (this->latency_.get_generation() == this->published_latency_generation_) {
+    return;
   }
+  this->published_latency_generation_ = this->latency_.get_generation();
 
-  switch (command_type) {
-  case UyatCommandType::HEARTBEAT:
-    ESP_LOGV(TAG, "MCU Heartbeat (0x%02X)", this->byte_at_(buffer, offset, 0));
-    this->protocol_version_ = version;
-    if (this->byte_at_(buffer, offset, 0) == 0) {
-      ESP_LOGI(TAG, "MCU restarted");
-    }
-    schedule_heartbeat_(false);
-    if (this->init_state_ == UyatInitState::INIT_HEARTBEAT) {
-      this->init_state_ = UyatInitState::INIT_PRODUCT;
-      this->query_product_info_with_retries_();
-    }
-    break;
-  case UyatCommandType::PRODUCT_QUERY: {
-    // check it is a valid string made up of printable characters
-    bool valid = true;
-    for (size_t i = 0; i < len; i++) {
-      if (!std::isprint(this->byte_at_(buffer, offset, i))) {
-        valid = false;
-        break;
-      }
-    }
-    if (valid) {
-      this->product_ = std::string(reinterpret_cast<const char *>(buffer), len);
-#ifdef UYAT_DIAGNOSTICS_ENABLED
-      if (this->product_text_sensor_)
-      {
-        this->product_text_sensor_->publish_state(this->product_);
-      }
+  using Interval = UyatLatencyTracker::Interval;
+  publish_latency(this->rx_to_dispatch_latency_p50_sensor_, this->rx_to_dispatch_latency_p95_sensor_,
+                  this->rx_to_dispatch_latency_max_sensor_, this->latency_.get(Interval::RX_TO_DISPATCH));
+  publish_latency(this->set_to_tx_latency_p50_sensor_, this->set_to_tx_latency_p95_sensor_,
+                  this->set_to_tx_latency_max_sensor_, this->latency_.get(Interval::SET_TO_TX));
+  publish_latency(this->tx_to_report_latency_p50_sensor_, this->tx_to_report_latency_p95_sensor_,
+                  this->tx_to_report_latency_max_sensor_, this->latency_.get(Interval::TX_TO_REPORT));
+}
 #endif
-    } else {
-      this->product_ = R"({"p":"INVALID"})";
-    }
 
-    if (this->init_state_ == UyatInitState::INIT_PRODUCT) {
-      this->init_state_ = UyatInitState::INIT_CONF;
-      this->send_empty_command_(UyatCommandType::CONF_QUERY);
+#ifdef UYAT_MEMORY_STATS_ENABLED
+void Uyat::publish_memory_sensors_() {
+  this->update_memory_stats_();
+  publish_if_changed(this->memory_used_sensor_, this->memory_stats_.get_total().current);
+  publish_if_changed(this->memory_peak_sensor_, this->memory_stats_.get_total().peak);
+  if (this->memory_usage_text_sensor_) {
+    this->memory_stats_.format_into(this->diag_text_buffer_);
+    if (!this->memory_usage_text_sensor_->has_state() || (this->memory_usage_text_sensor_->state != this->diag_text_buffer_)) {
+      this->memory_usage_text_sensor_->publish_state(this->diag_text_buffer_);
     }
-    break;
   }
-  case UyatCommandType::CONF_QUERY: {
-    if (len >= 2) {
-      this->status_pin_reported_ = this->byte_at_(buffer, offset, 0);
-      this->reset_pin_reported_ = this->byte_at_(buffer, offset, 1);
-    }
-    if (this->init_state_ == UyatInitState::INIT_CONF) {
-      // If mcu returned status gpio, then we can omit sending wifi state
-      if (this->status_pin_reported_ != -1) {
-        this->wifi_status_ = UyatNetworkStatus::CLOUD_CONNECTED;
-        this->init_state_ = UyatInitState::INIT_DATAPOINT;
-        this->send_empty_command_(UyatCommandType::DATAPOINT_QUERY);
-        bool is_pin_equals =
-            this->status_pin_ != nullptr &&
-            this->status_pin_->get_pin() == this->status_pin_reported_;
-        // Configure status pin toggling (if reported and configured) or
-        // WIFI_STATE periodic send
-        if (is_pin_equals) {
-          ESP_LOGV(TAG, "Configured status pin %i", this->status_pin_reported_);
-          this->defer([this] { this->set_status_pin_(); });
-        } else {
-          ESP_LOGW(TAG,
-                   "Supplied status_pin does not equals the reported pin %i. "
-                   "UyatMcu will work in limited mode.",
-                   this->status_pin_reported_);
-        }
-      } else {
-
-        this->init_state_ = UyatInitState::INIT_WIFI;
-        if (this->requested_wifi_config_is_ap_.has_value())
-        {
-          if (this->requested_wifi_config_is_ap_.value())
-          {
-            this->wifi_status_ = UyatNetworkStatus::AP_MODE;
-          }
-          else
-          {
-            this->wifi_status_ = UyatNetworkStatus::SMARTCONFIG;
-          }
-        }
-        else
-        {
-          this->wifi_status_ = UyatNetworkStatus::WIFI_CONFIGURED;
-        }
-        this->requested_wifi_config_is_ap_.reset();
-#ifdef UYAT_DIAGNOSTICS_ENABLED
-        update_pairing_mode_sensor_();
+}
 #endif
 
-        this->send_wifi_status_(static_cast<uint8_t>(this->wifi_status_));
-        this->wifi_status_ = UyatNetworkStatus::WIFI_CONNECTED;
-        this->send_wifi_status_(static_cast<uint8_t>(this->wifi_status_));
-        this->wifi_status_ = UyatNetworkStatus::CLOUD_CONNECTED;
-        this->send_wifi_status_(static_cast<uint8_t>(this->wifi_status_));
-        this->init_state_ = UyatInitState::INIT_DATAPOINT;
-        this->send_empty_command_(UyatCommandType::DATAPOINT_QUERY);
-      }
-    }
-    break;
-  }
-  case UyatCommandType::WIFI_STATE:
-    if (this->init_state_ == UyatInitState::INIT_WIFI) {
-      if ((this->wifi_status_ == UyatNetworkStatus::SMARTCONFIG) || (this->wifi_status_ == UyatNetworkStatus::AP_MODE))
-      {
-        this->wifi_status_ = UyatNetworkStatus::WIFI_CONFIGURED;
-        this->send_wifi_status_(static_cast<uint8_t>(this->wifi_status_));
-      }
-
-      if (this->wifi_status_ == UyatNetworkStatus::WIFI_CONFIGURED)
-      {
-        this->report_wifi_connected_or_retry_(100u);
-      }
-      else if (this->wifi_status_ == UyatNetworkStatus::WIFI_CONNECTED)
-      {
-        this->wifi_status_ = UyatNetworkStatus::CLOUD_CONNECTED;
-        this->send_wifi_status_(static_cast<uint8_t>(this->wifi_status_));
-      }
-      else if (this->wifi_status_ == UyatNetworkStatus::CLOUD_CONNECTED)
-      {
-        this->init_state_ = UyatInitState::INIT_DATAPOINT;
-        this->send_empty_command_(UyatCommandType::DATAPOINT_QUERY);
-      }
-    }
-    break;
-  case UyatCommandType::WIFI_RESET:
-  {
-    ESP_LOGI(TAG, "WIFI_RESET");
-    this->init_state_ = UyatInitState::INIT_PRODUCT;
-    this->send_empty_command_(UyatCommandType::WIFI_RESET);
-    this->schedule_heartbeat_(true);
-    this->query_product_info_with_retries_();
-    break;
+void Uyat::publish_ids_(text_sensor::TextSensor *sensor, const std::vector<uint8_t> &ids) {
+  if (sensor == nullptr) {
+    return;
   }
-  case UyatCommandType::WIFI_SELECT: {
-      ESP_LOGI(TAG, "WIFI_SELECT");
-      if (len > 0)
-      {
-        this->requested_wifi_config_is_ap_ = (this->byte_at_(buffer, offset, 0) == 0x01);
-      }
-      else
-      {
-        this->requested_wifi_config_is_ap_ = 0x00;  // SMARTCONFIG
-      }
-
-#ifdef UYAT_DIAGNOSTICS_ENABLED
-      update_pairing_mode_sensor_();
+  format_ids_into(this->diag_text_buffer_, ids);
+  sensor->publish_state(this->diag_text_buffer_);
+}
 #endif
 
-      this->init_state_ = UyatInitState::INIT_PRODUCT;
-      this->send_empty_command_(UyatCommandType::WIFI_SELECT);
-      this->schedule_heartbeat_(true);
-      this->query_product_info_with_retries_();
-      break;
-    }
-  case UyatCommandType::DATAPOINT_DELIVER:
-    break;
-  case UyatCommandType::DATAPOINT_REPORT_ASYNC:
-  case UyatCommandType::DATAPOINT_REPORT_SYNC:
-    if (this->init_state_ == UyatInitState::INIT_DATAPOINT) {
-      this->init_state_ = UyatInitState::INIT_DONE;
-      this->set_timeout("datapoint_dump", 1000,
-                        [this] { this->dump_config(); });
-      this->initialized_callback_.call();
+#ifdef UYAT_PROFILER_ENABLED
+void Uyat::report_profiler_window_() {
+  std::string summary;
+  for (uint8_t i = 0; i < static_cast<uint8_t>(UyatProfiler::Phase::NUM_PHASES); ++i) {
+    const auto phase = static_cast<UyatProfiler::Phase>(i);
+    const auto &histogram = this->profiler_.get_phase(phase);
+    ESP_LOGD(TAG, "Profile %s: %s", UyatProfiler::phase_name(phase), histogram.to_string().c_str());
+    if (!summary.empty()) {
+      summary += ", ";
     }
-    this->handle_datapoints_(buffer, offset, len);
-
-    if (command_type == UyatCommandType::DATAPOINT_REPORT_SYNC) {
-      this->send_command_(
-          UyatCommand{.cmd = UyatCommandType::DATAPOINT_REPORT_ACK,
-                      .payload = std::vector<uint8_t>{0x01}});
-    }
-    break;
-  case UyatCommandType::DATAPOINT_QUERY:
-    break;
-  case UyatCommandType::WIFI_TEST:
-    this->send_command_(
-        UyatCommand{.cmd = UyatCommandType::WIFI_TEST,
-                    .payload = std::vector<uint8_t>{0x00, 0x00}});
-    break;
-  case UyatCommandType::WIFI_RSSI:
-    this->send_command_(
-        UyatCommand{.cmd = UyatCommandType::WIFI_RSSI,
-                    .payload = std::vector<uint8_t>{get_wifi_rssi_()}});
-    break;
-  case UyatCommandType::DISABLE_HEARTBEATS:
-    stop_heartbeats_();
-    ESP_LOGI(TAG, "Heartbeats disabled by MCU");
-    break;
-#ifdef USE_TIME
-  case UyatCommandType::LOCAL_TIME_QUERY:
-    if (this->time_id_ != nullptr) {
-      this->send_local_time_();
-
-      if (!this->time_sync_callback_registered_) {
-        // uyat mcu supports time, so we let them know when our time changed
-        this->time_id_->add_on_time_sync_callback(
-            [this] { this->send_local_time_(); });
-        this->time_sync_callback_registered_ = true;
-      }
-    } else
-    {
-      ESP_LOGW(
-          TAG,
-          "LOCAL_TIME_QUERY is not handled because time is not configured");
-    }
-    break;
-#endif
-  // case UyatCommandType::VACUUM_MAP_UPLOAD:
-  //   this->send_command_(UyatCommand{.cmd = UyatCommandType::VACUUM_MAP_UPLOAD,
-  //                                   .payload = std::vector<uint8_t>{0x01}});
-  //   ESP_LOGW(TAG,
-  //            "Vacuum map upload requested, responding that it is not enabled.");
-  //   break;
-  case UyatCommandType::GET_NETWORK_STATUS: {
-    this->send_command_(
-        UyatCommand{.cmd = UyatCommandType::GET_NETWORK_STATUS,
-                    .payload = std::vector<uint8_t>{this->wifi_status_}});
-    ESP_LOGV(TAG, "Network status requested, reported as %i", this->wifi_status_);
-    break;
+    summary += str_sprintf("%s: %u/%u/%u/%u", UyatProfiler::phase_name(phase), histogram.min_us(), histogram.avg_us(),
+                           histogram.max_us(), histogram.percentile_us(99u));
   }
-  case UyatCommandType::GET_MAC_ADDRESS: {
-    std::vector<uint8_t> mac(6u);
-    get_mac_address_raw(mac.data());
-    this->send_command_(
-        UyatCommand{.cmd = UyatCommandType::GET_MAC_ADDRESS,
-                    .payload = mac});
-    ESP_LOGV(TAG, "MAC address requested, reported as %s",
-              format_hex_pretty(mac).c_str());
-    break;
+
+  const auto &slowest = this->profiler_.get_slowest_listener();
+  if (slowest.has_value()) {
+    ESP_LOGD(TAG, "Profile slowest listener: datapoint %u, %uus", slowest->dp_number, slowest->duration_us);
   }
-  case UyatCommandType::EXTENDED_SERVICES: {
-    uint8_t subcommand = this->byte_at_(buffer, offset, 0);
-    switch ((UyatExtendedServicesCommandType)subcommand) {
-    case UyatExtendedServicesCommandType::RESET_NOTIFICATION: {
-      this->send_command_(UyatCommand{
-          .cmd = UyatCommandType::EXTENDED_SERVICES,
-          .payload = std::vector<uint8_t>{
-              static_cast<uint8_t>(
-                  UyatExtendedServicesCommandType::RESET_NOTIFICATION),
-              0x00}});
-      ESP_LOGV(TAG, "Reset status notification enabled");
-      break;
-    }
-    case UyatExtendedServicesCommandType::FACTORY_RESET: {
-      ESP_LOGD(TAG, "Factory reset acked by MCU");
-      break;
-    }
-    case UyatExtendedServicesCommandType::UPDATE_IN_PROGRESS: {
-      ESP_LOGE(TAG, "EXTENDED_SERVICES::UPDATE_IN_PROGRESS is not handled");
-      break;
-    }
-    case UyatExtendedServicesCommandType::GET_MODULE_INFORMATION: {
-      std::vector<uint8_t> response_payload;
-      std::string module_info_str;
-      response_payload.push_back(static_cast<uint8_t>(
-                  UyatExtendedServicesCommandType::GET_MODULE_INFORMATION));
-      if (len >= 2)
-      {
-        module_info_str = process_get_module_information_(&buffer[1], len - 1);
-      }
-
-      if (module_info_str.empty())
-      {
-        response_payload.push_back(0x01);  // failure
-      }
-      else
-      {
-        response_payload.push_back(0x00);  // success
-        response_payload.insert(response_payload.end(),
-                                module_info_str.begin(),
-                                module_info_str.end());
-      }
-
-      send_raw_command_(UyatCommand{
-          .cmd = UyatCommandType::EXTENDED_SERVICES,
-          .payload = response_payload});
-      break;
-    }
-    default:
-#ifdef UYAT_DIAGNOSTICS_ENABLED
-      add_unique_to_vector(this->unknown_extended_commands_set_, subcommand);
-#endif
-      ESP_LOGE(TAG, "Invalid extended services subcommand (0x%02X) received",
-               subcommand);
-    }
-    break;
+
+  if (this->profiler_summary_text_sensor_) {
+    this->profiler_summary_text_sensor_->publish_state(summary);
   }
-  default:
-#ifdef UYAT_DIAGNOSTICS_ENABLED
-    add_unique_to_vector(this->unknown_commands_set_, command);
-#endif
-    ESP_LOGE(TAG, "Invalid command (0x%02X) received", command);
+  if (this->max_loop_time_sensor_) {
+    this->max_loop_time_sensor_->publish_state(this->profiler_.get_phase(UyatProfiler::Phase::LOOP).max_us() / 1000.0f);
   }
+  this->profiler_.reset_window();
 }
+#endif
 
-void Uyat::handle_datapoints_(const std::deque<uint8_t> &buffer, size_t offset, size_t len) {
-  while (len >= 4) {
-    std::size_t used_len = 0u;
-    auto datapoint = UyatDatapoint::construct(buffer, offset, len, used_len);
-    if (used_len == 0u)
-    {
-      used_len = len;
-    }
-
-    len -= used_len;
-    offset += used_len;
-
-    if (datapoint)
-    {
-      ESP_LOGD(TAG, "MCU reported %s", datapoint->to_string().c_str());
-      // drop update if datapoint is in ignore_mcu_datapoint_update list
-      if (this->ignore_mcu_update_on_datapoints_.end() != std::find(this->ignore_mcu_update_on_datapoints_.begin(), this->ignore_mcu_update_on_datapoints_.end(), datapoint->number))
-      {
-          ESP_LOGV(TAG,
-                  "Datapoint %u found in ignore_mcu_update_on_datapoints list, "
-                  "dropping MCU update",
-                  datapoint->number);
-      }
-      else
-      {
-        // Update internal datapoints
-        bool found = false;
-        for (auto &other : this->cached_datapoints_) {
-          if (other.matches(datapoint.value())) {
-            other = datapoint.value();
-            found = true;
-          }
-        }
-        if (!found) {
-          this->cached_datapoints_.push_back(datapoint.value());
-        }
-
-        // Run through listeners
-        bool handled = false;
-        for (auto &listener : this->listeners_) {
-          if (datapoint->matches(listener.configured))
-          {
-            listener.on_datapoint(datapoint.value());
-            handled = true;
-          }
-        }
+void Uyat::loop() {
+  this->poll();
+}
 
-#ifdef UYAT_DIAGNOSTICS_ENABLED
-        if (!handled)
-        {
-          add_unique_to_vector(this->unhandled_datapoints_set_, datapoint->number);
-        }
-        else
-        {
-          (void) remove_from_vector(this->unhandled_datapoints_set_, datapoint->number);
-        }
-#endif
-      }
-    }
+void Uyat::dump_config() {
+  ESP_LOGCONFIG(TAG, "Uyat:");
+  this->dump_core_config();
+  if (this->init_state_ > UyatInitState::INIT_CONF) {
+    LOG_PIN("  Status Pin: ", this->status_pin_);
   }
 }
 
-void Uyat::send_raw_command_(UyatCommand command) {
-  uint8_t len_hi = (uint8_t)(command.payload.size() >> 8);
-  uint8_t len_lo = (uint8_t)(command.payload.size() & 0xFF);
-  uint8_t version = 0;
-
-  this->last_command_timestamp_ = millis();
-  switch (command.cmd) {
-  case UyatCommandType::HEARTBEAT:
-    this->expected_response_ = UyatCommandType::HEARTBEAT;
-    break;
-  case UyatCommandType::PRODUCT_QUERY:
-    this->expected_response_ = UyatCommandType::PRODUCT_QUERY;
-    break;
-  case UyatCommandType::CONF_QUERY:
-    this->expected_response_ = UyatCommandType::CONF_QUERY;
-    break;
-  case UyatCommandType::DATAPOINT_DELIVER:
-  case UyatCommandType::DATAPOINT_QUERY:
-    this->expected_response_ = UyatCommandType::DATAPOINT_REPORT_ASYNC;
-    break;
-  default:
-    break;
+void Uyat::start_timer(const char *name, uint32_t delay_ms, bool repeat, TimerCallback &&callback) {
+  if (repeat) {
+    this->set_interval(name, delay_ms, std::move(callback));
+  } else {
+    this->set_timeout(name, delay_ms, std::move(callback));
   }
+}
 
-  ESP_LOGV(TAG, "Sending Uyat: CMD=0x%02X VERSION=%u DATA=[%s] INIT_STATE=%u",
-           static_cast<uint8_t>(command.cmd), version,
-           format_hex_pretty(command.payload).c_str(),
-           static_cast<uint8_t>(this->init_state_));
-
-  this->write_array(
-      {0x55, 0xAA, version, (uint8_t)command.cmd, len_hi, len_lo});
-  if (!command.payload.empty())
-    this->write_array(command.payload.data(), command.payload.size());
-
-  uint8_t checksum = 0x55 + 0xAA + (uint8_t)command.cmd + len_hi + len_lo;
-  for (auto &data : command.payload)
-    checksum += data;
-  this->write_byte(checksum);
+void Uyat::stop_timer(const char *name) {
+  // the names are unique across the timeouts and intervals
+  this->cancel_timeout(name);
+  this->cancel_interval(name);
 }
 
-void Uyat::process_command_queue_() {
-  uint32_t now = millis();
-  uint32_t delay = now - this->last_command_timestamp_;
+void Uyat::on_initialized_() {
+  this->set_timeout("datapoint_dump", 1000,
+                    [this] { this->dump_config(); });
+  this->initialized_callback_.call();
+}
 
-  if (now - this->last_rx_char_timestamp_ > RECEIVE_TIMEOUT) {
-    this->rx_message_.clear();
+void Uyat::on_product_changed_() {
+#ifdef UYAT_DIAGNOSTICS_ENABLED
+  if (this->product_text_sensor_)
+  {
+    this->product_text_sensor_->publish_state(this->product_);
   }
+#endif
+}
 
-  if (this->expected_response_.has_value() && delay > RECEIVE_TIMEOUT) {
-    this->expected_response_.reset();
-    if (init_state_ != UyatInitState::INIT_DONE) {
-      if (++this->init_retries_ >= MAX_RETRIES) {
-        this->init_failed_ = true;
-        ESP_LOGE(TAG, "Initialization failed at init_state %u",
-                 static_cast<uint8_t>(this->init_state_));
-        this->command_queue_.erase(command_queue_.begin());
-        this->init_retries_ = 0;
-      }
-    } else {
-      this->command_queue_.erase(command_queue_.begin());
-    }
-  }
+void Uyat::on_pairing_mode_changed_() {
+#ifdef UYAT_DIAGNOSTICS_ENABLED
+  update_pairing_mode_sensor_();
+#endif
+}
 
-  // Left check of delay since last command in case there's ever a command sent
-  // by calling send_raw_command_ directly
-  if (delay > COMMAND_DELAY && !this->command_queue_.empty() &&
-      this->rx_message_.empty() && !this->expected_response_.has_value()) {
-    this->send_raw_command_(command_queue_.front());
-    if (!this->expected_response_.has_value())
-      this->command_queue_.erase(command_queue_.begin());
+void Uyat::on_status_pin_reported_(int pin) {
+  bool is_pin_equals =
+      this->status_pin_ != nullptr &&
+      this->status_pin_->get_pin() == pin;
+  // Configure status pin toggling (if reported and configured) or
+  // WIFI_STATE periodic send
+  if (is_pin_equals) {
+    ESP_LOGV(TAG, "Configured status pin %i", pin);
+    this->defer([this] { this->set_status_pin_(); });
+  } else {
+    ESP_LOGW(TAG,
+             "Supplied status_pin does not equals the reported pin %i. "
+             "UyatMcu will work in limited mode.",
+             pin);
   }
 }
 
-void Uyat::send_command_(const UyatCommand &command) {
-  command_queue_.push_back(command);
-  process_command_queue_();
+bool Uyat::is_network_connected_() {
+  return esphome::network::is_connected();
 }
 
-void Uyat::send_empty_command_(UyatCommandType command) {
-  send_command_(UyatCommand{.cmd = command, .payload = std::vector<uint8_t>{}});
+void Uyat::get_mac_address_(uint8_t *mac) {
+  get_mac_address_raw(mac);
 }
 
 void Uyat::set_status_pin_() {
   this->status_pin_->digital_write(true);
 }
 
-uint8_t Uyat::get_wifi_rssi_() { return FAKE_WIFI_RSSI; }
+#ifdef USE_TIME
+void Uyat::on_local_time_query_() {
+  if (this->time_id_ != nullptr) {
+    this->send_local_time_();
 
-void Uyat::send_wifi_status_(const uint8_t status) {
-  ESP_LOGD(TAG, "Sending WiFi Status %d", status);
-  this->send_command_(UyatCommand{.cmd = UyatCommandType::WIFI_STATE,
-                                  .payload = std::vector<uint8_t>{status}});
+    if (!this->time_sync_callback_registered_) {
+      // uyat mcu supports time, so we let them know when our time changed
+      this->time_id_->add_on_time_sync_callback(
+          [this] { this->send_local_time_(); });
+      this->time_sync_callback_registered_ = true;
+    }
+  } else
+  {
+    UyatCore::on_local_time_query_();
+  }
 }
 
-#ifdef USE_TIME
 void Uyat::send_local_time_() {
   std::vector<uint8_t> payload;
   ESPTime now = this->time_id_->now();
@@ -698,216 +343,6 @@ void Uyat::send_local_time_() {
 }
 #endif
 
-void Uyat::set_datapoint_value(const UyatDatapoint& dp, const bool forced ) {
-  ESP_LOGD(TAG, "Setting %s", dp.to_string().c_str());
-  auto configured_datapoint = this->get_datapoint_(dp.number);
-  if (configured_datapoint.has_value()) {
-    if (configured_datapoint->get_type() != dp.get_type())
-    {
-      ESP_LOGE(TAG, "Datapoint %u previously seen as %s setting as %s",
-              dp.number, configured_datapoint->get_type_name(), dp.get_type_name());
-    }
-    if (!forced && dp.value == configured_datapoint->value) {
-      ESP_LOGV(TAG, "Not sending unchanged value");
-      return;
-    }
-  }
-
-  this->send_datapoint_command_(dp.number, dp.get_type(), dp.value_to_payload());
-}
-
-optional<UyatDatapoint> Uyat::get_datapoint_(uint8_t datapoint_id) {
-  for (auto &datapoint : this->cached_datapoints_) {
-    if (datapoint.number == datapoint_id)
-      return datapoint;
-  }
-  return {};
-}
-
-void Uyat::send_datapoint_command_(uint8_t datapoint_id,
-                                   UyatDatapointType datapoint_type,
-                                   std::vector<uint8_t> data) {
-  std::vector<uint8_t> buffer;
-  buffer.push_back(datapoint_id);
-  buffer.push_back(static_cast<uint8_t>(datapoint_type));
-  buffer.push_back(data.size() >> 8);
-  buffer.push_back(data.size() >> 0);
-  buffer.insert(buffer.end(), data.begin(), data.end());
-
-  this->send_command_(UyatCommand{.cmd = UyatCommandType::DATAPOINT_DELIVER,
-                                  .payload = buffer});
-}
-
-void Uyat::register_datapoint_listener(const uint8_t datapoint_id,
-                             const OnDatapointCallback &func) {
-  register_datapoint_listener(MatchingDatapoint{.number = datapoint_id, .types = {}}, func);
-}
-
-void Uyat::register_datapoint_listener(const uint8_t datapoint_id,
-                             const UyatDatapointType type,
-                             const OnDatapointCallback &func) {
-  register_datapoint_listener(MatchingDatapoint{.number = datapoint_id, .types = {type}}, func);
-}
-
-void Uyat::register_datapoint_listener(const MatchingDatapoint& matching_dp,
-                             const OnDatapointCallback &func) {
-  auto listener = UyatDatapointListener{
-      .configured = matching_dp,
-      .on_datapoint = func,
-  };
-  this->listeners_.push_back(listener);
-
-  // Run through existing datapoints
-  for (auto &datapoint : this->cached_datapoints_) {
-    if (datapoint.matches(listener.configured))
-    {
-      listener.on_datapoint(datapoint);
-#ifdef UYAT_DIAGNOSTICS_ENABLED
-      remove_from_vector(this->unhandled_datapoints_set_, datapoint.number);
-#endif
-    }
-  }
-}
-
-UyatInitState Uyat::get_init_state() { return this->init_state_; }
-
-void Uyat::report_wifi_connected_or_retry_(const uint32_t delay_ms)
-{
-  if (esphome::network::is_connected())
-  {
-    this->wifi_status_ = UyatNetworkStatus::WIFI_CONNECTED;
-    this->send_wifi_status_(static_cast<uint8_t>(this->wifi_status_));
-    this->set_timeout("wifi_status", 100, [this] {
-      this->report_cloud_connected_();
-    });
-  }
-  else
-  {
-    ESP_LOGI(TAG, "WiFi not connected yet, will retry...");
-    this->set_timeout("wifi_status", delay_ms, [this, delay_ms] {
-      this->report_wifi_connected_or_retry_(delay_ms);
-    });
-  }
-}
-
-void Uyat::report_cloud_connected_()
-{
-  if (this->init_state_ != UyatInitState::INIT_WIFI)
-  {
-    return;
-  }
-  this->wifi_status_ = UyatNetworkStatus::CLOUD_CONNECTED;
-  this->send_wifi_status_(static_cast<uint8_t>(this->wifi_status_));
-}
-
-void Uyat::query_product_info_with_retries_()
-{
-  this->cancel_timeout("wifi_status");
-  this->cancel_timeout("product");
-  if (this->init_state_ != UyatInitState::INIT_PRODUCT)
-  {
-    return;
-  }
-
-  this->send_empty_command_(UyatCommandType::PRODUCT_QUERY);
-  this->set_timeout("product", 2000, [this] {
-      ESP_LOGW(TAG, "No response to PRODUCT_QUERY, retrying...");
-      this->query_product_info_with_retries_();
-    });
-}
-
-std::string Uyat::process_get_module_information_(const uint8_t *buffer, size_t len)
-{
-  // By default, we return an empty string indicating failure
-  bool want_ssid = false;
-  bool want_country_code = false;
-  bool want_sn = false;
-
-  if (len == 0)
-  {
-    return {};
-  }
-
-  if (buffer[0] == 0xFF) // special case: get all information
-  {
-    want_ssid = true;
-    want_country_code = true;
-    want_sn = true;
-  }
-  else
-  {
-    for (size_t i = 0; i < len; i++)
-    {
-      switch (buffer[i])
-      {
-        case 0x01:
-          want_ssid = true;
-          break;
-        case 0x02:
-          want_country_code = true;
-          break;
-        case 0x03:
-          want_sn = true;
-          break;
-        default:
-          ESP_LOGW(TAG, "Unknown GET_MODULE_INFORMATION request field 0x%02X",
-                   buffer[i]);
-      }
-    }
-  }
-
-  if (!want_ssid && !want_country_code && !want_sn)
-  {
-    return {};
-  }
-
-  std::string module_info_str = "{";
-
-  if (want_ssid)
-  {
-    module_info_str += "\"ap:\":\"" + report_ap_name_ + "\"";
-  }
-  if (want_country_code)
-  {
-    if (module_info_str.length() > 1)
-    {
-      module_info_str.push_back(',');
-    }
-    module_info_str += "\"cc\":\"0\"";  // 0 means China
-  }
-  if (want_sn)
-  {
-    if (module_info_str.length() > 1)
-    {
-      module_info_str.push_back(',');
-    }
-    module_info_str += "\"sn\":\"1234567890\"";
-  }
-
-  module_info_str.push_back('}');
-
-  return module_info_str;
-}
-
-void Uyat::schedule_heartbeat_(const bool initial)
-{
-  const uint32_t delay_ms = initial ? 1000u : 15000u;
-  this->cancel_interval("heartbeat");
-  this->heartbeats_enabled_ = true;
-  this->set_interval("heartbeat", delay_ms, [this] {
-    if (this->heartbeats_enabled_)
-    {
-      this->send_empty_command_(UyatCommandType::HEARTBEAT);
-    }
-  });
-}
-
-void Uyat::stop_heartbeats_()
-{
-  this->cancel_interval("heartbeat");
-  this->heartbeats_enabled_ = false;
-}
-
 #ifdef UYAT_DIAGNOSTICS_ENABLED
 void Uyat::update_pairing_mode_sensor_()
 {
@@ -930,15 +365,4 @@ void Uyat::update_pairing_mode_sensor_()
 }
 #endif
 
-void Uyat::trigger_factory_reset(const FactoryResetType reset_type)
-{
-  send_raw_command_(UyatCommand{
-      .cmd = UyatCommandType::EXTENDED_SERVICES,
-      .payload = std::vector<uint8_t>{
-          static_cast<uint8_t>(UyatExtendedServicesCommandType::FACTORY_RESET),
-          reset_type
-          }});
-}
-
-
 } // namespace esphome::uyat
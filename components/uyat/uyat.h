@@ -17,78 +17,21 @@
 #include "esphome/core/time.h"
 #endif
 
-#include "uyat_datapoint_types.h"
+#include "uyat_core.h"
 
 namespace esphome::uyat
 {
 
-enum UyatNetworkStatus: uint8_t {
-  SMARTCONFIG = 0x00,
-  AP_MODE = 0x01,
-  WIFI_CONFIGURED = 0x02,
-  WIFI_CONNECTED = 0x03,
-  CLOUD_CONNECTED = 0x04,
-};
-
-
-enum FactoryResetType: uint8_t {
-  BY_HW = 0x00, // Reset by hardware operation
-  BY_APP = 0x01, // Reset performed on the mobile app
-  BY_APP_WIPE = 0x02 // Factory reset performed on the mobile app
-};
-
-
-struct UyatDatapointListener {
-  MatchingDatapoint configured;
-  OnDatapointCallback on_datapoint;
-};
-
-enum class UyatCommandType : uint8_t {
-  HEARTBEAT = 0x00,
-  PRODUCT_QUERY = 0x01,
-  CONF_QUERY = 0x02,
-  WIFI_STATE = 0x03,
-  WIFI_RESET = 0x04,
-  WIFI_SELECT = 0x05,
-  DATAPOINT_DELIVER = 0x06,
-  DATAPOINT_REPORT_ASYNC = 0x07,
-  DATAPOINT_QUERY = 0x08,
-  WIFI_TEST = 0x0E,
-  LOCAL_TIME_QUERY = 0x1C,
-  DATAPOINT_REPORT_SYNC = 0x22,
-  DATAPOINT_REPORT_ACK = 0x23,
-  WIFI_RSSI = 0x24,
-  DISABLE_HEARTBEATS = 0x25,
-  VACUUM_MAP_UPLOAD = 0x28,
-  GET_NETWORK_STATUS = 0x2B,
-  GET_MAC_ADDRESS = 0x2D,
-  EXTENDED_SERVICES = 0x34,
-};
-
-enum class UyatExtendedServicesCommandType : uint8_t {
-  RESET_NOTIFICATION = 0x04,
-  FACTORY_RESET = 0x05,
-  GET_MODULE_INFORMATION = 0x07,
-  UPDATE_IN_PROGRESS = 0x0A,
-};
-
-enum class UyatInitState : uint8_t {
-  INIT_HEARTBEAT = 0x00,
-  INIT_PRODUCT,
-  INIT_CONF,
-  INIT_WIFI,
-  INIT_DATAPOINT,
-  INIT_DONE,
-};
-
-struct UyatCommand {
-  UyatCommandType cmd;
-  std::vector<uint8_t> payload;
-};
-
 template<typename... Ts> class FactoryResetAction;
 
-class Uyat : public Component, public uart::UARTDevice, public DatapointHandler {
+// The esphome component: runs the protocol core on the uart, with the esphome scheduler and clock,
+// and publishes its diagnostics to the sensors.
+class Uyat : public Component,
+             public uart::UARTDevice,
+             protected UyatTransport,
+             protected UyatClock,
+             protected UyatScheduler,
+             public UyatCore {
 #ifdef UYAT_DIAGNOSTICS_ENABLED
   SUB_TEXT_SENSOR(product)
   SUB_SENSOR(num_garbage_bytes)
@@ -96,131 +39,122 @@ class Uyat : public Component, public uart::UARTDevice, public DatapointHandler
   SUB_TEXT_SENSOR(unknown_extended_commands)
   SUB_TEXT_SENSOR(unhandled_datapoints)
   SUB_TEXT_SENSOR(pairing_mode)
+  SUB_SENSOR(frames_received)
+  SUB_SENSOR(frames_sent)
+  SUB_SENSOR(checksum_errors)
+  SUB_SENSOR(response_timeouts)
+  SUB_SENSOR(command_retries)
+  SUB_SENSOR(dropped_commands)
+  SUB_SENSOR(queue_high_water_mark)
+  SUB_SENSOR(rx_bytes_per_second)
+  SUB_SENSOR(tx_bytes_per_second)
+  SUB_SENSOR(rx_utilisation)
+  SUB_SENSOR(tx_utilisation)
+  SUB_SENSOR(datapoint_write_headroom)
+  SUB_TEXT_SENSOR(command_statistics)
+  SUB_TEXT_SENSOR(datapoint_statistics)
+#endif
+#ifdef UYAT_MEMORY_STATS_ENABLED
+  SUB_TEXT_SENSOR(memory_usage)
+  SUB_SENSOR(memory_used)
+  SUB_SENSOR(memory_peak)
+#endif
+#ifdef UYAT_LATENCY_ENABLED
+  SUB_SENSOR(rx_to_dispatch_latency_p50)
+  SUB_SENSOR(rx_to_dispatch_latency_p95)
+  SUB_SENSOR(rx_to_dispatch_latency_max)
+  SUB_SENSOR(set_to_tx_latency_p50)
+  SUB_SENSOR(set_to_tx_latency_p95)
+  SUB_SENSOR(set_to_tx_latency_max)
+  SUB_SENSOR(tx_to_report_latency_p50)
+  SUB_SENSOR(tx_to_report_latency_p95)
+  SUB_SENSOR(tx_to_report_latency_max)
+#endif
+#ifdef UYAT_PROFILER_ENABLED
+  SUB_TEXT_SENSOR(profiler_summary)
+  SUB_SENSOR(max_loop_time)
 #endif
  public:
+  Uyat() : UyatCore(*this, *this, *this) {}
+
   float get_setup_priority() const override { return setup_priority::DATA; }
   void setup() override;
   void loop() override;
   void dump_config() override;
-  void register_datapoint_listener(const uint8_t datapoint_id, const OnDatapointCallback &func);
-  void register_datapoint_listener(const uint8_t datapoint_id, const UyatDatapointType type, const OnDatapointCallback &func);
-  void register_datapoint_listener(const MatchingDatapoint& matching_dp, const OnDatapointCallback &func) override;
-  void set_datapoint_value(const UyatDatapoint& value, const bool forced = false) override;
   void set_status_pin(InternalGPIOPin *status_pin) { this->status_pin_ = status_pin; }
-  void send_generic_command(const UyatCommand &command) { send_command_(command); }
-  UyatInitState get_init_state();
-  void set_report_ap_name(const std::string& ap_name) { this->report_ap_name_ = ap_name; }
 
 #ifdef USE_TIME
   void set_time_id(time::RealTimeClock *time_id) { this->time_id_ = time_id; }
 #endif
-  void add_ignore_mcu_update_on_datapoints(uint8_t ignore_mcu_update_on_datapoints) {
-    this->ignore_mcu_update_on_datapoints_.push_back(ignore_mcu_update_on_datapoints);
-  }
+#ifdef UYAT_PROFILER_ENABLED
+  void set_profiler_window(uint32_t window_ms) { this->profiler_window_ms_ = window_ms; }
+#endif
+#ifdef UYAT_DIAGNOSTICS_ENABLED
+  void set_diagnostics_publish_interval(uint32_t interval_ms) { this->diag_publish_interval_ms_ = interval_ms; }
+#endif
   void add_on_initialized_callback(std::function<void()> callback) {
     this->initialized_callback_.add(std::move(callback));
   }
 
-  void trigger_factory_reset(const FactoryResetType reset_type);
-
-
-  void set_raw_datapoint_value(uint8_t datapoint_id, const std::vector<uint8_t> &value){
-    set_datapoint_value(UyatDatapoint{datapoint_id, RawDatapointValue{value}}, false);
-  }
-  void set_boolean_datapoint_value(uint8_t datapoint_id, bool value){
-    set_datapoint_value(UyatDatapoint{datapoint_id, BoolDatapointValue{value}}, false);
-  }
-  void set_integer_datapoint_value(uint8_t datapoint_id, uint32_t value){
-    set_datapoint_value(UyatDatapoint{datapoint_id, UIntDatapointValue{value}}, false);
-  }
-  void set_string_datapoint_value(uint8_t datapoint_id, const std::string &value){
-    set_datapoint_value(UyatDatapoint{datapoint_id, StringDatapointValue{value}}, false);
-  }
-  void set_enum_datapoint_value(uint8_t datapoint_id, uint8_t value){
-    set_datapoint_value(UyatDatapoint{datapoint_id, EnumDatapointValue{value}}, false);
-  }
-  void force_set_raw_datapoint_value(uint8_t datapoint_id, const std::vector<uint8_t> &value){
-    set_datapoint_value(UyatDatapoint{datapoint_id, RawDatapointValue{value}}, true);
-  }
-  void force_set_boolean_datapoint_value(uint8_t datapoint_id, bool value){
-    set_datapoint_value(UyatDatapoint{datapoint_id, BoolDatapointValue{value}}, true);
-  }
-  void force_set_integer_datapoint_value(uint8_t datapoint_id, uint32_t value){
-    set_datapoint_value(UyatDatapoint{datapoint_id, UIntDatapointValue{value}}, true);
-  }
-  void force_set_string_datapoint_value(uint8_t datapoint_id, const std::string &value){
-    set_datapoint_value(UyatDatapoint{datapoint_id, StringDatapointValue{value}}, true);
-  }
-  void force_set_enum_datapoint_value(uint8_t datapoint_id, uint8_t value){
-    set_datapoint_value(UyatDatapoint{datapoint_id, EnumDatapointValue{value}}, true);
-  }
-
  protected:
-  void handle_input_buffer_();
-  void handle_datapoints_(const std::deque<uint8_t> &buffer, size_t offset, size_t len);
-  optional<UyatDatapoint> get_datapoint_(uint8_t datapoint_id);
-  // returns number of bytes to remove from the beginning of rx buffer
-  std::size_t validate_message_();
-
-  void handle_command_(uint8_t command, uint8_t version, const std::deque<uint8_t> &buffer,
-                       size_t offset, size_t len);
-  void send_raw_command_(UyatCommand command);
-  void process_command_queue_();
-  void send_command_(const UyatCommand &command);
-  void send_empty_command_(UyatCommandType command);
-  void set_datapoint_value_(const UyatDatapoint& dp, const bool force = false);
-  void send_datapoint_command_(uint8_t datapoint_id, UyatDatapointType datapoint_type, std::vector<uint8_t> data);
+  // UyatTransport
+  std::size_t rx_available() override { return this->available(); }
+  bool rx_read(uint8_t &byte) override { return this->read_byte(&byte); }
+  void tx_write(const uint8_t *data, std::size_t len) override { this->write_array(data, len); }
+  // UyatClock
+  uint32_t get_millis() override { return millis(); }
+  uint32_t get_micros() override { return micros(); }
+  // UyatScheduler
+  void start_timer(const char *name, uint32_t delay_ms, bool repeat, TimerCallback &&callback) override;
+  void stop_timer(const char *name) override;
+
+  // UyatCore hooks
+  void on_initialized_() override;
+  void on_product_changed_() override;
+  void on_pairing_mode_changed_() override;
+  void on_status_pin_reported_(int pin) override;
+  bool is_network_connected_() override;
+  void get_mac_address_(uint8_t *mac) override;
+#ifdef USE_TIME
+  void on_local_time_query_() override;
+  void send_local_time_();
+#endif
+
   void set_status_pin_();
-  void send_wifi_status_(const uint8_t status);
-  uint8_t get_wifi_rssi_();
-  void report_wifi_connected_or_retry_(const uint32_t delay_ms);
-  void report_cloud_connected_();
-  void query_product_info_with_retries_();
-  std::string process_get_module_information_(const uint8_t *buffer, size_t len);
-  void schedule_heartbeat_(const bool initial);
-  void stop_heartbeats_();
 
 #ifdef UYAT_DIAGNOSTICS_ENABLED
   void update_pairing_mode_sensor_();
+  bool has_periodic_diag_sensors_() const;
+  void publish_periodic_diag_sensors_();
+  void publish_ids_(text_sensor::TextSensor *sensor, const std::vector<uint8_t> &ids);
+#endif
+#ifdef UYAT_PROFILER_ENABLED
+  void report_profiler_window_();
+#endif
+#ifdef UYAT_LATENCY_ENABLED
+  void publish_latency_sensors_();
+#endif
+#ifdef UYAT_MEMORY_STATS_ENABLED
+  void publish_memory_sensors_();
 #endif
 
-  std::string report_ap_name_ = "smartlife";
 #ifdef USE_TIME
-  void send_local_time_();
   time::RealTimeClock *time_id_{nullptr};
   bool time_sync_callback_registered_{false};
 #endif
-  UyatInitState init_state_ = UyatInitState::INIT_HEARTBEAT;
-  bool init_failed_{false};
-  bool heartbeats_enabled_{true};
-  int init_retries_{0};
-  uint8_t protocol_version_ = -1;
   InternalGPIOPin *status_pin_{nullptr};
-  int status_pin_reported_ = -1;
-  int reset_pin_reported_ = -1;
-  uint32_t last_command_timestamp_ = 0;
-  uint32_t last_rx_char_timestamp_ = 0;
-  std::string product_ = "";
-  std::vector<UyatDatapointListener> listeners_;
-  std::vector<UyatDatapoint> cached_datapoints_;
-  std::deque<uint8_t> rx_message_;
-  std::vector<uint8_t> ignore_mcu_update_on_datapoints_{};
-  std::vector<UyatCommand> command_queue_;
-  optional<UyatCommandType> expected_response_{};
-  UyatNetworkStatus wifi_status_{UyatNetworkStatus::WIFI_CONFIGURED};
-  optional<bool> requested_wifi_config_is_ap_{};
   CallbackManager<void()> initialized_callback_{};
 
 #ifdef UYAT_DIAGNOSTICS_ENABLED
-  uint64_t num_garbage_bytes_{0};
-  std::vector<uint8_t> unknown_commands_set_;
-  std::vector<uint8_t> unknown_extended_commands_set_;
-  std::vector<uint8_t> unhandled_datapoints_set_;
-#endif
- private:
-  inline uint8_t byte_at_(const std::deque<uint8_t> &buffer, size_t offset, size_t idx) const {
-    return buffer[offset + idx];
-  }
+  uint32_t diag_publish_interval_ms_{1000};
+  uint32_t published_total_frames_{0};
+#endif
+#ifdef UYAT_LATENCY_ENABLED
+  uint32_t published_latency_generation_{0};
+#endif
+#ifdef UYAT_PROFILER_ENABLED
+  uint32_t profiler_window_ms_{60000};
+#endif
 };
 
 template<typename... Ts> class FactoryResetAction : public Action<Ts...> {
@@ -236,4 +170,17 @@ template<typename... Ts> class FactoryResetAction : public Action<Ts...> {
   Uyat *uyat_;
 };
 
+template<typename... Ts> class DumpFrameTraceAction : public Action<Ts...> {
+ public:
+  DumpFrameTraceAction(Uyat *uyat) : uyat_(uyat) {}
+  TEMPLATABLE_VALUE(FrameTraceDumpFormat, format);
+
+  void play(const Ts &...x) override {
+    this->uyat_->dump_frame_trace(this->format_.value(x...));
+  }
+
+ protected:
+  Uyat *uyat_;
+};
+
 }  // namespace esphome::uyat
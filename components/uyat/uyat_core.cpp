@@ -0,0 +1,1181 @@
+#include "uyat_core.h"
+
+#include <cctype>
+
+#include "uyat_probes.h"
+
+namespace esphome::uyat {
+
+static const char *const TAG = "uyat";
+static const int COMMAND_DELAY = 10;
+static const int RECEIVE_TIMEOUT = 300;
+static const int MAX_RETRIES = 5;
+
+static const uint8_t FAKE_WIFI_RSSI = 100;
+static const uint64_t UART_MAX_POLL_TIME_MS = 50;
+
+#ifdef UYAT_DIAGNOSTICS_ENABLED
+static bool add_unique_to_vector(std::vector<uint8_t> &vec, const uint8_t value) {
+  if (std::find(vec.begin(), vec.end(), value) == vec.end()) {
+    vec.push_back(value);
+    return true;
+  }
+  return false;
+}
+
+static bool remove_from_vector(std::vector<uint8_t> &vec, const uint8_t value) {
+  auto it = std::find(vec.begin(), vec.end(), value);
+  if (it != vec.end()) {
+    vec.erase(it);
+    return true;
+  }
+  return false;
+}
+#endif
+
+#ifdef UYAT_MEMORY_STATS_ENABLED
+static std::size_t cached_datapoints_bytes(const std::vector<UyatDatapoint> &datapoints) {
+  std::size_t bytes = heap_bytes(datapoints);
+  for (const auto &datapoint : datapoints) {
+    if (const auto *raw = std::get_if<RawDatapointValue>(&datapoint.value)) {
+      bytes += heap_bytes(raw->value);
+    } else if (const auto *text = std::get_if<StringDatapointValue>(&datapoint.value)) {
+      bytes += heap_bytes(text->value);
+    }
+  }
+  return bytes;
+}
+
+static std::size_t command_queue_bytes(const std::vector<UyatCommand> &queue) {
+  std::size_t bytes = heap_bytes(queue);
+  for (const auto &command : queue) {
+    bytes += heap_bytes(command.payload);
+  }
+  return bytes;
+}
+#endif
+
+UyatCore::UyatCore(UyatTransport &transport, UyatClock &clock, UyatScheduler &scheduler)
+    : transport_(transport), clock_(clock), scheduler_(scheduler) {}
+
+void UyatCore::start() {
+  schedule_heartbeat_(true);
+}
+
+#ifdef UYAT_MEMORY_STATS_ENABLED
+void UyatCore::update_memory_stats_() {
+  using Account = UyatMemoryStats::Account;
+  this->memory_stats_.update(Account::LISTENERS,
+                             heap_bytes(this->listeners_) + heap_bytes(this->frame_end_listeners_));
+  this->memory_stats_.update(Account::CACHED_DATAPOINTS, cached_datapoints_bytes(this->cached_datapoints_));
+  this->memory_stats_.update(Account::RX_BUFFER, heap_bytes(this->rx_message_));
+  this->memory_stats_.update(Account::COMMAND_QUEUE, command_queue_bytes(this->command_queue_));
+
+#ifdef UYAT_DIAGNOSTICS_ENABLED
+  std::size_t diagnostics = heap_bytes(this->unknown_commands_set_) + heap_bytes(this->unknown_extended_commands_set_) +
+                            heap_bytes(this->unhandled_datapoints_set_) + heap_bytes(this->diag_text_buffer_) +
+                            heap_bytes(this->statistics_.get_command_counters()) + this->memory_stats_.heap_bytes();
+#else
+  std::size_t diagnostics = this->memory_stats_.heap_bytes();
+#endif
+#ifdef UYAT_DATAPOINT_STATS_ENABLED
+  diagnostics += this->datapoint_stats_.heap_bytes();
+#endif
+  this->memory_stats_.update(Account::DIAGNOSTICS, diagnostics);
+  this->memory_stats_.update_entities();
+}
+#endif
+
+void UyatCore::poll() {
+#ifdef UYAT_PROFILER_ENABLED
+  UyatProfiler::ScopedTimer loop_timer{this->profiler_, UyatProfiler::Phase::LOOP, this->profiler_clock_};
+#endif
+  const auto start_ts = this->clock_.get_millis();
+  uint64_t now = start_ts;
+  auto number_of_bytes = this->transport_.rx_available();
+#ifdef UYAT_PROFILER_ENABLED
+  const uint32_t drain_start = this->clock_.get_micros();
+#endif
+  while (number_of_bytes > 0)
+  {
+    uint8_t c;
+    if (!this->transport_.rx_read(c))
+    {
+      break;
+    }
+#ifdef UYAT_LATENCY_ENABLED
+    this->latency_.on_rx_byte(this->rx_message_.empty(), this->clock_.get_micros());
+#endif
+#ifdef UYAT_TRACE_EVENTS_ENABLED
+    this->trace_rx_last_us_ = this->clock_.get_micros();
+    if (this->rx_message_.empty()) {
+      this->trace_rx_frame_start_us_ = this->trace_rx_last_us_;
+    }
+#endif
+    this->rx_message_.push_back(c);
+    this->last_rx_char_timestamp_ = this->clock_.get_millis();
+#ifdef UYAT_DIAGNOSTICS_ENABLED
+    this->statistics_.on_bytes_received(1u);
+#endif
+    if (now >= (start_ts + UART_MAX_POLL_TIME_MS))
+    {
+      break;
+    }
+
+    --number_of_bytes;
+  }
+#ifdef UYAT_MEMORY_STATS_ENABLED
+  this->memory_stats_.update(UyatMemoryStats::Account::RX_BUFFER, heap_bytes(this->rx_message_));
+#endif
+#ifdef UYAT_PROFILER_ENABLED
+  this->profiler_.record(UyatProfiler::Phase::UART_DRAIN, this->clock_.get_micros() - drain_start);
+  {
+    UyatProfiler::ScopedTimer timer{this->profiler_, UyatProfiler::Phase::INPUT_BUFFER, this->profiler_clock_};
+    this->handle_input_buffer_();
+  }
+  {
+    UyatProfiler::ScopedTimer timer{this->profiler_, UyatProfiler::Phase::COMMAND_QUEUE, this->profiler_clock_};
+    process_command_queue_();
+  }
+#else
+  this->handle_input_buffer_();
+  process_command_queue_();
+#endif
+}
+
+void UyatCore::dump_core_config() {
+  if (this->init_state_ != UyatInitState::INIT_DONE) {
+    if (this->init_failed_) {
+      ESP_LOGCONFIG(TAG, "  Initialization failed. Current init_state: %u",
+                    static_cast<uint8_t>(this->init_state_));
+    } else {
+      ESP_LOGCONFIG(TAG,
+                    "  Configuration will be reported when setup is complete. "
+                    "Current init_state: %u",
+                    static_cast<uint8_t>(this->init_state_));
+    }
+    ESP_LOGCONFIG(TAG, "  If no further output is received, confirm that this "
+                       "is a supported Uyat device.");
+  }
+
+  ESP_LOGCONFIG(TAG, "  Listeners:");
+  for (const auto &dp : this->listeners_) {
+    ESP_LOGCONFIG(TAG, "    %s", dp.configured.to_string().c_str());
+  }
+
+  if (!this->datapoint_policies_.empty()) {
+    ESP_LOGCONFIG(TAG, "  Datapoint policies:");
+    this->datapoint_policies_.for_each([](const uint8_t number, const DatapointPolicy &policy) {
+      ESP_LOGCONFIG(TAG, "    Datapoint %u: %s", number, policy.to_string().c_str());
+    });
+  }
+
+#ifdef UYAT_DATAPOINT_STATS_ENABLED
+  if (!this->datapoint_stats_.empty()) {
+    const uint32_t now = this->clock_.get_millis();
+    ESP_LOGCONFIG(TAG, "  Datapoint statistics:");
+    this->datapoint_stats_.for_each([now](const DatapointStatistics::Entry &entry) {
+      ESP_LOGCONFIG(TAG, "    Datapoint %u: reports: %" PRIu32 " (%.1f/min), last seen %" PRIu32 "s ago, "
+                    "changes: %" PRIu32 ", repeats: %" PRIu32 ", bytes: %" PRIu32,
+                    entry.number, entry.reports, DatapointStatistics::reports_per_minute(entry, now),
+                    (now - entry.last_seen_ms) / 1000u, entry.changes, entry.repeats, entry.bytes);
+    });
+  }
+#endif
+
+#ifdef UYAT_MEMORY_STATS_ENABLED
+  this->update_memory_stats_();
+  ESP_LOGCONFIG(TAG, "  Memory usage (current/peak bytes), protocol core object: %zu bytes:", sizeof(*this));
+  for (uint8_t i = 0; i < static_cast<uint8_t>(UyatMemoryStats::Account::NUM_ACCOUNTS); ++i) {
+    const auto account = static_cast<UyatMemoryStats::Account>(i);
+    const auto &usage = this->memory_stats_.get(account);
+    ESP_LOGCONFIG(TAG, "    %s: %" PRIu32 "/%" PRIu32, UyatMemoryStats::account_name(account), usage.current, usage.peak);
+  }
+  ESP_LOGCONFIG(TAG, "    total: %" PRIu32 "/%" PRIu32, this->memory_stats_.get_total().current,
+                this->memory_stats_.get_total().peak);
+  this->memory_stats_.for_each_entity([](const UyatMemoryStats::Entity &entity) {
+    ESP_LOGCONFIG(TAG, "    %s, datapoint %u: %" PRIu32 "/%" PRIu32, entity.tag, entity.dp_number, entity.bytes.current,
+                  entity.bytes.peak);
+  });
+#endif
+
+#ifdef UYAT_LATENCY_ENABLED
+  ESP_LOGCONFIG(TAG, "  Latencies:");
+  for (uint8_t i = 0; i < static_cast<uint8_t>(UyatLatencyTracker::Interval::NUM_INTERVALS); ++i) {
+    const auto interval = static_cast<UyatLatencyTracker::Interval>(i);
+    ESP_LOGCONFIG(TAG, "    %s: %s", UyatLatencyTracker::interval_name(interval),
+                  UyatLatencyTracker::histogram_to_string(this->latency_.get(interval)).c_str());
+  }
+#endif
+
+  if (this->init_state_ > UyatInitState::INIT_CONF) {
+    if ((this->status_pin_reported_ != -1) || (this->reset_pin_reported_ != -1)) {
+      ESP_LOGCONFIG(TAG, "  GPIO Configuration: status: pin %d, reset: pin %d",
+                    this->status_pin_reported_, this->reset_pin_reported_);
+    }
+    ESP_LOGCONFIG(TAG, "  Product: '%s'", this->product_.c_str());
+  }
+}
+
+std::size_t UyatCore::validate_message_() {
+
+  const auto current_size = this->rx_message_.size();
+  if (current_size < (2u + 1u + 1u + 2u + 1u)) // header + version + command + length + checksum
+  {
+    return 0u;  // don't remove anything yet
+  }
+
+  if (this->rx_message_.at(0u) != 0x55)
+  {
+    return 1u;
+  }
+
+  if (this->rx_message_.at(1u) != 0xAA)
+  {
+    return 1u;  // remove just the first 0x55, in case it is followed by another 0x55
+  }
+
+  const uint8_t version = this->rx_message_.at(2u);
+  const uint8_t command = this->rx_message_.at(3u);
+  const uint16_t length = (uint16_t(this->rx_message_.at(4u)) << 8) | (uint16_t(this->rx_message_.at(5u)));
+  const auto checksum_offset = 6u + length;
+  if ((checksum_offset + 1u) > current_size)  // offset of data field + length + checksum
+  {
+    return 0u;
+  }
+
+  // Byte 6+LEN: CHECKSUM - sum of all bytes (including header) modulo 256
+  const uint8_t rx_checksum = this->rx_message_.at(checksum_offset);
+  uint8_t calc_checksum = 0;
+  for (std::size_t i = 0; i < checksum_offset; ++i)
+    calc_checksum += this->rx_message_.at(i);
+
+  if (rx_checksum != calc_checksum) {
+    ESP_LOGW(TAG, "Received invalid message checksum %02X!=%02X",
+             rx_checksum, calc_checksum);
+#ifdef UYAT_DIAGNOSTICS_ENABLED
+    this->statistics_.on_checksum_error();
+#endif
+    UYAT_PROBE(checksum_error, rx_checksum, calc_checksum);
+    return 1u;
+  }
+
+  // valid message
+  const size_t data_offset = 6u;
+  const size_t data_len = checksum_offset - data_offset;
+  ESP_LOGV(TAG, "Received Uyat: CMD=0x%02X VERSION=%u LEN=%zu INIT_STATE=%u",
+           command, version, data_len,
+           static_cast<uint8_t>(this->init_state_));
+  UYAT_PROBE(frame_received, command, checksum_offset + 1u);
+#ifdef UYAT_DIAGNOSTICS_ENABLED
+  this->statistics_.on_frame_received(command, checksum_offset + 1u);
+#endif
+#ifdef UYAT_FRAME_TRACE_ENABLED
+  this->frame_trace_.record(FrameDirection::RX, this->clock_.get_millis(), command, this->rx_message_, data_offset, data_len);
+#endif
+  {
+#ifdef UYAT_PROFILER_ENABLED
+    UyatProfiler::ScopedTimer timer{this->profiler_, UyatProfiler::Phase::COMMAND, this->profiler_clock_};
+#endif
+    this->handle_command_(command, version, this->rx_message_, data_offset, data_len);
+  }
+#ifdef UYAT_TRACE_EVENTS_ENABLED
+  if (this->trace_events_ != nullptr) {
+    this->trace_events_->on_rx_frame(command, checksum_offset + 1u, this->trace_rx_frame_start_us_,
+                                     this->clock_.get_micros());
+  }
+#endif
+
+  // the whole message can now be removed
+  return (checksum_offset + 1u);
+}
+
+void UyatCore::handle_input_buffer_() {
+  do
+  {
+    auto bytes_to_remove = this->validate_message_();
+    if (bytes_to_remove == 0)
+    {
+      break;
+    }
+    if (bytes_to_remove > this->rx_message_.size()) // just for safety, in case the validate_message_() is buggy
+    {
+      ESP_LOGW(TAG, "BUG: tryng to remove more bytes than possible %zu > %zu",
+        bytes_to_remove, this->rx_message_.size());
+      bytes_to_remove = this->rx_message_.size();
+    }
+
+#ifdef UYAT_DIAGNOSTICS_ENABLED
+    if (bytes_to_remove <= 1u)
+    {
+      this->num_garbage_bytes_ += bytes_to_remove;
+    }
+#endif
+    this->rx_message_.erase(this->rx_message_.begin(), this->rx_message_.begin() + bytes_to_remove);
+#ifdef UYAT_LATENCY_ENABLED
+    this->latency_.on_rx_consumed(!this->rx_message_.empty());
+#endif
+#ifdef UYAT_TRACE_EVENTS_ENABLED
+    // same estimate of the start of the next frame as UyatLatencyTracker::on_rx_consumed()
+    this->trace_rx_frame_start_us_ = this->trace_rx_last_us_;
+#endif
+  } while (!this->rx_message_.empty());  // the queued commands are sent only once the input is handled
+}
+
+void UyatCore::handle_command_(uint8_t command, uint8_t version,
+                           const std::deque<uint8_t> &buffer,
+                           size_t offset, size_t len) {
+  UyatCommandType command_type = (UyatCommandType)command;
+
+  if (this->expected_response_.has_value() &&
+      this->expected_response_ == command_type) {
+#ifdef UYAT_TRACE_EVENTS_ENABLED
+    this->trace_response_wait_(true);
+#endif
+    UYAT_PROBE(response_matched, command, this->clock_.get_millis() - this->last_command_timestamp_);
+    this->expected_response_.reset();
+    this->pop_command_();
+    this->init_retries_ = 0;
+  }
+
+  switch (command_type) {
+  case UyatCommandType::HEARTBEAT:
+    if (len == 0) {
+      ESP_LOGW(TAG, "MCU Heartbeat without payload");
+    } else {
+      ESP_LOGV(TAG, "MCU Heartbeat (0x%02X)", this->byte_at_(buffer, offset, 0));
+    }
+    this->protocol_version_ = version;
+    if ((len > 0) && (this->byte_at_(buffer, offset, 0) == 0)) {
+      ESP_LOGI(TAG, "MCU restarted");
+    }
+    schedule_heartbeat_(false);
+    if (this->init_state_ == UyatInitState::INIT_HEARTBEAT) {
+      this->init_state_ = UyatInitState::INIT_PRODUCT;
+      this->query_product_info_with_retries_();
+    }
+    break;
+  case UyatCommandType::PRODUCT_QUERY: {
+    // check it is a valid string made up of printable characters
+    bool valid = true;
+    for (size_t i = 0; i < len; i++) {
+      if (!std::isprint(this->byte_at_(buffer, offset, i))) {
+        valid = false;
+        break;
+      }
+    }
+    if (valid) {
+      this->product_ = std::string(buffer.begin() + offset, buffer.begin() + offset + len);
+    } else {
+      this->product_ = R"({"p":"INVALID"})";
+    }
+    this->on_product_changed_();
+
+    if (this->init_state_ == UyatInitState::INIT_PRODUCT) {
+      this->scheduler_.stop_timer("product");
+      this->init_state_ = UyatInitState::INIT_CONF;
+      this->send_empty_command_(UyatCommandType::CONF_QUERY);
+    }
+    break;
+  }
+  case UyatCommandType::CONF_QUERY: {
+    if (len >= 2) {
+      this->status_pin_reported_ = this->byte_at_(buffer, offset, 0);
+      this->reset_pin_reported_ = this->byte_at_(buffer, offset, 1);
+    }
+    if (this->init_state_ == UyatInitState::INIT_CONF) {
+      // If mcu returned status gpio, then we can omit sending wifi state
+      if (this->status_pin_reported_ != -1) {
+        this->wifi_status_ = UyatNetworkStatus::CLOUD_CONNECTED;
+        this->init_state_ = UyatInitState::INIT_DATAPOINT;
+        this->send_empty_command_(UyatCommandType::DATAPOINT_QUERY);
+        this->on_status_pin_reported_(this->status_pin_reported_);
+      } else {
+
+        this->init_state_ = UyatInitState::INIT_WIFI;
+        if (this->requested_wifi_config_is_ap_.has_value())
+        {
+          if (this->requested_wifi_config_is_ap_.value())
+          {
+            this->wifi_status_ = UyatNetworkStatus::AP_MODE;
+          }
+          else
+          {
+            this->wifi_status_ = UyatNetworkStatus::SMARTCONFIG;
+          }
+        }
+        else
+        {
+          this->wifi_status_ = UyatNetworkStatus::WIFI_CONFIGURED;
+        }
+        this->requested_wifi_config_is_ap_.reset();
+        this->on_pairing_mode_changed_();
+
+        this->send_wifi_status_(static_cast<uint8_t>(this->wifi_status_));
+        this->wifi_status_ = UyatNetworkStatus::WIFI_CONNECTED;
+        this->send_wifi_status_(static_cast<uint8_t>(this->wifi_status_));
+        this->wifi_status_ = UyatNetworkStatus::CLOUD_CONNECTED;
+        this->send_wifi_status_(static_cast<uint8_t>(this->wifi_status_));
+        this->init_state_ = UyatInitState::INIT_DATAPOINT;
+        this->send_empty_command_(UyatCommandType::DATAPOINT_QUERY);
+      }
+    }
+    break;
+  }
+  case UyatCommandType::WIFI_STATE:
+    if (this->init_state_ == UyatInitState::INIT_WIFI) {
+      if ((this->wifi_status_ == UyatNetworkStatus::SMARTCONFIG) || (this->wifi_status_ == UyatNetworkStatus::AP_MODE))
+      {
+        this->wifi_status_ = UyatNetworkStatus::WIFI_CONFIGURED;
+        this->send_wifi_status_(static_cast<uint8_t>(this->wifi_status_));
+      }
+
+      if (this->wifi_status_ == UyatNetworkStatus::WIFI_CONFIGURED)
+      {
+        this->report_wifi_connected_or_retry_(100u);
+      }
+      else if (this->wifi_status_ == UyatNetworkStatus::WIFI_CONNECTED)
+      {
+        this->wifi_status_ = UyatNetworkStatus::CLOUD_CONNECTED;
+        this->send_wifi_status_(static_cast<uint8_t>(this->wifi_status_));
+      }
+      else if (this->wifi_status_ == UyatNetworkStatus::CLOUD_CONNECTED)
+      {
+        this->init_state_ = UyatInitState::INIT_DATAPOINT;
+        this->send_empty_command_(UyatCommandType::DATAPOINT_QUERY);
+      }
+    }
+    break;
+  case UyatCommandType::WIFI_RESET:
+  {
+    ESP_LOGI(TAG, "WIFI_RESET");
+    this->init_state_ = UyatInitState::INIT_PRODUCT;
+    this->send_empty_command_(UyatCommandType::WIFI_RESET);
+    this->schedule_heartbeat_(true);
+    this->query_product_info_with_retries_();
+    break;
+  }
+  case UyatCommandType::WIFI_SELECT: {
+      ESP_LOGI(TAG, "WIFI_SELECT");
+      if (len > 0)
+      {
+        this->requested_wifi_config_is_ap_ = (this->byte_at_(buffer, offset, 0) == 0x01);
+      }
+      else
+      {
+        this->requested_wifi_config_is_ap_ = 0x00;  // SMARTCONFIG
+      }
+
+      this->on_pairing_mode_changed_();
+
+      this->init_state_ = UyatInitState::INIT_PRODUCT;
+      this->send_empty_command_(UyatCommandType::WIFI_SELECT);
+      this->schedule_heartbeat_(true);
+      this->query_product_info_with_retries_();
+      break;
+    }
+  case UyatCommandType::DATAPOINT_DELIVER:
+    break;
+  case UyatCommandType::DATAPOINT_REPORT_ASYNC:
+  case UyatCommandType::DATAPOINT_REPORT_SYNC:
+    if (this->init_state_ == UyatInitState::INIT_DATAPOINT) {
+      this->init_state_ = UyatInitState::INIT_DONE;
+      this->on_initialized_();
+    }
+    this->handle_datapoints_frame_(buffer, offset, len);
+
+    if (command_type == UyatCommandType::DATAPOINT_REPORT_SYNC) {
+      this->send_command_(
+          UyatCommand{.cmd = UyatCommandType::DATAPOINT_REPORT_ACK,
+                      .payload = std::vector<uint8_t>{0x01}});
+    }
+    break;
+  case UyatCommandType::DATAPOINT_QUERY:
+    break;
+  case UyatCommandType::WIFI_TEST:
+    this->send_command_(
+        UyatCommand{.cmd = UyatCommandType::WIFI_TEST,
+                    .payload = std::vector<uint8_t>{0x00, 0x00}});
+    break;
+  case UyatCommandType::WIFI_RSSI:
+    this->send_command_(
+        UyatCommand{.cmd = UyatCommandType::WIFI_RSSI,
+                    .payload = std::vector<uint8_t>{get_wifi_rssi_()}});
+    break;
+  case UyatCommandType::DISABLE_HEARTBEATS:
+    stop_heartbeats_();
+    ESP_LOGI(TAG, "Heartbeats disabled by MCU");
+    break;
+  case UyatCommandType::LOCAL_TIME_QUERY:
+    this->on_local_time_query_();
+    break;
+  // case UyatCommandType::VACUUM_MAP_UPLOAD:
+  //   this->send_command_(UyatCommand{.cmd = UyatCommandType::VACUUM_MAP_UPLOAD,
+  //                                   .payload = std::vector<uint8_t>{0x01}});
+  //   ESP_LOGW(TAG,
+  //            "Vacuum map upload requested, responding that it is not enabled.");
+  //   break;
+  case UyatCommandType::GET_NETWORK_STATUS: {
+    this->send_command_(
+        UyatCommand{.cmd = UyatCommandType::GET_NETWORK_STATUS,
+                    .payload = std::vector<uint8_t>{this->wifi_status_}});
+    ESP_LOGV(TAG, "Network status requested, reported as %i", this->wifi_status_);
+    break;
+  }
+  case UyatCommandType::GET_MAC_ADDRESS: {
+    std::vector<uint8_t> mac(6u);
+    this->get_mac_address_(mac.data());
+    this->send_command_(
+        UyatCommand{.cmd = UyatCommandType::GET_MAC_ADDRESS,
+                    .payload = mac});
+    ESP_LOGV(TAG, "MAC address requested, reported as %s",
+              format_hex_pretty(mac).c_str());
+    break;
+  }
+  case UyatCommandType::EXTENDED_SERVICES: {
+    if (len == 0) {
+      ESP_LOGW(TAG, "EXTENDED_SERVICES without subcommand");
+      break;
+    }
+    uint8_t subcommand = this->byte_at_(buffer, offset, 0);
+    switch ((UyatExtendedServicesCommandType)subcommand) {
+    case UyatExtendedServicesCommandType::RESET_NOTIFICATION: {
+      this->send_command_(UyatCommand{
+          .cmd = UyatCommandType::EXTENDED_SERVICES,
+          .payload = std::vector<uint8_t>{
+              static_cast<uint8_t>(
+                  UyatExtendedServicesCommandType::RESET_NOTIFICATION),
+              0x00}});
+      ESP_LOGV(TAG, "Reset status notification enabled");
+      break;
+    }
+    case UyatExtendedServicesCommandType::FACTORY_RESET: {
+      ESP_LOGD(TAG, "Factory reset acked by MCU");
+      break;
+    }
+    case UyatExtendedServicesCommandType::UPDATE_IN_PROGRESS: {
+      ESP_LOGE(TAG, "EXTENDED_SERVICES::UPDATE_IN_PROGRESS is not handled");
+      break;
+    }
+    case UyatExtendedServicesCommandType::GET_MODULE_INFORMATION: {
+      std::vector<uint8_t> response_payload;
+      std::string module_info_str;
+      response_payload.push_back(static_cast<uint8_t>(
+                  UyatExtendedServicesCommandType::GET_MODULE_INFORMATION));
+      if (len >= 2)
+      {
+        // the requested fields follow the subcommand, the deque isn't contiguous
+        const std::vector<uint8_t> fields(buffer.begin() + offset + 1, buffer.begin() + offset + len);
+        module_info_str = process_get_module_information_(fields.data(), fields.size());
+      }
+
+      if (module_info_str.empty())
+      {
+        response_payload.push_back(0x01);  // failure
+      }
+      else
+      {
+        response_payload.push_back(0x00);  // success
+        response_payload.insert(response_payload.end(),
+                                module_info_str.begin(),
+                                module_info_str.end());
+      }
+
+      send_raw_command_(UyatCommand{
+          .cmd = UyatCommandType::EXTENDED_SERVICES,
+          .payload = response_payload});
+      break;
+    }
+    default:
+#ifdef UYAT_DIAGNOSTICS_ENABLED
+      if (add_unique_to_vector(this->unknown_extended_commands_set_, subcommand)) {
+        this->diag_dirty_ |= DIAG_DIRTY_UNKNOWN_EXTENDED_COMMANDS;
+      }
+#endif
+      ESP_LOGE(TAG, "Invalid extended services subcommand (0x%02X) received",
+               subcommand);
+    }
+    break;
+  }
+  default:
+#ifdef UYAT_DIAGNOSTICS_ENABLED
+    if (add_unique_to_vector(this->unknown_commands_set_, command)) {
+      this->diag_dirty_ |= DIAG_DIRTY_UNKNOWN_COMMANDS;
+    }
+#endif
+    ESP_LOGE(TAG, "Invalid command (0x%02X) received", command);
+  }
+}
+
+void UyatCore::handle_datapoints_frame_(const std::deque<uint8_t> &buffer, size_t offset, size_t len) {
+  this->processing_frame_ = true;
+  this->handle_datapoints_(buffer, offset, len);
+  this->processing_frame_ = false;
+
+  for (auto &listener : this->frame_end_listeners_) {
+    listener();
+  }
+#ifdef UYAT_LATENCY_ENABLED
+  this->latency_.on_datapoints_dispatched(this->clock_.get_micros());
+#endif
+#ifdef UYAT_MEMORY_STATS_ENABLED
+  this->memory_stats_.update(UyatMemoryStats::Account::CACHED_DATAPOINTS,
+                             cached_datapoints_bytes(this->cached_datapoints_));
+#endif
+}
+
+void UyatCore::handle_datapoints_(const std::deque<uint8_t> &buffer, size_t offset, size_t len) {
+  while (len >= 4) {
+    std::size_t used_len = 0u;
+    auto datapoint = UyatDatapoint::construct(buffer, offset, len, used_len);
+    if (used_len == 0u)
+    {
+      used_len = len;
+    }
+
+#ifdef UYAT_DATAPOINT_STATS_ENABLED
+    if (datapoint)
+    {
+      this->datapoint_stats_.on_report(buffer, offset, used_len, this->clock_.get_millis());
+#ifdef UYAT_DIAGNOSTICS_ENABLED
+      this->diag_dirty_ |= DIAG_DIRTY_DATAPOINT_STATS;
+#endif
+    }
+#endif
+
+    len -= used_len;
+    offset += used_len;
+
+    if (datapoint)
+    {
+      if (log_enabled(ESPHOME_LOG_LEVEL_DEBUG, TAG)) {
+        ESP_LOGD(TAG, "MCU reported %s", DatapointText(datapoint.value()).c_str());
+      }
+#ifdef UYAT_LATENCY_ENABLED
+      this->latency_.on_datapoint_reported(datapoint->number, this->clock_.get_micros());
+#endif
+      const auto num_deferred = this->datapoint_policies_.num_pending();
+      const auto verdict = this->datapoint_policies_.check(datapoint.value(), this->clock_.get_millis());
+      if (verdict == DatapointPolicyVerdict::IGNORE)
+      {
+          ESP_LOGV(TAG,
+                  "Datapoint %u is ignored by its policy, "
+                  "dropping MCU update",
+                  datapoint->number);
+      }
+      else
+      {
+        // Update internal datapoints
+        bool found = false;
+        for (auto &other : this->cached_datapoints_) {
+          if (other.matches(datapoint.value())) {
+            other = datapoint.value();
+            found = true;
+          }
+        }
+        if (!found) {
+          this->cached_datapoints_.push_back(datapoint.value());
+        }
+
+        if (verdict == DatapointPolicyVerdict::SUPPRESS)
+        {
+          ESP_LOGV(TAG, "Datapoint %u suppressed by its policy", datapoint->number);
+          continue;
+        }
+        if (verdict == DatapointPolicyVerdict::DEFER)
+        {
+          ESP_LOGV(TAG, "Datapoint %u deferred by its policy", datapoint->number);
+          // a datapoint newly deferred may be due before the ones already waiting
+          if (this->datapoint_policies_.num_pending() > num_deferred) {
+            this->schedule_deferred_datapoints_();
+          }
+          continue;
+        }
+
+        this->dispatch_datapoint_(datapoint.value());
+      }
+    }
+  }
+}
+
+void UyatCore::dispatch_datapoint_(const UyatDatapoint &datapoint) {
+  // Run through listeners, the wire type is resolved only once per datapoint
+  const auto dp_type = datapoint.get_type();
+  bool handled = false;
+  for (auto &listener : this->listeners_) {
+    if ((listener.configured.number == datapoint.number) && listener.configured.matches(dp_type))
+    {
+#ifdef UYAT_TRACE_EVENTS_ENABLED
+      const auto dispatch_start = this->clock_.get_micros();
+#endif
+#ifdef UYAT_PROFILER_ENABLED
+      const auto listener_start = this->clock_.get_micros();
+      listener.on_datapoint(datapoint);
+      const uint32_t listener_time = this->clock_.get_micros() - listener_start;
+      if (this->profiler_.record_listener(datapoint.number, listener_time)) {
+        ESP_LOGW(TAG, "Listener of datapoint %u took %uus (threshold %uus)", datapoint.number, listener_time,
+                 this->profiler_.get_slow_listener_threshold_us());
+      }
+#else
+      listener.on_datapoint(datapoint);
+#endif
+#ifdef UYAT_TRACE_EVENTS_ENABLED
+      if (this->trace_events_ != nullptr) {
+        this->trace_events_->on_dispatch(datapoint.number, static_cast<std::size_t>(&listener - this->listeners_.data()),
+                                         dispatch_start, this->clock_.get_micros());
+      }
+#endif
+      handled = true;
+    }
+  }
+  UYAT_PROBE(datapoint_dispatched, datapoint.number, static_cast<uint8_t>(dp_type), handled);
+
+#ifdef UYAT_DIAGNOSTICS_ENABLED
+  const bool changed = handled? remove_from_vector(this->unhandled_datapoints_set_, datapoint.number) :
+                                 add_unique_to_vector(this->unhandled_datapoints_set_, datapoint.number);
+  if (changed)
+  {
+    this->diag_dirty_ |= DIAG_DIRTY_UNHANDLED_DATAPOINTS;
+  }
+#else
+  (void) handled;
+#endif
+}
+
+void UyatCore::schedule_deferred_datapoints_() {
+  const auto next_in_ms = this->datapoint_policies_.next_pending_in_ms(this->clock_.get_millis());
+  if (next_in_ms.has_value()) {
+    this->scheduler_.start_timer("deferred_datapoints", next_in_ms.value(), false, [this] {
+      this->dispatch_deferred_datapoints_();
+    });
+  }
+}
+
+void UyatCore::dispatch_deferred_datapoints_() {
+  std::vector<UyatDatapoint> due;
+  this->datapoint_policies_.take_due(this->clock_.get_millis(), due);
+  if (!due.empty()) {
+    // delivered like the datapoints of a frame, so that the components batching them see its end
+    this->processing_frame_ = true;
+    for (const auto &datapoint : due) {
+      ESP_LOGV(TAG, "Dispatching deferred datapoint %u", datapoint.number);
+      this->dispatch_datapoint_(datapoint);
+    }
+    this->processing_frame_ = false;
+
+    for (auto &listener : this->frame_end_listeners_) {
+      listener();
+    }
+  }
+  this->schedule_deferred_datapoints_();
+}
+
+void UyatCore::send_raw_command_(UyatCommand command) {
+  uint8_t len_hi = (uint8_t)(command.payload.size() >> 8);
+  uint8_t len_lo = (uint8_t)(command.payload.size() & 0xFF);
+  uint8_t version = 0;
+
+#ifdef UYAT_TRACE_EVENTS_ENABLED
+  const auto tx_start = this->clock_.get_micros();
+#endif
+  this->last_command_timestamp_ = this->clock_.get_millis();
+  switch (command.cmd) {
+  case UyatCommandType::HEARTBEAT:
+    this->expected_response_ = UyatCommandType::HEARTBEAT;
+    break;
+  case UyatCommandType::PRODUCT_QUERY:
+    this->expected_response_ = UyatCommandType::PRODUCT_QUERY;
+    break;
+  case UyatCommandType::CONF_QUERY:
+    this->expected_response_ = UyatCommandType::CONF_QUERY;
+    break;
+  case UyatCommandType::DATAPOINT_DELIVER:
+  case UyatCommandType::DATAPOINT_QUERY:
+    this->expected_response_ = UyatCommandType::DATAPOINT_REPORT_ASYNC;
+    break;
+  default:
+    break;
+  }
+
+  ESP_LOGV(TAG, "Sending Uyat: CMD=0x%02X VERSION=%u DATA=[%s] INIT_STATE=%u",
+           static_cast<uint8_t>(command.cmd), version,
+           format_hex_pretty(command.payload).c_str(),
+           static_cast<uint8_t>(this->init_state_));
+
+  const uint8_t header[] = {0x55, 0xAA, version, (uint8_t)command.cmd, len_hi, len_lo};
+  this->transport_.tx_write(header, sizeof(header));
+  if (!command.payload.empty())
+    this->transport_.tx_write(command.payload.data(), command.payload.size());
+
+  uint8_t checksum = 0x55 + 0xAA + (uint8_t)command.cmd + len_hi + len_lo;
+  for (auto &data : command.payload)
+    checksum += data;
+  this->transport_.tx_write(&checksum, 1u);
+  UYAT_PROBE(command_sent, static_cast<uint8_t>(command.cmd), 7u + command.payload.size());
+#ifdef UYAT_TRACE_EVENTS_ENABLED
+  if (this->trace_events_ != nullptr) {
+    const auto tx_end = this->clock_.get_micros();
+    this->trace_events_->on_tx_frame(static_cast<uint8_t>(command.cmd), 7u + command.payload.size(), tx_start, tx_end);
+    this->trace_wait_command_ = static_cast<uint8_t>(command.cmd);
+    this->trace_wait_start_us_ = tx_end;
+  }
+#endif
+#ifdef UYAT_DIAGNOSTICS_ENABLED
+  this->statistics_.on_frame_sent(static_cast<uint8_t>(command.cmd), 7u + command.payload.size());
+#endif
+#ifdef UYAT_FRAME_TRACE_ENABLED
+  this->frame_trace_.record(FrameDirection::TX, this->last_command_timestamp_, static_cast<uint8_t>(command.cmd),
+                            command.payload, 0u, command.payload.size());
+#endif
+#ifdef UYAT_LATENCY_ENABLED
+  if ((command.cmd == UyatCommandType::DATAPOINT_DELIVER) && !command.payload.empty()) {
+    this->latency_.on_datapoint_written(command.payload[0], command.enqueued_us, this->clock_.get_micros());
+  }
+#endif
+}
+
+#ifdef UYAT_TRACE_EVENTS_ENABLED
+void UyatCore::trace_response_wait_(const bool answered) {
+  if (this->trace_events_ != nullptr) {
+    this->trace_events_->on_response_wait(this->trace_wait_command_, this->trace_wait_start_us_,
+                                          this->clock_.get_micros(), answered);
+  }
+}
+#endif
+
+void UyatCore::process_command_queue_() {
+  uint32_t now = this->clock_.get_millis();
+  uint32_t delay = now - this->last_command_timestamp_;
+
+  if (now - this->last_rx_char_timestamp_ > RECEIVE_TIMEOUT) {
+    this->rx_message_.clear();
+  }
+
+  if (this->expected_response_.has_value() && delay > RECEIVE_TIMEOUT) {
+#ifdef UYAT_TRACE_EVENTS_ENABLED
+    this->trace_response_wait_(false);
+#endif
+    [[maybe_unused]] const auto expected_response = static_cast<uint8_t>(this->expected_response_.value());
+    this->expected_response_.reset();
+    bool retried = false;
+    if (init_state_ != UyatInitState::INIT_DONE) {
+      if (++this->init_retries_ >= MAX_RETRIES) {
+        this->init_failed_ = true;
+        ESP_LOGE(TAG, "Initialization failed at init_state %u",
+                 static_cast<uint8_t>(this->init_state_));
+        this->pop_command_();
+        this->init_retries_ = 0;
+      } else {
+        retried = true;
+      }
+    } else {
+      this->pop_command_();
+    }
+    UYAT_PROBE(response_timeout, expected_response, retried);
+#ifdef UYAT_DIAGNOSTICS_ENABLED
+    this->statistics_.on_response_timeout(retried);
+#else
+    (void) retried;
+#endif
+  }
+
+  // Left check of delay since last command in case there's ever a command sent
+  // by calling send_raw_command_ directly
+  if (delay > COMMAND_DELAY && !this->command_queue_.empty() &&
+      this->rx_message_.empty() && !this->expected_response_.has_value()) {
+    this->send_raw_command_(command_queue_.front());
+    if (!this->expected_response_.has_value())
+      this->pop_command_();
+  }
+}
+
+void UyatCore::pop_command_() {
+  UYAT_PROBE(queue_dequeue, static_cast<uint8_t>(this->command_queue_.front().cmd), this->command_queue_.size() - 1u);
+  this->command_queue_.erase(command_queue_.begin());
+}
+
+void UyatCore::send_command_(const UyatCommand &command) {
+  command_queue_.push_back(command);
+  UYAT_PROBE(queue_enqueue, static_cast<uint8_t>(command.cmd), this->command_queue_.size());
+#ifdef UYAT_DIAGNOSTICS_ENABLED
+  this->statistics_.on_queue_depth(this->command_queue_.size());
+#endif
+#ifdef UYAT_MEMORY_STATS_ENABLED
+  this->memory_stats_.update(UyatMemoryStats::Account::COMMAND_QUEUE, command_queue_bytes(this->command_queue_));
+#endif
+  process_command_queue_();
+}
+
+void UyatCore::send_empty_command_(UyatCommandType command) {
+  send_command_(UyatCommand{.cmd = command, .payload = std::vector<uint8_t>{}});
+}
+
+uint8_t UyatCore::get_wifi_rssi_() { return FAKE_WIFI_RSSI; }
+
+void UyatCore::send_wifi_status_(const uint8_t status) {
+  ESP_LOGD(TAG, "Sending WiFi Status %d", status);
+  this->send_command_(UyatCommand{.cmd = UyatCommandType::WIFI_STATE,
+                                  .payload = std::vector<uint8_t>{status}});
+}
+
+void UyatCore::set_datapoint_value(const UyatDatapoint& dp, const bool forced ) {
+  if (log_enabled(ESPHOME_LOG_LEVEL_DEBUG, TAG)) {
+    ESP_LOGD(TAG, "Setting %s", DatapointText(dp).c_str());
+  }
+  auto configured_datapoint = this->get_datapoint_(dp.number);
+  if (configured_datapoint.has_value()) {
+    if (configured_datapoint->get_type() != dp.get_type())
+    {
+      ESP_LOGE(TAG, "Datapoint %u previously seen as %s setting as %s",
+              dp.number, configured_datapoint->get_type_name(), dp.get_type_name());
+    }
+    if (!forced && dp.value == configured_datapoint->value) {
+      ESP_LOGV(TAG, "Not sending unchanged value");
+      return;
+    }
+  }
+
+  this->send_datapoint_command_(dp.number, dp.get_type(), dp.value_to_payload());
+}
+
+std::optional<UyatDatapoint> UyatCore::get_datapoint_(uint8_t datapoint_id) {
+  for (auto &datapoint : this->cached_datapoints_) {
+    if (datapoint.number == datapoint_id)
+      return datapoint;
+  }
+  return {};
+}
+
+void UyatCore::send_datapoint_command_(uint8_t datapoint_id,
+                                   UyatDatapointType datapoint_type,
+                                   std::vector<uint8_t> data) {
+  std::vector<uint8_t> buffer;
+  buffer.push_back(datapoint_id);
+  buffer.push_back(static_cast<uint8_t>(datapoint_type));
+  buffer.push_back(data.size() >> 8);
+  buffer.push_back(data.size() >> 0);
+  buffer.insert(buffer.end(), data.begin(), data.end());
+
+  UyatCommand command{.cmd = UyatCommandType::DATAPOINT_DELIVER, .payload = buffer};
+#ifdef UYAT_LATENCY_ENABLED
+  command.enqueued_us = this->clock_.get_micros();
+#endif
+  this->send_command_(command);
+}
+
+void UyatCore::add_datapoint_policy(uint8_t datapoint_id, const DatapointPolicy &policy) {
+  if (!this->datapoint_policies_.set_policy(datapoint_id, policy)) {
+    ESP_LOGE(TAG, "Too many datapoint policies, dropping the one for datapoint %u", datapoint_id);
+  }
+}
+
+void UyatCore::register_datapoint_listener(const uint8_t datapoint_id,
+                             const OnDatapointCallback &func) {
+  register_datapoint_listener(MatchingDatapoint{.number = datapoint_id, .types = {}}, func);
+}
+
+void UyatCore::register_datapoint_listener(const uint8_t datapoint_id,
+                             const UyatDatapointType type,
+                             const OnDatapointCallback &func) {
+  register_datapoint_listener(MatchingDatapoint{.number = datapoint_id, .types = {type}}, func);
+}
+
+void UyatCore::register_datapoint_listener(const MatchingDatapoint& matching_dp,
+                             const OnDatapointCallback &func) {
+  auto listener = UyatDatapointListener{
+      .configured = matching_dp,
+      .on_datapoint = func,
+  };
+  this->listeners_.push_back(listener);
+
+  // Run through existing datapoints
+  for (auto &datapoint : this->cached_datapoints_) {
+    if (datapoint.matches(listener.configured))
+    {
+      listener.on_datapoint(datapoint);
+#ifdef UYAT_DIAGNOSTICS_ENABLED
+      if (remove_from_vector(this->unhandled_datapoints_set_, datapoint.number)) {
+        this->diag_dirty_ |= DIAG_DIRTY_UNHANDLED_DATAPOINTS;
+      }
+#endif
+    }
+  }
+}
+
+UyatInitState UyatCore::get_init_state() { return this->init_state_; }
+
+void UyatCore::dump_frame_trace(const FrameTraceDumpFormat format) {
+#ifdef UYAT_FRAME_TRACE_ENABLED
+  ESP_LOGI(TAG, "Frame trace: %zu of %u frames recorded so far", this->frame_trace_.size(),
+           this->frame_trace_.get_total_recorded());
+  if (format == FrameTraceDumpFormat::TEXT) {
+    this->frame_trace_.for_each([](const FrameTrace::Entry &entry) {
+      ESP_LOGI(TAG, "  %s", FrameTrace::entry_to_string(entry).c_str());
+    });
+  } else {
+    static const size_t BYTES_PER_LINE = 32;
+    const auto encoded = this->frame_trace_.encode();
+    for (size_t offset = 0; offset < encoded.size(); offset += BYTES_PER_LINE) {
+      const auto line_len = std::min(BYTES_PER_LINE, encoded.size() - offset);
+      ESP_LOGI(TAG, "trace: %s", format_hex(encoded.data() + offset, line_len).c_str());
+    }
+  }
+#else
+  (void) format;
+  ESP_LOGW(TAG, "Frame trace is not enabled, add frame_trace: to the uyat config");
+#endif
+}
+
+void UyatCore::report_wifi_connected_or_retry_(const uint32_t delay_ms)
+{
+  if (this->is_network_connected_())
+  {
+    this->wifi_status_ = UyatNetworkStatus::WIFI_CONNECTED;
+    this->send_wifi_status_(static_cast<uint8_t>(this->wifi_status_));
+    this->scheduler_.start_timer("wifi_status", 100, false, [this] {
+      this->report_cloud_connected_();
+    });
+  }
+  else
+  {
+    ESP_LOGI(TAG, "WiFi not connected yet, will retry...");
+    this->scheduler_.start_timer("wifi_status", delay_ms, false, [this, delay_ms] {
+      this->report_wifi_connected_or_retry_(delay_ms);
+    });
+  }
+}
+
+void UyatCore::report_cloud_connected_()
+{
+  if (this->init_state_ != UyatInitState::INIT_WIFI)
+  {
+    return;
+  }
+  this->wifi_status_ = UyatNetworkStatus::CLOUD_CONNECTED;
+  this->send_wifi_status_(static_cast<uint8_t>(this->wifi_status_));
+}
+
+void UyatCore::query_product_info_with_retries_()
+{
+  this->scheduler_.stop_timer("wifi_status");
+  this->scheduler_.stop_timer("product");
+  if (this->init_state_ != UyatInitState::INIT_PRODUCT)
+  {
+    return;
+  }
+
+  this->send_empty_command_(UyatCommandType::PRODUCT_QUERY);
+  this->scheduler_.start_timer("product", 2000, false, [this] {
+      ESP_LOGW(TAG, "No response to PRODUCT_QUERY, retrying...");
+      this->query_product_info_with_retries_();
+    });
+}
+
+std::string UyatCore::process_get_module_information_(const uint8_t *buffer, size_t len)
+{
+  // By default, we return an empty string indicating failure
+  bool want_ssid = false;
+  bool want_country_code = false;
+  bool want_sn = false;
+
+  if (len == 0)
+  {
+    return {};
+  }
+
+  if (buffer[0] == 0xFF) // special case: get all information
+  {
+    want_ssid = true;
+    want_country_code = true;
+    want_sn = true;
+  }
+  else
+  {
+    for (size_t i = 0; i < len; i++)
+    {
+      switch (buffer[i])
+      {
+        case 0x01:
+          want_ssid = true;
+          break;
+        case 0x02:
+          want_country_code = true;
+          break;
+        case 0x03:
+          want_sn = true;
+          break;
+        default:
+          ESP_LOGW(TAG, "Unknown GET_MODULE_INFORMATION request field 0x%02X",
+                   buffer[i]);
+      }
+    }
+  }
+
+  if (!want_ssid && !want_country_code && !want_sn)
+  {
+    return {};
+  }
+
+  std::string module_info_str = "{";
+
+  if (want_ssid)
+  {
+    module_info_str += "\"ap\":\"" + report_ap_name_ + "\"";
+  }
+  if (want_country_code)
+  {
+    if (module_info_str.length() > 1)
+    {
+      module_info_str.push_back(',');
+    }
+    module_info_str += "\"cc\":\"0\"";  // 0 means China
+  }
+  if (want_sn)
+  {
+    if (module_info_str.length() > 1)
+    {
+      module_info_str.push_back(',');
+    }
+    module_info_str += "\"sn\":\"1234567890\"";
+  }
+
+  module_info_str.push_back('}');
+
+  return module_info_str;
+}
+
+void UyatCore::schedule_heartbeat_(const bool initial)
+{
+  const uint32_t delay_ms = initial ? 1000u : 15000u;
+  this->scheduler_.stop_timer("heartbeat");
+  this->heartbeats_enabled_ = true;
+  this->scheduler_.start_timer("heartbeat", delay_ms, true, [this] {
+    if (this->heartbeats_enabled_)
+    {
+      this->send_empty_command_(UyatCommandType::HEARTBEAT);
+    }
+  });
+}
+
+void UyatCore::stop_heartbeats_()
+{
+  this->scheduler_.stop_timer("heartbeat");
+  this->heartbeats_enabled_ = false;
+}
+
+void UyatCore::on_local_time_query_()
+{
+  ESP_LOGW(TAG, "LOCAL_TIME_QUERY is not handled because time is not configured");
+}
+
+void UyatCore::trigger_factory_reset(const FactoryResetType reset_type)
+{
+  send_raw_command_(UyatCommand{
+      .cmd = UyatCommandType::EXTENDED_SERVICES,
+      .payload = std::vector<uint8_t>{
+          static_cast<uint8_t>(UyatExtendedServicesCommandType::FACTORY_RESET),
+          reset_type
+          }});
+}
+
+} // namespace esphome::uyat
@@ -0,0 +1,347 @@
+#pragma once
+
+#include <algorithm>
+#include <cinttypes>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "uyat_platform.h"
+#include "uyat_datapoint_types.h"
+#include "uyat_log.h"
+#include "uyat_datapoint_policy.h"
+#include "uyat_statistics.h"
+#ifdef UYAT_PROFILER_ENABLED
+#include "uyat_profiler.h"
+#endif
+#ifdef UYAT_FRAME_TRACE_ENABLED
+#include "uyat_frame_trace.h"
+#endif
+#ifdef UYAT_DATAPOINT_STATS_ENABLED
+#include "uyat_datapoint_stats.h"
+#endif
+#ifdef UYAT_LATENCY_ENABLED
+#include "uyat_latency.h"
+#endif
+#ifdef UYAT_MEMORY_STATS_ENABLED
+#include "uyat_memory.h"
+#endif
+#ifdef UYAT_TRACE_EVENTS_ENABLED
+#include "uyat_trace_events.h"
+#endif
+
+namespace esphome::uyat
+{
+
+enum UyatNetworkStatus: uint8_t {
+  SMARTCONFIG = 0x00,
+  AP_MODE = 0x01,
+  WIFI_CONFIGURED = 0x02,
+  WIFI_CONNECTED = 0x03,
+  CLOUD_CONNECTED = 0x04,
+};
+
+
+enum FactoryResetType: uint8_t {
+  BY_HW = 0x00, // Reset by hardware operation
+  BY_APP = 0x01, // Reset performed on the mobile app
+  BY_APP_WIPE = 0x02 // Factory reset performed on the mobile app
+};
+
+
+struct UyatDatapointListener {
+  MatchingDatapoint configured;
+  OnDatapointCallback on_datapoint;
+};
+
+using OnFrameEndCallback = Delegate<void()>;
+
+enum class UyatCommandType : uint8_t {
+  HEARTBEAT = 0x00,
+  PRODUCT_QUERY = 0x01,
+  CONF_QUERY = 0x02,
+  WIFI_STATE = 0x03,
+  WIFI_RESET = 0x04,
+  WIFI_SELECT = 0x05,
+  DATAPOINT_DELIVER = 0x06,
+  DATAPOINT_REPORT_ASYNC = 0x07,
+  DATAPOINT_QUERY = 0x08,
+  WIFI_TEST = 0x0E,
+  LOCAL_TIME_QUERY = 0x1C,
+  DATAPOINT_REPORT_SYNC = 0x22,
+  DATAPOINT_REPORT_ACK = 0x23,
+  WIFI_RSSI = 0x24,
+  DISABLE_HEARTBEATS = 0x25,
+  VACUUM_MAP_UPLOAD = 0x28,
+  GET_NETWORK_STATUS = 0x2B,
+  GET_MAC_ADDRESS = 0x2D,
+  EXTENDED_SERVICES = 0x34,
+};
+
+enum class UyatExtendedServicesCommandType : uint8_t {
+  RESET_NOTIFICATION = 0x04,
+  FACTORY_RESET = 0x05,
+  GET_MODULE_INFORMATION = 0x07,
+  UPDATE_IN_PROGRESS = 0x0A,
+};
+
+enum class UyatInitState : uint8_t {
+  INIT_HEARTBEAT = 0x00,
+  INIT_PRODUCT,
+  INIT_CONF,
+  INIT_WIFI,
+  INIT_DATAPOINT,
+  INIT_DONE,
+};
+
+struct UyatCommand {
+  UyatCommandType cmd;
+  std::vector<uint8_t> payload;
+#ifdef UYAT_LATENCY_ENABLED
+  uint32_t enqueued_us{0};  // set only for datapoint writes
+#endif
+};
+
+#ifdef UYAT_DIAGNOSTICS_ENABLED
+enum UyatDiagDirtyFlag : uint8_t {
+  DIAG_DIRTY_UNKNOWN_COMMANDS = 1 << 0,
+  DIAG_DIRTY_UNKNOWN_EXTENDED_COMMANDS = 1 << 1,
+  DIAG_DIRTY_UNHANDLED_DATAPOINTS = 1 << 2,
+  DIAG_DIRTY_DATAPOINT_STATS = 1 << 3,
+  DIAG_DIRTY_ALL = DIAG_DIRTY_UNKNOWN_COMMANDS | DIAG_DIRTY_UNKNOWN_EXTENDED_COMMANDS | DIAG_DIRTY_UNHANDLED_DATAPOINTS |
+                   DIAG_DIRTY_DATAPOINT_STATS,
+};
+#endif
+
+enum class FrameTraceDumpFormat : uint8_t {
+  TEXT,  // one human readable log line per frame
+  HEX,   // the binary export format, as hex log lines
+};
+
+// The byte stream to and from the MCU (the uart on the device).
+class UyatTransport {
+ public:
+  virtual ~UyatTransport() = default;
+  virtual std::size_t rx_available() = 0;
+  virtual bool rx_read(uint8_t &byte) = 0;
+  virtual void tx_write(const uint8_t *data, std::size_t len) = 0;
+};
+
+class UyatClock {
+ public:
+  virtual ~UyatClock() = default;
+  virtual uint32_t get_millis() = 0;
+  virtual uint32_t get_micros() = 0;
+};
+
+// Named timers, starting a timer replaces the pending one with the same name.
+class UyatScheduler {
+ public:
+  using TimerCallback = std::function<void()>;
+
+  virtual ~UyatScheduler() = default;
+  virtual void start_timer(const char *name, uint32_t delay_ms, bool repeat, TimerCallback &&callback) = 0;
+  virtual void stop_timer(const char *name) = 0;
+};
+
+// The protocol itself: framing, command handling, the init sequence and the datapoint listeners.
+// Has no dependency on esphome components, the platform is reached only through the transport,
+// clock and scheduler interfaces and the protected hooks below. The esphome component (Uyat) is an
+// adapter around it, host tools (see CMakeLists.txt in the repository root) can use it directly.
+class UyatCore : public DatapointHandler {
+ public:
+  UyatCore(UyatTransport &transport, UyatClock &clock, UyatScheduler &scheduler);
+
+  // starts the heartbeats, the rest of the init sequence is driven by the MCU responses
+  void start();
+  // reads the available input, handles the received frames and sends the next queued command
+  void poll();
+  void dump_core_config();
+
+  void register_datapoint_listener(const uint8_t datapoint_id, const OnDatapointCallback &func);
+  void register_datapoint_listener(const uint8_t datapoint_id, const UyatDatapointType type, const OnDatapointCallback &func);
+  void register_datapoint_listener(const MatchingDatapoint& matching_dp, const OnDatapointCallback &func) override;
+  // Called after all datapoints of a single MCU frame were dispatched to the listeners.
+  // Composite entities can use it to publish their state once per frame instead of once per datapoint.
+  void register_frame_end_listener(const OnFrameEndCallback &func) { this->frame_end_listeners_.push_back(func); }
+  bool is_processing_frame() const { return this->processing_frame_; }
+  void set_datapoint_value(const UyatDatapoint& value, const bool forced = false) override;
+#ifdef UYAT_MEMORY_STATS_ENABLED
+  void register_memory_user(const char *tag, const uint8_t dp_number, const MemoryUsageCallback &usage) override {
+    this->memory_stats_.add_entity(tag, dp_number, usage);
+  }
+#endif
+  void send_generic_command(const UyatCommand &command) { send_command_(command); }
+  UyatInitState get_init_state();
+  // nothing received is waiting to be handled and no command is queued or waiting for its response, so
+  // only new input or a timer can make poll() do anything - a host program on a simulated clock can skip
+  // the time till then
+  bool is_idle() const {
+    return this->rx_message_.empty() && this->command_queue_.empty() && !this->expected_response_.has_value();
+  }
+  void set_report_ap_name(const std::string& ap_name) { this->report_ap_name_ = ap_name; }
+
+#ifdef UYAT_TRACE_EVENTS_ENABLED
+  // nullptr to stop tracing
+  void set_trace_events(UyatTraceEvents *trace_events) { this->trace_events_ = trace_events; }
+#endif
+#ifdef UYAT_PROFILER_ENABLED
+  void set_slow_listener_threshold(uint32_t threshold_us) { this->profiler_.set_slow_listener_threshold_us(threshold_us); }
+#endif
+  void add_ignore_mcu_update_on_datapoints(uint8_t ignore_mcu_update_on_datapoints) {
+    this->add_datapoint_policy(ignore_mcu_update_on_datapoints, DatapointPolicy{.ignore = true});
+  }
+  void add_datapoint_policy(uint8_t datapoint_id, const DatapointPolicy &policy);
+
+  void trigger_factory_reset(const FactoryResetType reset_type);
+  void dump_frame_trace(const FrameTraceDumpFormat format);
+
+
+  void set_raw_datapoint_value(uint8_t datapoint_id, const std::vector<uint8_t> &value){
+    set_datapoint_value(UyatDatapoint{datapoint_id, RawDatapointValue{value}}, false);
+  }
+  void set_boolean_datapoint_value(uint8_t datapoint_id, bool value){
+    set_datapoint_value(UyatDatapoint{datapoint_id, BoolDatapointValue{value}}, false);
+  }
+  void set_integer_datapoint_value(uint8_t datapoint_id, uint32_t value){
+    set_datapoint_value(UyatDatapoint{datapoint_id, UIntDatapointValue{value}}, false);
+  }
+  void set_string_datapoint_value(uint8_t datapoint_id, const std::string &value){
+    set_datapoint_value(UyatDatapoint{datapoint_id, StringDatapointValue{value}}, false);
+  }
+  void set_enum_datapoint_value(uint8_t datapoint_id, uint8_t value){
+    set_datapoint_value(UyatDatapoint{datapoint_id, EnumDatapointValue{value}}, false);
+  }
+  void force_set_raw_datapoint_value(uint8_t datapoint_id, const std::vector<uint8_t> &value){
+    set_datapoint_value(UyatDatapoint{datapoint_id, RawDatapointValue{value}}, true);
+  }
+  void force_set_boolean_datapoint_value(uint8_t datapoint_id, bool value){
+    set_datapoint_value(UyatDatapoint{datapoint_id, BoolDatapointValue{value}}, true);
+  }
+  void force_set_integer_datapoint_value(uint8_t datapoint_id, uint32_t value){
+    set_datapoint_value(UyatDatapoint{datapoint_id, UIntDatapointValue{value}}, true);
+  }
+  void force_set_string_datapoint_value(uint8_t datapoint_id, const std::string &value){
+    set_datapoint_value(UyatDatapoint{datapoint_id, StringDatapointValue{value}}, true);
+  }
+  void force_set_enum_datapoint_value(uint8_t datapoint_id, uint8_t value){
+    set_datapoint_value(UyatDatapoint{datapoint_id, EnumDatapointValue{value}}, true);
+  }
+
+ protected:
+  // Platform hooks, the defaults are what a device without the respective feature would do.
+  // the first datapoint report after the init sequence was received
+  virtual void on_initialized_() {}
+  // product_ was updated from the PRODUCT_QUERY response
+  virtual void on_product_changed_() {}
+  // requested_wifi_config_is_ap_ was changed by the MCU
+  virtual void on_pairing_mode_changed_() {}
+  // the MCU drives the WiFi status LED itself on the given pin, instead of WIFI_STATE reports
+  virtual void on_status_pin_reported_(int /*pin*/) {}
+  virtual bool is_network_connected_() { return true; }
+  virtual void get_mac_address_(uint8_t *mac) { std::fill(mac, mac + 6, 0); }
+  virtual void on_local_time_query_();
+
+  void handle_input_buffer_();
+  void handle_datapoints_(const std::deque<uint8_t> &buffer, size_t offset, size_t len);
+  void handle_datapoints_frame_(const std::deque<uint8_t> &buffer, size_t offset, size_t len);
+  std::optional<UyatDatapoint> get_datapoint_(uint8_t datapoint_id);
+  // returns number of bytes to remove from the beginning of rx buffer
+  std::size_t validate_message_();
+
+  void handle_command_(uint8_t command, uint8_t version, const std::deque<uint8_t> &buffer,
+                       size_t offset, size_t len);
+  // runs the listeners of a datapoint that passed its policy
+  void dispatch_datapoint_(const UyatDatapoint &datapoint);
+  // (re)starts the timer delivering the datapoints deferred by min_interval
+  void schedule_deferred_datapoints_();
+  void dispatch_deferred_datapoints_();
+  void send_raw_command_(UyatCommand command);
+  void process_command_queue_();
+  // drops the front of the queue, once sent and answered or given up
+  void pop_command_();
+  void send_command_(const UyatCommand &command);
+  void send_empty_command_(UyatCommandType command);
+  void send_datapoint_command_(uint8_t datapoint_id, UyatDatapointType datapoint_type, std::vector<uint8_t> data);
+  void send_wifi_status_(const uint8_t status);
+  uint8_t get_wifi_rssi_();
+  void report_wifi_connected_or_retry_(const uint32_t delay_ms);
+  void report_cloud_connected_();
+  void query_product_info_with_retries_();
+  std::string process_get_module_information_(const uint8_t *buffer, size_t len);
+  void schedule_heartbeat_(const bool initial);
+  void stop_heartbeats_();
+#ifdef UYAT_MEMORY_STATS_ENABLED
+  void update_memory_stats_();
+#endif
+
+  UyatTransport &transport_;
+  UyatClock &clock_;
+  UyatScheduler &scheduler_;
+
+  std::string report_ap_name_ = "smartlife";
+  UyatInitState init_state_ = UyatInitState::INIT_HEARTBEAT;
+  bool init_failed_{false};
+  bool heartbeats_enabled_{true};
+  int init_retries_{0};
+  uint8_t protocol_version_ = -1;
+  int status_pin_reported_ = -1;
+  int reset_pin_reported_ = -1;
+  uint32_t last_command_timestamp_ = 0;
+  uint32_t last_rx_char_timestamp_ = 0;
+  std::string product_ = "";
+  std::vector<UyatDatapointListener> listeners_;
+  std::vector<OnFrameEndCallback> frame_end_listeners_;
+  bool processing_frame_{false};
+  std::vector<UyatDatapoint> cached_datapoints_;
+  std::deque<uint8_t> rx_message_;
+  DatapointPolicyTable datapoint_policies_;
+  std::vector<UyatCommand> command_queue_;
+  std::optional<UyatCommandType> expected_response_{};
+  UyatNetworkStatus wifi_status_{UyatNetworkStatus::WIFI_CONFIGURED};
+  std::optional<bool> requested_wifi_config_is_ap_{};
+
+#ifdef UYAT_DIAGNOSTICS_ENABLED
+  uint64_t num_garbage_bytes_{0};
+  std::vector<uint8_t> unknown_commands_set_;
+  std::vector<uint8_t> unknown_extended_commands_set_;
+  std::vector<uint8_t> unhandled_datapoints_set_;
+  UyatStatistics statistics_;
+  // text diagnostics waiting to be published, see DIAG_DIRTY_*
+  uint8_t diag_dirty_{DIAG_DIRTY_ALL};
+  std::string diag_text_buffer_;
+#endif
+#ifdef UYAT_FRAME_TRACE_ENABLED
+  FrameTrace frame_trace_;
+#endif
+#ifdef UYAT_DATAPOINT_STATS_ENABLED
+  DatapointStatistics datapoint_stats_;
+#endif
+#ifdef UYAT_LATENCY_ENABLED
+  UyatLatencyTracker latency_;
+#endif
+#ifdef UYAT_MEMORY_STATS_ENABLED
+  UyatMemoryStats memory_stats_;
+#endif
+#ifdef UYAT_PROFILER_ENABLED
+  UyatProfiler profiler_;
+  const UyatProfiler::ClockFunc profiler_clock_{[this] { return this->clock_.get_micros(); }};
+#endif
+#ifdef UYAT_TRACE_EVENTS_ENABLED
+  void trace_response_wait_(bool answered);
+
+  UyatTraceEvents *trace_events_{nullptr};
+  uint32_t trace_rx_frame_start_us_{0};
+  uint32_t trace_rx_last_us_{0};
+  uint8_t trace_wait_command_{0};
+  uint32_t trace_wait_start_us_{0};
+#endif
+ private:
+  inline uint8_t byte_at_(const std::deque<uint8_t> &buffer, size_t offset, size_t idx) const {
+    return buffer[offset + idx];
+  }
+};
+
+}  // namespace esphome::uyat
@@ -0,0 +1,274 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "uyat_datapoint_types.h"
+
+namespace esphome::uyat
+{
+
+// Ingest policy applied to a datapoint reported by the MCU, before any listener runs.
+struct DatapointPolicy
+{
+  // drop the update completely, the cached value is not updated either
+  bool ignore{false};
+  // don't dispatch if the value is equal to the last dispatched one
+  bool drop_duplicates{false};
+  // don't dispatch if the previous dispatch was less than this many ms ago (0 - disabled)
+  uint32_t min_interval_ms{0u};
+  // INTEGER datapoints only: don't dispatch unless the value moved by more than this
+  // from the last dispatched one (0 - disabled)
+  uint32_t integer_deadband{0u};
+
+  std::string to_string() const
+  {
+    if (ignore)
+    {
+      return "ignore";
+    }
+    return str_sprintf("drop_duplicates: %s, min_interval: %ums, integer_deadband: %u",
+                       TRUEFALSE(drop_duplicates), min_interval_ms, integer_deadband);
+  }
+};
+
+enum class DatapointPolicyVerdict : uint8_t
+{
+  DISPATCH,   // pass to the cache and to the listeners
+  SUPPRESS,   // update the cache, but don't run the listeners
+  DEFER,      // update the cache, the listeners get the latest deferred value once min_interval expires
+  IGNORE,     // drop completely
+};
+
+// Maps a datapoint number to its policy in O(1) through a 256 byte index.
+// Datapoints without a policy are always dispatched.
+// Of the last dispatched value only a uint32_t is kept: the value itself for the integer-like types,
+// a FNV-1a hash of the bytes for raw and string (like DatapointStatistics), and only when
+// drop_duplicates or integer_deadband needs it. A full copy is held just for a value deferred by
+// min_interval, till it is delivered.
+class DatapointPolicyTable
+{
+public:
+  DatapointPolicyTable()
+  {
+    this->index_.fill(NO_POLICY);
+  }
+
+  // returns false if the table is full
+  bool set_policy(const uint8_t dp_number, const DatapointPolicy& policy)
+  {
+    const auto existing = this->index_[dp_number];
+    if (existing != NO_POLICY)
+    {
+      this->entries_[existing] = Entry{.number = dp_number, .policy = policy};
+      this->drop_pending_(dp_number);
+      return true;
+    }
+
+    if (this->entries_.size() >= NO_POLICY)
+    {
+      return false;
+    }
+
+    this->index_[dp_number] = static_cast<uint8_t>(this->entries_.size());
+    this->entries_.push_back(Entry{.number = dp_number, .policy = policy});
+    return true;
+  }
+
+  std::optional<DatapointPolicy> get_policy(const uint8_t dp_number) const
+  {
+    const auto slot = this->index_[dp_number];
+    if (slot == NO_POLICY)
+    {
+      return std::nullopt;
+    }
+    return this->entries_[slot].policy;
+  }
+
+  DatapointPolicyVerdict check(const UyatDatapoint& datapoint, const uint32_t now_ms)
+  {
+    const auto slot = this->index_[datapoint.number];
+    if (slot == NO_POLICY)
+    {
+      return DatapointPolicyVerdict::DISPATCH;
+    }
+
+    auto& entry = this->entries_[slot];
+    const auto& policy = entry.policy;
+    if (policy.ignore)
+    {
+      return DatapointPolicyVerdict::IGNORE;
+    }
+
+    const auto type = datapoint.get_type();
+    const bool compares_values = policy.drop_duplicates || (policy.integer_deadband > 0u);
+    const uint32_t value = compares_values? compact_value(datapoint) : 0u;
+    if (entry.dispatched && (entry.last_type == type))
+    {
+      if (compares_values && is_filtered_(entry, type, value))
+      {
+        // back to the dispatched value, an older deferred one must not be delivered anymore
+        this->drop_pending_(datapoint.number);
+        return DatapointPolicyVerdict::SUPPRESS;
+      }
+
+      if ((policy.min_interval_ms > 0u) && ((now_ms - entry.last_dispatch_ms) < policy.min_interval_ms))
+      {
+        this->set_pending_(datapoint);
+        return DatapointPolicyVerdict::DEFER;
+      }
+    }
+
+    this->drop_pending_(datapoint.number);
+    mark_dispatched_(entry, type, value, now_ms);
+    return DatapointPolicyVerdict::DISPATCH;
+  }
+
+  std::size_t num_pending() const
+  {
+    return this->pending_.size();
+  }
+
+  // ms till the first deferred datapoint is due, nullopt when none is deferred
+  std::optional<uint32_t> next_pending_in_ms(const uint32_t now_ms) const
+  {
+    std::optional<uint32_t> next;
+    for (const auto& datapoint : this->pending_)
+    {
+      const auto& entry = this->entries_[this->index_[datapoint.number]];
+      const uint32_t elapsed_ms = now_ms - entry.last_dispatch_ms;
+      const uint32_t in_ms = (elapsed_ms < entry.policy.min_interval_ms)? (entry.policy.min_interval_ms - elapsed_ms) : 0u;
+      if (!next.has_value() || (in_ms < *next))
+      {
+        next = in_ms;
+      }
+    }
+    return next;
+  }
+
+  // moves the deferred datapoints whose min_interval expired to due, they count as dispatched now
+  void take_due(const uint32_t now_ms, std::vector<UyatDatapoint>& due)
+  {
+    auto it = this->pending_.begin();
+    while (it != this->pending_.end())
+    {
+      auto& entry = this->entries_[this->index_[it->number]];
+      if ((now_ms - entry.last_dispatch_ms) < entry.policy.min_interval_ms)
+      {
+        ++it;
+        continue;
+      }
+
+      const bool compares_values = entry.policy.drop_duplicates || (entry.policy.integer_deadband > 0u);
+      mark_dispatched_(entry, it->get_type(), compares_values? compact_value(*it) : 0u, now_ms);
+      due.push_back(std::move(*it));
+      it = this->pending_.erase(it);
+    }
+  }
+
+  template<typename F>
+  void for_each(F&& func) const
+  {
+    for (const auto& entry : this->entries_)
+    {
+      func(entry.number, entry.policy);
+    }
+  }
+
+  bool empty() const
+  {
+    return this->entries_.empty();
+  }
+
+  static uint32_t compact_value(const UyatDatapoint& datapoint)
+  {
+    return std::visit([](const auto& dp) -> uint32_t {
+      using Value = std::decay_t<decltype(dp)>;
+      if constexpr (std::is_same_v<Value, RawDatapointValue> || std::is_same_v<Value, StringDatapointValue>)
+      {
+        uint32_t hash = 2166136261u;
+        for (const auto byte : dp.value)
+        {
+          hash = (hash ^ static_cast<uint8_t>(byte)) * 16777619u;
+        }
+        return hash;
+      }
+      else
+      {
+        return static_cast<uint32_t>(dp.value);
+      }
+    },
+    datapoint.value);
+  }
+
+private:
+  static constexpr uint8_t NO_POLICY = 0xFFu;
+
+  struct Entry
+  {
+    uint8_t number;
+    DatapointPolicy policy;
+    bool dispatched{false};
+    UyatDatapointType last_type{UyatDatapointType::RAW};
+    uint32_t last_value{0u};
+    uint32_t last_dispatch_ms{0u};
+  };
+
+  static bool is_filtered_(const Entry& entry, const UyatDatapointType type, const uint32_t value)
+  {
+    if (entry.policy.drop_duplicates && (value == entry.last_value))
+    {
+      return true;
+    }
+
+    if ((entry.policy.integer_deadband > 0u) && (type == UyatDatapointType::INTEGER))
+    {
+      // Tuya integers are signed on the wire
+      const int64_t delta = static_cast<int64_t>(static_cast<int32_t>(value)) -
+                            static_cast<int64_t>(static_cast<int32_t>(entry.last_value));
+      return (static_cast<uint64_t>(std::llabs(delta)) <= entry.policy.integer_deadband);
+    }
+    return false;
+  }
+
+  static void mark_dispatched_(Entry& entry, const UyatDatapointType type, const uint32_t value, const uint32_t now_ms)
+  {
+    entry.dispatched = true;
+    entry.last_type = type;
+    entry.last_value = value;
+    entry.last_dispatch_ms = now_ms;
+  }
+
+  void set_pending_(const UyatDatapoint& datapoint)
+  {
+    for (auto& pending : this->pending_)
+    {
+      if (pending.number == datapoint.number)
+      {
+        pending = datapoint;
+        return;
+      }
+    }
+    this->pending_.push_back(datapoint);
+  }
+
+  void drop_pending_(const uint8_t dp_number)
+  {
+    this->pending_.erase(std::remove_if(this->pending_.begin(), this->pending_.end(),
+                                        [dp_number](const UyatDatapoint& pending) { return pending.number == dp_number; }),
+                         this->pending_.end());
+  }
+
+  std::array<uint8_t, 256u> index_;
+  std::vector<Entry> entries_;
+  // the latest value deferred by min_interval, at most one per datapoint
+  std::vector<UyatDatapoint> pending_;
+};
+
+}
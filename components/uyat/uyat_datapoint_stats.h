@@ -0,0 +1,159 @@
+#pragma once
+
+#include <array>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace esphome::uyat
+{
+
+// Per-datapoint traffic statistics, indexed in O(1) by the datapoint number.
+// Value changes are detected by comparing a hash of the raw type + payload bytes,
+// so no copy of the value is kept.
+class DatapointStatistics
+{
+public:
+  static constexpr uint32_t RATE_WINDOW_MS = 60000u;
+
+  struct Entry
+  {
+    uint8_t number;
+    uint32_t reports;
+    uint32_t changes;
+    uint32_t repeats;
+    uint32_t bytes;
+    uint32_t last_seen_ms;
+    uint32_t value_hash;
+    uint32_t window_start_ms;
+    uint32_t window_reports;
+    float reports_per_minute;
+  };
+
+  DatapointStatistics()
+  {
+    this->index_.fill(NO_ENTRY);
+  }
+
+  // raw - the datapoint record as received (number, type, length, payload)
+  template<typename Container>
+  void on_report(const Container& raw, const std::size_t offset, const std::size_t length, const uint32_t now_ms)
+  {
+    if (length == 0u)
+    {
+      return;
+    }
+
+    auto* entry = this->entry_for_(raw[offset], now_ms);
+    if (entry == nullptr)
+    {
+      return;
+    }
+
+    // FNV-1a over everything but the datapoint number
+    uint32_t hash = 2166136261u;
+    for (std::size_t i = 1u; i < length; ++i)
+    {
+      hash = (hash ^ raw[offset + i]) * 16777619u;
+    }
+
+    if ((entry->reports > 0u) && (hash == entry->value_hash))
+    {
+      ++entry->repeats;
+    }
+    else
+    {
+      ++entry->changes;
+    }
+    ++entry->reports;
+    entry->bytes += length;
+    entry->value_hash = hash;
+    entry->last_seen_ms = now_ms;
+
+    ++entry->window_reports;
+    const uint32_t window_ms = now_ms - entry->window_start_ms;
+    if (window_ms >= RATE_WINDOW_MS)
+    {
+      entry->reports_per_minute = entry->window_reports * 60000.0f / window_ms;
+      entry->window_start_ms = now_ms;
+      entry->window_reports = 0u;
+    }
+  }
+
+  // Reports per minute: the last full window, or the current one if none is complete yet.
+  static float reports_per_minute(const Entry& entry, const uint32_t now_ms)
+  {
+    if (entry.reports > entry.window_reports)
+    {
+      return entry.reports_per_minute;
+    }
+    const uint32_t window_ms = now_ms - entry.window_start_ms;
+    return (window_ms > 0u)? (entry.window_reports * 60000.0f / window_ms) : 0.0f;
+  }
+
+  // visits the entries in the order the datapoints were first seen
+  template<typename F>
+  void for_each(F&& func) const
+  {
+    for (const auto& entry : this->entries_)
+    {
+      func(entry);
+    }
+  }
+
+  bool empty() const
+  {
+    return this->entries_.empty();
+  }
+
+  std::size_t heap_bytes() const
+  {
+    return this->entries_.capacity() * sizeof(Entry);
+  }
+
+  // {"<dp>":[reports,per_minute,seconds_since_last,changes,repeats,bytes],...}
+  void format_json_into(std::string& buffer, const uint32_t now_ms) const
+  {
+    buffer.clear();
+    buffer += '{';
+    char item[96];
+    for (const auto& entry : this->entries_)
+    {
+      snprintf(item, sizeof(item), "%s\"%u\":[%" PRIu32 ",%.1f,%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 "]",
+               (buffer.size() > 1u)? "," : "", entry.number, entry.reports, reports_per_minute(entry, now_ms),
+               (now_ms - entry.last_seen_ms) / 1000u, entry.changes, entry.repeats, entry.bytes);
+      buffer += item;
+    }
+    buffer += '}';
+  }
+
+private:
+  static constexpr uint8_t NO_ENTRY = 0xFFu;
+
+  Entry* entry_for_(const uint8_t dp_number, const uint32_t now_ms)
+  {
+    const auto slot = this->index_[dp_number];
+    if (slot != NO_ENTRY)
+    {
+      return &this->entries_[slot];
+    }
+
+    if (this->entries_.size() >= NO_ENTRY)
+    {
+      return nullptr;
+    }
+
+    this->index_[dp_number] = static_cast<uint8_t>(this->entries_.size());
+    this->entries_.push_back(Entry{.number = dp_number, .reports = 0u, .changes = 0u, .repeats = 0u, .bytes = 0u,
+                                   .last_seen_ms = now_ms, .value_hash = 0u, .window_start_ms = now_ms,
+                                   .window_reports = 0u, .reports_per_minute = 0.0f});
+    return &this->entries_.back();
+  }
+
+  std::array<uint8_t, 256u> index_;
+  std::vector<Entry> entries_;
+};
+
+}
@@ -1,12 +1,17 @@
+#include <algorithm>
+#include <cinttypes>
 #include <cstdint>
+#include <cstdio>
 #include <deque>
+#include <initializer_list>
 #include <optional>
+#include <type_traits>
 #include <variant>
 #include <string>
 #include <vector>
-#include <functional>
 
-#include "esphome/core/helpers.h"
+#include "uyat_platform.h"
+#include "uyat_delegate.h"
 
 #pragma once
 
@@ -23,10 +28,59 @@ enum class UyatDatapointType: uint8_t {
   BITMAP = 0x05,  // 1/2/4 bytes
 };
 
+// Set of datapoint types stored as a single bitmask (bit N allows UyatDatapointType N).
+// An empty set allows any type.
+class DatapointTypeSet
+{
+public:
+  constexpr DatapointTypeSet() = default;
+
+  constexpr DatapointTypeSet(std::initializer_list<UyatDatapointType> types)
+  {
+    for (const auto type : types)
+    {
+      this->mask_ |= type_bit(type);
+    }
+  }
+
+  static constexpr uint8_t type_bit(const UyatDatapointType dp_type)
+  {
+    return static_cast<uint8_t>(1u << static_cast<uint8_t>(dp_type));
+  }
+
+  constexpr bool empty() const
+  {
+    return this->mask_ == 0u;
+  }
+
+  constexpr bool contains(const UyatDatapointType dp_type) const
+  {
+    return (this->mask_ & type_bit(dp_type)) != 0u;
+  }
+
+  constexpr bool is_single() const
+  {
+    return (this->mask_ != 0u) && ((this->mask_ & (this->mask_ - 1u)) == 0u);
+  }
+
+  constexpr uint8_t get_mask() const
+  {
+    return this->mask_;
+  }
+
+  constexpr bool operator==(const DatapointTypeSet& other) const
+  {
+    return this->mask_ == other.mask_;
+  }
+
+private:
+  uint8_t mask_{0u};
+};
+
 struct MatchingDatapoint
 {
   uint8_t number;
-  std::vector<UyatDatapointType> types;
+  DatapointTypeSet types;
 
   static constexpr const char* get_type_name(const UyatDatapointType dp_type)
   {
@@ -58,45 +112,94 @@ struct MatchingDatapoint
     }
     else
     {
-      for (const auto& type : types)
+      for (uint8_t type = static_cast<uint8_t>(UyatDatapointType::RAW); type <= static_cast<uint8_t>(UyatDatapointType::BITMAP); ++type)
       {
+        if (!types.contains(static_cast<UyatDatapointType>(type)))
+        {
+          continue;
+        }
         if (!type_list.empty())
         {
           type_list += ", ";
         }
-        type_list += get_type_name(type);
+        type_list += get_type_name(static_cast<UyatDatapointType>(type));
       }
     }
     return str_sprintf("Datapoint %u:", number) + type_list;
   }
 
-  bool matches(const UyatDatapointType dp_type) const
+  constexpr bool matches(const UyatDatapointType dp_type) const
   {
-    if (types.empty())
-    {
-      return true;
-    }
+    return types.empty() || types.contains(dp_type);
+  }
+
+  constexpr bool allows_single_type() const
+  {
+    return types.is_single();
+  }
 
-    for (const auto& type : types)
+  constexpr bool allows_any_type() const
+  {
+    return types.empty();
+  }
+
+  // Narrows an auto-detected set of types to the one actually reported by the MCU.
+  // Returns true if the type got resolved by this call.
+  bool resolve_type(const UyatDatapointType dp_type)
+  {
+    if (allows_single_type())
     {
-      if (type == dp_type)
-      {
-        return true;
-      }
+      return false;
     }
-    return false;
+    types = {dp_type};
+    return true;
   }
+};
 
-  bool allows_single_type() const
+// Appends printf style output at pos, the result is always terminated and never goes past
+// the end of the buffer. Returns the new position.
+template<typename... Args>
+inline std::size_t format_at(char* buffer, const std::size_t size, const std::size_t pos, const char* format, Args... args)
+{
+  if (pos >= size)
   {
-    return types.size() == 1;
+    return pos;
   }
+  const int written = snprintf(buffer + pos, size - pos, format, args...);
+  if (written < 0)
+  {
+    return pos;
+  }
+  return std::min(pos + static_cast<std::size_t>(written), size - 1u);
+}
 
-  bool allows_any_type() const
+// Same output as format_hex_pretty(data, length), but into a fixed buffer (truncated if too small).
+inline std::size_t format_hex_pretty_to(char* buffer, const std::size_t size, const uint8_t* data, const std::size_t length)
+{
+  static const char *const HEX_DIGITS = "0123456789ABCDEF";
+  if (size == 0u)
   {
-    return types.empty();
+    return 0u;
   }
-};
+  // keep room for the length, it tells how much was cut off
+  const std::size_t reserved = (length > 4u)? sizeof(" (65535)") : 0u;
+  std::size_t pos = 0u;
+  for (std::size_t i = 0u; (i < length) && ((pos + 3u + reserved) < size); ++i)
+  {
+    if (i > 0u)
+    {
+      buffer[pos++] = '.';
+    }
+    buffer[pos++] = HEX_DIGITS[data[i] >> 4];
+    buffer[pos++] = HEX_DIGITS[data[i] & 0x0F];
+  }
+  buffer[pos] = '\0';
+  if (length > 4u)
+  {
+    pos = format_at(buffer, size, pos, " (%zu)", length);
+  }
+  return pos;
+}
 
 struct RawDatapointValue {
   static constexpr UyatDatapointType dp_type = UyatDatapointType::RAW;
@@ -107,6 +210,11 @@ struct RawDatapointValue {
     return format_hex_pretty(value);
   }
 
+  std::size_t format_to(char* buffer, const std::size_t size) const
+  {
+    return format_hex_pretty_to(buffer, size, value.data(), value.size());
+  }
+
   std::vector<uint8_t> to_payload() const
   {
     return value;
@@ -127,6 +235,11 @@ struct BoolDatapointValue {
     return TRUEFALSE(value);
   }
 
+  std::size_t format_to(char* buffer, const std::size_t size) const
+  {
+    return format_at(buffer, size, 0u, "%s", TRUEFALSE(value));
+  }
+
   std::vector<uint8_t> to_payload() const
   {
     return std::vector<uint8_t>{static_cast<uint8_t>(value? 0x01 : 0x00)};
@@ -147,6 +260,11 @@ struct UIntDatapointValue {
     return str_sprintf("%u", value);
   }
 
+  std::size_t format_to(char* buffer, const std::size_t size) const
+  {
+    return format_at(buffer, size, 0u, "%" PRIu32, value);
+  }
+
   std::vector<uint8_t> to_payload() const
   {
     return std::vector<uint8_t>{
@@ -172,6 +290,11 @@ struct StringDatapointValue {
     return value;
   }
 
+  std::size_t format_to(char* buffer, const std::size_t size) const
+  {
+    return format_at(buffer, size, 0u, "%.*s", static_cast<int>(value.size()), value.c_str());
+  }
+
   std::vector<uint8_t> to_payload() const
   {
     std::vector<uint8_t> data;
@@ -198,6 +321,11 @@ struct EnumDatapointValue {
     return str_sprintf("%d", value);
   }
 
+  std::size_t format_to(char* buffer, const std::size_t size) const
+  {
+    return format_at(buffer, size, 0u, "%d", value);
+  }
+
   std::vector<uint8_t> to_payload() const
   {
     return std::vector<uint8_t>{value};
@@ -218,6 +346,11 @@ struct BitmapDatapointValue {
     return str_sprintf("%08X", value);
   }
 
+  std::size_t format_to(char* buffer, const std::size_t size) const
+  {
+    return format_at(buffer, size, 0u, "%08" PRIX32, value);
+  }
+
   std::vector<uint8_t> to_payload() const
   {
     // choose size based on highest set bit
@@ -259,6 +392,17 @@ using AnyDatapointValue = std::variant<RawDatapointValue,
                                        EnumDatapointValue,
                                        BitmapDatapointValue>;
 
+// The alternatives are ordered like UyatDatapointType, so the variant index is the wire type.
+template<typename T>
+inline constexpr std::size_t datapoint_value_index_v = static_cast<std::size_t>(T::dp_type);
+
+static_assert(std::is_same_v<std::variant_alternative_t<datapoint_value_index_v<RawDatapointValue>, AnyDatapointValue>, RawDatapointValue>);
+static_assert(std::is_same_v<std::variant_alternative_t<datapoint_value_index_v<BoolDatapointValue>, AnyDatapointValue>, BoolDatapointValue>);
+static_assert(std::is_same_v<std::variant_alternative_t<datapoint_value_index_v<UIntDatapointValue>, AnyDatapointValue>, UIntDatapointValue>);
+static_assert(std::is_same_v<std::variant_alternative_t<datapoint_value_index_v<StringDatapointValue>, AnyDatapointValue>, StringDatapointValue>);
+static_assert(std::is_same_v<std::variant_alternative_t<datapoint_value_index_v<EnumDatapointValue>, AnyDatapointValue>, EnumDatapointValue>);
+static_assert(std::is_same_v<std::variant_alternative_t<datapoint_value_index_v<BitmapDatapointValue>, AnyDatapointValue>, BitmapDatapointValue>);
+
 struct UyatDatapoint {
   uint8_t number;
   AnyDatapointValue value;
@@ -280,10 +424,7 @@ struct UyatDatapoint {
 
   constexpr UyatDatapointType get_type() const
   {
-    return std::visit([](const auto& dp){
-      return std::decay_t<decltype(dp)>::dp_type;
-    },
-    value);
+    return static_cast<UyatDatapointType>(value.index());
   }
 
   constexpr const char* get_type_name() const
@@ -312,6 +453,16 @@ struct UyatDatapoint {
     return str_sprintf("Datapoint %u: %s (value: %s)", number, get_type_name(), value_to_string().c_str());
   }
 
+  std::size_t format_to(char* buffer, const std::size_t size) const
+  {
+    std::size_t pos = format_at(buffer, size, 0u, "Datapoint %u: %s (value: ", number, get_type_name());
+    pos += std::visit([buffer, size, pos](const auto& dp){
+      return dp.format_to(buffer + pos, size - pos);
+    },
+    value);
+    return format_at(buffer, size, pos, ")");
+  }
+
   static std::optional<UyatDatapoint> construct(const std::deque<uint8_t> &raw_data, const std::size_t offset,
                                                 const std::size_t raw_data_len, std::size_t &used_len)
   {
@@ -402,7 +553,56 @@ struct UyatDatapoint {
   }
 };
 
-using OnDatapointCallback = std::function<void(UyatDatapoint)>;
+// Text of a datapoint or of a datapoint value, formatted on the stack. Meant for logging
+// on the hot path without any heap allocation; long values are truncated.
+// It relies on format_to(buffer, size) of UyatDatapoint and of every value type: their
+// to_string() written into the fixed buffer with format_at(), returning the length written.
+class DatapointText
+{
+public:
+  static constexpr std::size_t SIZE = 96u;
+
+  template<typename T>
+  explicit DatapointText(const T& datapoint)
+  {
+    datapoint.format_to(this->buffer_, SIZE);
+  }
+
+  const char* c_str() const
+  {
+    return this->buffer_;
+  }
+
+private:
+  char buffer_[SIZE];
+};
+
+using OnDatapointCallback = Delegate<void(const UyatDatapoint&)>;
+
+// Calls the callback with the typed value of the datapoint, if it holds one of Ts.
+// The type test is a plain index compare per alternative, no std::visit involved.
+template<typename F, typename... Ts>
+struct TypedDatapointDispatcher
+{
+  F callback;
+
+  void operator()(const UyatDatapoint& datapoint) const
+  {
+    (void) (dispatch_<Ts>(datapoint) || ...);
+  }
+
+private:
+  template<typename T>
+  bool dispatch_(const UyatDatapoint& datapoint) const
+  {
+    if (datapoint.value.index() != datapoint_value_index_v<T>)
+    {
+      return false;
+    }
+    callback(*std::get_if<T>(&datapoint.value));
+    return true;
+  }
+};
 
 struct DatapointHandler
 {
@@ -410,6 +610,42 @@ struct DatapointHandler
 
   virtual void register_datapoint_listener(const MatchingDatapoint& matching_dp, const OnDatapointCallback& callback) = 0;
   virtual void set_datapoint_value(const UyatDatapoint& dp, const bool forced = false) = 0;
+
+  using MemoryUsageCallback = Delegate<std::size_t()>;
+
+  // Lets the handler account for the memory held by a datapoint entity, ignored by default.
+  virtual void register_memory_user(const char* /*tag*/, const uint8_t /*dp_number*/, const MemoryUsageCallback& /*usage*/) {}
+
+  // Accounts the entity object itself plus the heap it reports through an optional heap_bytes() method.
+  template<typename DpEntity>
+  void register_entity_memory(const DpEntity& entity)
+  {
+    this->register_memory_user(DpEntity::TAG, entity.get_config().matching_dp.number, MemoryUsageCallback{[&entity]() -> std::size_t {
+      if constexpr (requires { entity.heap_bytes(); })
+      {
+        return sizeof(DpEntity) + entity.heap_bytes();
+      }
+      else
+      {
+        return sizeof(DpEntity);
+      }
+    }});
+  }
+
+  // Registers a listener receiving the value already unpacked to one of Ts, eg:
+  //   register_typed_listener<BoolDatapointValue, UIntDatapointValue>(dp, [this](const auto& value) { ... });
+  // If matching_dp allows any type, only Ts are matched.
+  template<typename... Ts, typename F>
+  void register_typed_listener(const MatchingDatapoint& matching_dp, F callback)
+  {
+    static_assert(sizeof...(Ts) > 0u, "At least one datapoint value type is required");
+    MatchingDatapoint typed_dp = matching_dp;
+    if (typed_dp.allows_any_type())
+    {
+      typed_dp.types = {Ts::dp_type...};
+    }
+    this->register_datapoint_listener(typed_dp, TypedDatapointDispatcher<F, Ts...>{callback});
+  }
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace esphome::uyat
+{
+
+template<typename Signature> class Delegate;
+
+// Non-allocating replacement for std::function used for the internal callbacks
+// (Dp* value callbacks and datapoint listeners). It owns a trivially copyable,
+// pointer-sized callable, copied into an inline buffer - enough for the usual
+// "[this](...){ this->on_something(...); }" lambdas and for captureless lambdas.
+// Anything bigger, or not trivially copyable, is rejected at compile time - use
+// std::function where ownership of a larger state is really needed.
+template<typename R, typename... Args>
+class Delegate<R(Args...)>
+{
+public:
+   constexpr Delegate() = default;
+
+   template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Delegate>>>
+   Delegate(F callable)
+   {
+      static_assert(std::is_invocable_r_v<R, const F&, Args...>, "Callable does not match the delegate signature");
+      static_assert(sizeof(F) <= STORAGE_SIZE, "Callable state too big for Delegate, capture just 'this'");
+      static_assert(alignof(F) <= alignof(void*), "Callable alignment not supported by Delegate");
+      static_assert(std::is_trivially_copyable_v<F>, "Callable must be trivially copyable to be stored in Delegate");
+
+      new (this->storage_) F(callable);
+      this->invoke_ = [](const unsigned char* storage, Args... args) -> R
+      {
+         return (*std::launder(reinterpret_cast<const F*>(storage)))(std::forward<Args>(args)...);
+      };
+   }
+
+   R operator()(Args... args) const
+   {
+      return this->invoke_(this->storage_, std::forward<Args>(args)...);
+   }
+
+   explicit operator bool() const
+   {
+      return this->invoke_ != nullptr;
+   }
+
+private:
+   static constexpr std::size_t STORAGE_SIZE = sizeof(void*);
+   using Invoker = R (*)(const unsigned char*, Args...);
+
+   alignas(void*) unsigned char storage_[STORAGE_SIZE]{};
+   Invoker invoke_{nullptr};
+};
+
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "uyat_platform.h"
+
+// Number of frames kept in the trace, the oldest ones are overwritten.
+#ifndef UYAT_FRAME_TRACE_SIZE
+#define UYAT_FRAME_TRACE_SIZE 64
+#endif
+
+// Number of payload bytes stored with each frame, the rest is only counted in the length.
+#ifndef UYAT_FRAME_TRACE_PAYLOAD_BYTES
+#define UYAT_FRAME_TRACE_PAYLOAD_BYTES 8
+#endif
+
+namespace esphome::uyat
+{
+
+enum class FrameDirection : uint8_t
+{
+  RX = 0x00,
+  TX = 0x01,
+};
+
+// Fixed size ring buffer of the frames exchanged with the MCU.
+// Recording is a copy of a few bytes, there's no allocation and no formatting involved,
+// the formatting only happens when the trace is dumped.
+//
+// The binary export format (all numbers big endian):
+//   header: 'U' 'T' version(1) payload_bytes(1) frame_count(2)
+//   frame:  timestamp_ms(4) direction(1) command(1) length(2) stored payload(min(length, payload_bytes))
+class FrameTrace
+{
+public:
+  static constexpr std::size_t SIZE = UYAT_FRAME_TRACE_SIZE;
+  static constexpr std::size_t PAYLOAD_BYTES = UYAT_FRAME_TRACE_PAYLOAD_BYTES;
+  static constexpr uint8_t FORMAT_VERSION = 1u;
+  static constexpr std::size_t HEADER_SIZE = 6u;
+  static constexpr std::size_t FRAME_HEADER_SIZE = 8u;
+
+  static_assert(SIZE > 0u, "Frame trace needs at least one entry");
+  static_assert(SIZE <= 0xFFFFu, "Frame trace too big for the export format");
+  static_assert(PAYLOAD_BYTES <= 0xFFu, "Frame trace payload too big for the export format");
+
+  struct Entry
+  {
+    uint32_t timestamp_ms;
+    FrameDirection direction;
+    uint8_t command;
+    uint16_t length;
+    std::array<uint8_t, PAYLOAD_BYTES> payload;
+
+    std::size_t stored_bytes() const
+    {
+      return std::min<std::size_t>(this->length, PAYLOAD_BYTES);
+    }
+  };
+
+  // data can be any indexable container (deque for RX, vector for TX)
+  template<typename Container>
+  void record(const FrameDirection direction, const uint32_t timestamp_ms, const uint8_t command,
+              const Container& data, const std::size_t offset, const std::size_t length)
+  {
+    auto& entry = this->entries_[this->next_];
+    entry.timestamp_ms = timestamp_ms;
+    entry.direction = direction;
+    entry.command = command;
+    entry.length = static_cast<uint16_t>(length);
+    const auto stored = entry.stored_bytes();
+    for (std::size_t i = 0u; i < stored; ++i)
+    {
+      entry.payload[i] = data[offset + i];
+    }
+
+    this->next_ = (this->next_ + 1u) % SIZE;
+    if (this->count_ < SIZE)
+    {
+      ++this->count_;
+    }
+    ++this->total_recorded_;
+  }
+
+  // visits the entries from the oldest to the newest
+  template<typename F>
+  void for_each(F&& func) const
+  {
+    const std::size_t first = (this->next_ + SIZE - this->count_) % SIZE;
+    for (std::size_t i = 0u; i < this->count_; ++i)
+    {
+      func(this->entries_[(first + i) % SIZE]);
+    }
+  }
+
+  std::size_t size() const { return this->count_; }
+  uint32_t get_total_recorded() const { return this->total_recorded_; }
+
+  void clear()
+  {
+    this->next_ = 0u;
+    this->count_ = 0u;
+  }
+
+  std::vector<uint8_t> encode() const
+  {
+    std::vector<uint8_t> result;
+    result.reserve(HEADER_SIZE + this->count_ * (FRAME_HEADER_SIZE + PAYLOAD_BYTES));
+    result.push_back('U');
+    result.push_back('T');
+    result.push_back(FORMAT_VERSION);
+    result.push_back(static_cast<uint8_t>(PAYLOAD_BYTES));
+    result.push_back(static_cast<uint8_t>(this->count_ >> 8));
+    result.push_back(static_cast<uint8_t>(this->count_));
+    this->for_each([&result](const Entry& entry) {
+      result.push_back(static_cast<uint8_t>(entry.timestamp_ms >> 24));
+      result.push_back(static_cast<uint8_t>(entry.timestamp_ms >> 16));
+      result.push_back(static_cast<uint8_t>(entry.timestamp_ms >> 8));
+      result.push_back(static_cast<uint8_t>(entry.timestamp_ms));
+      result.push_back(static_cast<uint8_t>(entry.direction));
+      result.push_back(entry.command);
+      result.push_back(static_cast<uint8_t>(entry.length >> 8));
+      result.push_back(static_cast<uint8_t>(entry.length));
+      result.insert(result.end(), entry.payload.begin(), entry.payload.begin() + entry.stored_bytes());
+    });
+    return result;
+  }
+
+  static std::string entry_to_string(const Entry& entry)
+  {
+    return str_sprintf("%10u %s CMD=0x%02X LEN=%u DATA=[%s]%s",
+                       entry.timestamp_ms,
+                       (entry.direction == FrameDirection::RX)? "RX" : "TX",
+                       entry.command,
+                       entry.length,
+                       format_hex_pretty(entry.payload.data(), entry.stored_bytes()).c_str(),
+                       (entry.length > PAYLOAD_BYTES)? "..." : "");
+  }
+
+private:
+  std::array<Entry, SIZE> entries_{};
+  std::size_t next_{0u};
+  std::size_t count_{0u};
+  uint32_t total_recorded_{0u};
+};
+
+}
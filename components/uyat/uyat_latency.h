@@ -0,0 +1,155 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "uyat_platform.h"
+
+#include "uyat_timing_histogram.h"
+
+namespace esphome::uyat
+{
+
+// End-to-end latencies (in us) as seen by the user:
+//  - RX_TO_DISPATCH: first byte of a datapoint report received -> all its listeners done
+//  - SET_TO_TX: set_datapoint_value() called -> the command handed over to the uart
+//  - TX_TO_REPORT: datapoint command sent -> the MCU reports that datapoint back
+class UyatLatencyTracker
+{
+public:
+  enum class Interval : uint8_t
+  {
+    RX_TO_DISPATCH,
+    SET_TO_TX,
+    TX_TO_REPORT,
+    NUM_INTERVALS,
+  };
+
+  static constexpr const char* interval_name(const Interval interval)
+  {
+    switch (interval)
+    {
+      case Interval::RX_TO_DISPATCH:
+        return "rx_to_dispatch";
+      case Interval::SET_TO_TX:
+        return "set_to_tx";
+      case Interval::TX_TO_REPORT:
+        return "tx_to_report";
+      default:
+        return "unknown";
+    }
+  }
+
+  // Called for every byte pushed to the rx buffer.
+  void on_rx_byte(const bool starts_frame, const uint32_t now_us)
+  {
+    if (starts_frame)
+    {
+      this->frame_start_us_ = now_us;
+    }
+    this->last_rx_us_ = now_us;
+  }
+
+  // Bytes were removed from the rx buffer, the ones left (if any) belong to the next frame,
+  // which already started to arrive - the best estimate of its start is the last read.
+  void on_rx_consumed(const bool more_data)
+  {
+    if (more_data)
+    {
+      this->frame_start_us_ = this->last_rx_us_;
+    }
+  }
+
+  void on_datapoints_dispatched(const uint32_t now_us)
+  {
+    this->add_(Interval::RX_TO_DISPATCH, now_us - this->frame_start_us_);
+  }
+
+  void on_datapoint_written(const uint8_t dp_number, const uint32_t set_us, const uint32_t now_us)
+  {
+    this->add_(Interval::SET_TO_TX, now_us - set_us);
+
+    *this->slot_for_(dp_number, now_us) = PendingReport{.active = true, .dp_number = dp_number, .sent_us = now_us};
+  }
+
+  void on_datapoint_reported(const uint8_t dp_number, const uint32_t now_us)
+  {
+    for (auto& pending : this->pending_)
+    {
+      if (pending.active && (pending.dp_number == dp_number))
+      {
+        this->add_(Interval::TX_TO_REPORT, now_us - pending.sent_us);
+        pending.active = false;
+        return;
+      }
+    }
+  }
+
+  const TimingHistogram& get(const Interval interval) const
+  {
+    return this->histograms_[static_cast<std::size_t>(interval)];
+  }
+
+  // bumped on every new sample, lets the publisher skip unchanged histograms
+  uint32_t get_generation() const
+  {
+    return this->generation_;
+  }
+
+  static std::string histogram_to_string(const TimingHistogram& histogram)
+  {
+    return str_sprintf("n=%u p50=%uus p95=%uus max=%uus", histogram.count(), histogram.percentile_us(50u),
+                       histogram.percentile_us(95u), histogram.max_us());
+  }
+
+private:
+  static constexpr std::size_t MAX_PENDING_REPORTS = 8u;
+
+  struct PendingReport
+  {
+    bool active;
+    uint8_t dp_number;
+    uint32_t sent_us;
+  };
+
+  // the slot already waiting for the datapoint, a free one or the oldest one, in this order
+  PendingReport* slot_for_(const uint8_t dp_number, const uint32_t now_us)
+  {
+    for (auto& pending : this->pending_)
+    {
+      if (pending.active && (pending.dp_number == dp_number))
+      {
+        return &pending;
+      }
+    }
+
+    PendingReport* oldest = &this->pending_[0];
+    for (auto& pending : this->pending_)
+    {
+      if (!pending.active)
+      {
+        return &pending;
+      }
+      if ((now_us - pending.sent_us) > (now_us - oldest->sent_us))
+      {
+        oldest = &pending;
+      }
+    }
+    return oldest;
+  }
+
+  void add_(const Interval interval, const uint32_t duration_us)
+  {
+    this->histograms_[static_cast<std::size_t>(interval)].add(duration_us);
+    ++this->generation_;
+  }
+
+  std::array<TimingHistogram, static_cast<std::size_t>(Interval::NUM_INTERVALS)> histograms_{};
+  std::array<PendingReport, MAX_PENDING_REPORTS> pending_{};
+  uint32_t frame_start_us_{0u};
+  uint32_t last_rx_us_{0u};
+  uint32_t generation_{0u};
+};
+
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "uyat_platform.h"
+
+#if defined(USE_LOGGER) && !defined(UYAT_STANDALONE)
+#include "esphome/components/logger/logger.h"
+#endif
+
+namespace esphome::uyat
+{
+
+// True if a message of the given level for the tag would be printed - either compiled out
+// (ESPHOME_LOG_LEVEL) or filtered by the logger at runtime (per-tag levels included).
+// Lets the callers skip formatting of expensive arguments, eg:
+//   if (log_enabled(ESPHOME_LOG_LEVEL_DEBUG, TAG)) { ... ESP_LOGD(TAG, ...); }
+inline bool log_enabled(const int level, const char* tag)
+{
+  if (level > ESPHOME_LOG_LEVEL)
+  {
+    return false;
+  }
+#if defined(UYAT_STANDALONE)
+  (void) tag;
+  return level <= host::get_log_level();
+#elif defined(USE_LOGGER)
+  const auto* logger = logger::global_logger;
+  return (logger != nullptr) && (level <= logger->level_for(tag));
+#else
+  (void) tag;
+  return false;
+#endif
+}
+
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "uyat_delegate.h"
+
+namespace esphome::uyat
+{
+
+// Heap bytes owned by the containers, based on their capacity. Allocator overhead is not included.
+
+template<typename T>
+std::size_t heap_bytes(const std::vector<T>& container)
+{
+  return container.capacity() * sizeof(T);
+}
+
+inline std::size_t heap_bytes(const std::string& text)
+{
+  // short strings are stored inline (SSO), without any heap block
+  const auto* data = reinterpret_cast<const uint8_t*>(text.data());
+  const auto* object = reinterpret_cast<const uint8_t*>(&text);
+  if ((data >= object) && (data < (object + sizeof(text))))
+  {
+    return 0u;
+  }
+  return text.capacity() + 1u;
+}
+
+// An estimate for the libstdc++ layout: 512 byte chunks plus the map of chunk pointers (initially 8).
+template<typename T>
+std::size_t heap_bytes(const std::deque<T>& container)
+{
+  constexpr std::size_t CHUNK_BYTES = std::max<std::size_t>(512u, sizeof(T));
+  constexpr std::size_t PER_CHUNK = CHUNK_BYTES / sizeof(T);
+  const std::size_t chunks = (container.size() / PER_CHUNK) + 1u;
+  return (chunks * CHUNK_BYTES) + (std::max<std::size_t>(8u, chunks + 2u) * sizeof(void*));
+}
+
+// Bytes held by the uyat subsystems and the datapoint entities, with their peaks since boot.
+class UyatMemoryStats
+{
+public:
+  enum class Account : uint8_t
+  {
+    LISTENERS,
+    CACHED_DATAPOINTS,
+    RX_BUFFER,
+    COMMAND_QUEUE,
+    DIAGNOSTICS,
+    ENTITIES,
+    NUM_ACCOUNTS,
+  };
+
+  static constexpr const char* account_name(const Account account)
+  {
+    switch (account)
+    {
+      case Account::LISTENERS:
+        return "listeners";
+      case Account::CACHED_DATAPOINTS:
+        return "cached_datapoints";
+      case Account::RX_BUFFER:
+        return "rx_buffer";
+      case Account::COMMAND_QUEUE:
+        return "command_queue";
+      case Account::DIAGNOSTICS:
+        return "diagnostics";
+      case Account::ENTITIES:
+        return "entities";
+      default:
+        return "unknown";
+    }
+  }
+
+  struct Usage
+  {
+    uint32_t current;
+    uint32_t peak;
+  };
+
+  using UsageCallback = Delegate<std::size_t()>;
+
+  struct Entity
+  {
+    const char* tag;
+    uint8_t dp_number;
+    UsageCallback usage;
+    Usage bytes;
+  };
+
+  void update(const Account account, const std::size_t bytes)
+  {
+    update_usage_(this->accounts_[static_cast<std::size_t>(account)], bytes);
+
+    std::size_t total = 0u;
+    for (const auto& usage : this->accounts_)
+    {
+      total += usage.current;
+    }
+    update_usage_(this->total_, total);
+  }
+
+  void add_entity(const char* tag, const uint8_t dp_number, const UsageCallback& usage)
+  {
+    this->entities_.push_back(Entity{tag, dp_number, usage, Usage{0u, 0u}});
+  }
+
+  // asks all the entities for their current usage
+  void update_entities()
+  {
+    std::size_t total = 0u;
+    for (auto& entity : this->entities_)
+    {
+      update_usage_(entity.bytes, entity.usage());
+      total += entity.bytes.current;
+    }
+    this->update(Account::ENTITIES, total);
+  }
+
+  const Usage& get(const Account account) const
+  {
+    return this->accounts_[static_cast<std::size_t>(account)];
+  }
+
+  // peak of the sum, not the sum of the peaks
+  const Usage& get_total() const
+  {
+    return this->total_;
+  }
+
+  // visits the entities in the order they were registered
+  template<typename F>
+  void for_each_entity(F&& func) const
+  {
+    for (const auto& entity : this->entities_)
+    {
+      func(entity);
+    }
+  }
+
+  // own heap usage, to be accounted as diagnostics
+  std::size_t heap_bytes() const
+  {
+    return uyat::heap_bytes(this->entities_);
+  }
+
+  // "account:current/peak" pairs followed by the total, eg. "listeners:96/96 ... total:1024/1536"
+  void format_into(std::string& buffer) const
+  {
+    buffer.clear();
+    char item[48];
+    for (std::size_t i = 0u; i < this->accounts_.size(); ++i)
+    {
+      snprintf(item, sizeof(item), "%s:%" PRIu32 "/%" PRIu32 " ", account_name(static_cast<Account>(i)),
+               this->accounts_[i].current, this->accounts_[i].peak);
+      buffer += item;
+    }
+    snprintf(item, sizeof(item), "total:%" PRIu32 "/%" PRIu32, this->total_.current, this->total_.peak);
+    buffer += item;
+  }
+
+private:
+  static void update_usage_(Usage& usage, const std::size_t bytes)
+  {
+    usage.current = static_cast<uint32_t>(bytes);
+    usage.peak = std::max(usage.peak, usage.current);
+  }
+
+  std::array<Usage, static_cast<std::size_t>(Account::NUM_ACCOUNTS)> accounts_{};
+  Usage total_{0u, 0u};
+  std::vector<Entity> entities_;
+};
+
+}
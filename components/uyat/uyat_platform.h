@@ -0,0 +1,11 @@
+#pragma once
+
+// The helpers and logging macros of esphome used by the protocol core. The standalone host build
+// (UYAT_STANDALONE, see CMakeLists.txt in the repository root) provides them without esphome.
+#ifdef UYAT_STANDALONE
+#include "uyat_standalone.h"
+#else
+#include "esphome/core/defines.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+#endif
@@ -0,0 +1,32 @@
+#pragma once
+
+// Static tracepoints (USDT) on the protocol hot path, for perf and bpftrace on the host builds:
+//
+//   provider uyat, probe               arguments
+//   frame_received                     command, frame size
+//   checksum_error                     received checksum, calculated checksum
+//   command_sent                       command, frame size
+//   response_matched                   command of the response, ms since the command was sent
+//   response_timeout                   expected command, 1 when the command is retried
+//   datapoint_dispatched               datapoint number, datapoint type, 1 when a listener handled it
+//   queue_enqueue                      command, queue size after the push
+//   queue_dequeue                      command, queue size after the pop
+//
+// Only with UYAT_PROBES_ENABLED, defined by the host build, and <sys/sdt.h> (systemtap-sdt-dev) available;
+// otherwise, and always on the devices, UYAT_PROBE() compiles to nothing. A probe nobody attached to costs
+// a nop and the evaluation of its arguments, all of them cheap.
+
+#if defined(UYAT_PROBES_ENABLED) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define UYAT_PROBES_AVAILABLE
+#endif
+#endif
+
+#ifdef UYAT_PROBES_AVAILABLE
+#define UYAT_PROBE(name, ...) STAP_PROBEV(uyat, name, ##__VA_ARGS__)
+#else
+#define UYAT_PROBE(name, ...) \
+  do { \
+  } while (false)
+#endif
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+#include "uyat_delegate.h"
+#include "uyat_timing_histogram.h"
+
+namespace esphome::uyat
+{
+
+// Timing of the phases of UyatCore::poll(), collected over a reporting window.
+class UyatProfiler
+{
+public:
+  enum class Phase : uint8_t
+  {
+    LOOP,             // the whole UyatCore::poll()
+    UART_DRAIN,
+    INPUT_BUFFER,     // includes the command handling below
+    COMMAND,
+    LISTENER,
+    COMMAND_QUEUE,
+    NUM_PHASES,
+  };
+
+  static constexpr const char* phase_name(const Phase phase)
+  {
+    switch (phase)
+    {
+      case Phase::LOOP:
+        return "loop";
+      case Phase::UART_DRAIN:
+        return "uart_drain";
+      case Phase::INPUT_BUFFER:
+        return "input_buffer";
+      case Phase::COMMAND:
+        return "command";
+      case Phase::LISTENER:
+        return "listener";
+      case Phase::COMMAND_QUEUE:
+        return "command_queue";
+      default:
+        return "unknown";
+    }
+  }
+
+  struct SlowestListener
+  {
+    uint8_t dp_number;
+    uint32_t duration_us;
+  };
+
+  // returns the current time in us
+  using ClockFunc = Delegate<uint32_t()>;
+
+  // Measures the lifetime of the object as the given phase.
+  class ScopedTimer
+  {
+  public:
+    ScopedTimer(UyatProfiler& profiler, const Phase phase, const ClockFunc& clock):
+    profiler_(profiler),
+    phase_(phase),
+    clock_(clock),
+    start_us_(clock())
+    {}
+
+    ~ScopedTimer()
+    {
+      this->profiler_.record(this->phase_, this->clock_() - this->start_us_);
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+  private:
+    UyatProfiler& profiler_;
+    const Phase phase_;
+    const ClockFunc& clock_;
+    const uint32_t start_us_;
+  };
+
+  void set_slow_listener_threshold_us(const uint32_t threshold_us)
+  {
+    this->slow_listener_threshold_us_ = threshold_us;
+  }
+
+  uint32_t get_slow_listener_threshold_us() const
+  {
+    return this->slow_listener_threshold_us_;
+  }
+
+  void record(const Phase phase, const uint32_t duration_us)
+  {
+    this->phases_[static_cast<std::size_t>(phase)].add(duration_us);
+  }
+
+  // Returns true if the listener exceeded the slow listener threshold.
+  bool record_listener(const uint8_t dp_number, const uint32_t duration_us)
+  {
+    this->record(Phase::LISTENER, duration_us);
+    if (!this->slowest_listener_.has_value() || (this->slowest_listener_->duration_us < duration_us))
+    {
+      this->slowest_listener_ = SlowestListener{dp_number, duration_us};
+    }
+    return (this->slow_listener_threshold_us_ > 0u) && (duration_us > this->slow_listener_threshold_us_);
+  }
+
+  const TimingHistogram& get_phase(const Phase phase) const
+  {
+    return this->phases_[static_cast<std::size_t>(phase)];
+  }
+
+  const std::optional<SlowestListener>& get_slowest_listener() const
+  {
+    return this->slowest_listener_;
+  }
+
+  // starts a new reporting window
+  void reset_window()
+  {
+    for (auto& histogram : this->phases_)
+    {
+      histogram.reset();
+    }
+    this->slowest_listener_.reset();
+  }
+
+private:
+  std::array<TimingHistogram, static_cast<std::size_t>(Phase::NUM_PHASES)> phases_{};
+  std::optional<SlowestListener> slowest_listener_{};
+  uint32_t slow_listener_threshold_us_{0u};
+};
+
+}
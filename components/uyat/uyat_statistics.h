@@ -0,0 +1,204 @@
+#pragma once
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "uyat_platform.h"
+
+namespace esphome::uyat
+{
+
+// Protocol traffic counters. Kept free of any esphome entity code, so they can
+// be collected regardless of which of them are published as sensors.
+class UyatStatistics
+{
+public:
+  // The uart needs 10 bits on the wire for each byte (start bit + 8 data bits + stop bit).
+  static constexpr uint32_t BITS_PER_BYTE = 10u;
+
+  struct CommandCounters
+  {
+    uint8_t command;
+    uint32_t received;
+    uint32_t sent;
+    uint32_t received_bytes;
+    uint32_t sent_bytes;
+  };
+
+  void on_frame_received(const uint8_t command, const std::size_t frame_size)
+  {
+    ++this->frames_received_;
+    auto& slot = this->slot_for_(command);
+    ++slot.received;
+    slot.received_bytes += frame_size;
+  }
+
+  void on_frame_sent(const uint8_t command, const std::size_t frame_size)
+  {
+    ++this->frames_sent_;
+    auto& slot = this->slot_for_(command);
+    ++slot.sent;
+    slot.sent_bytes += frame_size;
+    this->bytes_sent_ += frame_size;
+  }
+
+  void on_bytes_received(const std::size_t count)
+  {
+    this->bytes_received_ += count;
+  }
+
+  void on_checksum_error()
+  {
+    ++this->checksum_errors_;
+  }
+
+  // retried - the command stays queued and will be sent again, otherwise it is dropped
+  void on_response_timeout(const bool retried)
+  {
+    ++this->response_timeouts_;
+    if (retried)
+    {
+      ++this->retries_;
+    }
+    else
+    {
+      ++this->dropped_commands_;
+    }
+  }
+
+  void on_queue_depth(const std::size_t depth)
+  {
+    this->queue_high_water_mark_ = std::max<uint32_t>(this->queue_high_water_mark_, depth);
+  }
+
+  // Recalculates the byte rates from the traffic seen since the previous call.
+  void update_rates(const uint32_t now_ms)
+  {
+    const uint32_t elapsed_ms = now_ms - this->last_rate_update_ms_;
+    if (elapsed_ms == 0u)
+    {
+      return;
+    }
+
+    this->rx_bytes_per_second_ = (this->bytes_received_ - this->last_bytes_received_) * 1000.0f / elapsed_ms;
+    this->tx_bytes_per_second_ = (this->bytes_sent_ - this->last_bytes_sent_) * 1000.0f / elapsed_ms;
+    this->last_bytes_received_ = this->bytes_received_;
+    this->last_bytes_sent_ = this->bytes_sent_;
+    this->last_rate_update_ms_ = now_ms;
+  }
+
+  // Average size of the frames of the given command, or default_size if none was seen yet.
+  std::size_t get_average_frame_size(const uint8_t command, const bool sent, const std::size_t default_size) const
+  {
+    for (const auto& slot : this->commands_)
+    {
+      if (slot.command != command)
+      {
+        continue;
+      }
+      const auto frames = sent? slot.sent : slot.received;
+      if (frames == 0u)
+      {
+        break;
+      }
+      return (sent? slot.sent_bytes : slot.received_bytes) / frames;
+    }
+    return default_size;
+  }
+
+  // Share of the line capacity used by the traffic, in %.
+  static float utilisation_percent(const float bytes_per_second, const uint32_t baud_rate)
+  {
+    if (baud_rate == 0u)
+    {
+      return 0.0f;
+    }
+    return bytes_per_second * BITS_PER_BYTE * 100.0f / baud_rate;
+  }
+
+  // How many more datapoint writes per second fit on the line, on top of the current traffic.
+  // Each write takes write_size bytes of TX and is answered by a report of report_size bytes on RX.
+  float get_datapoint_write_headroom(const uint32_t baud_rate, const std::size_t write_size,
+                                     const std::size_t report_size) const
+  {
+    const float capacity = static_cast<float>(baud_rate) / BITS_PER_BYTE;
+    const float tx_writes = std::max(0.0f, capacity - this->tx_bytes_per_second_) / std::max<std::size_t>(write_size, 1u);
+    const float rx_writes = std::max(0.0f, capacity - this->rx_bytes_per_second_) / std::max<std::size_t>(report_size, 1u);
+    return std::min(tx_writes, rx_writes);
+  }
+
+  // "CMD:received/sent" pairs, eg. "00:12/12 07:40/0"
+  void format_commands_into(std::string& buffer) const
+  {
+    buffer.clear();
+    char item[24];
+    for (const auto& slot : this->commands_)
+    {
+      if (!buffer.empty())
+      {
+        buffer += ' ';
+      }
+      snprintf(item, sizeof(item), "%02X:%" PRIu32 "/%" PRIu32, slot.command, slot.received, slot.sent);
+      buffer += item;
+    }
+  }
+
+  std::string commands_to_string() const
+  {
+    std::string result;
+    this->format_commands_into(result);
+    return result;
+  }
+
+  const std::vector<CommandCounters>& get_command_counters() const { return this->commands_; }
+  uint32_t get_frames_received() const { return this->frames_received_; }
+  uint32_t get_frames_sent() const { return this->frames_sent_; }
+  uint32_t get_checksum_errors() const { return this->checksum_errors_; }
+  uint32_t get_response_timeouts() const { return this->response_timeouts_; }
+  uint32_t get_retries() const { return this->retries_; }
+  uint32_t get_dropped_commands() const { return this->dropped_commands_; }
+  uint32_t get_queue_high_water_mark() const { return this->queue_high_water_mark_; }
+  uint64_t get_bytes_received() const { return this->bytes_received_; }
+  uint64_t get_bytes_sent() const { return this->bytes_sent_; }
+  float get_rx_bytes_per_second() const { return this->rx_bytes_per_second_; }
+  float get_tx_bytes_per_second() const { return this->tx_bytes_per_second_; }
+
+private:
+  CommandCounters& slot_for_(const uint8_t command)
+  {
+    // a device uses a handful of command types, a linear scan over a flat table is the cheapest option
+    for (auto& slot : this->commands_)
+    {
+      if (slot.command == command)
+      {
+        return slot;
+      }
+    }
+
+    const auto position = std::lower_bound(this->commands_.begin(), this->commands_.end(), command,
+                                           [](const CommandCounters& slot, const uint8_t cmd) { return slot.command < cmd; });
+    return *this->commands_.insert(position, CommandCounters{command, 0u, 0u, 0u, 0u});
+  }
+
+  std::vector<CommandCounters> commands_;
+  uint32_t frames_received_{0u};
+  uint32_t frames_sent_{0u};
+  uint32_t checksum_errors_{0u};
+  uint32_t response_timeouts_{0u};
+  uint32_t retries_{0u};
+  uint32_t dropped_commands_{0u};
+  uint32_t queue_high_water_mark_{0u};
+  uint64_t bytes_received_{0u};
+  uint64_t bytes_sent_{0u};
+  uint64_t last_bytes_received_{0u};
+  uint64_t last_bytes_sent_{0u};
+  uint32_t last_rate_update_ms_{0u};
+  float rx_bytes_per_second_{0.0f};
+  float tx_bytes_per_second_{0.0f};
+};
+
+}
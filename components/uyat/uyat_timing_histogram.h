@@ -0,0 +1,83 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "uyat_platform.h"
+
+namespace esphome::uyat
+{
+
+// Histogram of durations (in us) with power of 2 buckets: bucket N holds values of bit width N.
+// Gives exact min/avg/max and an upper bound of the percentiles, using a fixed number of counters.
+class TimingHistogram
+{
+public:
+  void add(const uint32_t duration_us)
+  {
+    ++this->buckets_[bucket_of_(duration_us)];
+    ++this->count_;
+    this->sum_us_ += duration_us;
+    this->min_us_ = std::min(this->min_us_, duration_us);
+    this->max_us_ = std::max(this->max_us_, duration_us);
+  }
+
+  void reset()
+  {
+    *this = TimingHistogram{};
+  }
+
+  uint32_t count() const { return this->count_; }
+  uint32_t min_us() const { return (this->count_ > 0u)? this->min_us_ : 0u; }
+  uint32_t max_us() const { return this->max_us_; }
+  uint32_t avg_us() const { return (this->count_ > 0u)? static_cast<uint32_t>(this->sum_us_ / this->count_) : 0u; }
+
+  // upper bound of the given percentile (0-100), never more than the max seen
+  uint32_t percentile_us(const uint8_t percent) const
+  {
+    if (this->count_ == 0u)
+    {
+      return 0u;
+    }
+
+    const uint64_t rank = (static_cast<uint64_t>(this->count_) * percent + 99u) / 100u;
+    uint64_t seen = 0u;
+    for (std::size_t bucket = 0u; bucket < this->buckets_.size(); ++bucket)
+    {
+      seen += this->buckets_[bucket];
+      if (seen >= rank)
+      {
+        const auto bucket_max = static_cast<uint32_t>((1ull << bucket) - 1u);
+        return std::min(bucket_max, this->max_us_);
+      }
+    }
+    return this->max_us_;
+  }
+
+  std::string to_string() const
+  {
+    return str_sprintf("n=%u min=%uus avg=%uus max=%uus p99=%uus",
+                       this->count(), this->min_us(), this->avg_us(), this->max_us(), this->percentile_us(99u));
+  }
+
+private:
+  static std::size_t bucket_of_(const uint32_t value)
+  {
+    std::size_t width = 0u;
+    for (uint32_t rest = value; rest != 0u; rest >>= 1u)
+    {
+      ++width;
+    }
+    return width;
+  }
+
+  std::array<uint32_t, 33u> buckets_{};
+  uint32_t count_{0u};
+  uint64_t sum_us_{0u};
+  uint32_t min_us_{UINT32_MAX};
+  uint32_t max_us_{0u};
+};
+
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome::uyat
+{
+
+// Observer of the timeline of the protocol core, set by UyatCore::set_trace_events(). Only compiled in with
+// UYAT_TRACE_EVENTS_ENABLED, which is defined by the host build - host::ChromeTraceWriter turns the events
+// into a trace_event JSON file. All times are in us of the core clock.
+class UyatTraceEvents
+{
+public:
+  virtual ~UyatTraceEvents() = default;
+
+  // a valid frame from the MCU, from its first byte read to the end of its handling
+  virtual void on_rx_frame(uint8_t command, std::size_t size, uint32_t first_byte_us, uint32_t handled_us) = 0;
+  // one listener of a reported datapoint, the index is the order of the registration
+  virtual void on_dispatch(uint8_t dp_number, std::size_t listener, uint32_t start_us, uint32_t end_us) = 0;
+  // a frame written to the transport
+  virtual void on_tx_frame(uint8_t command, std::size_t size, uint32_t start_us, uint32_t end_us) = 0;
+  // a sent command waiting for its response, till it came or timed out
+  virtual void on_response_wait(uint8_t command, uint32_t sent_us, uint32_t end_us, bool answered) = 0;
+};
+
+}
@@ -0,0 +1,501 @@
+// Microbenchmarks of the hot paths of the protocol core and the datapoint entities.
+//
+// Time is reported per operation by Google Benchmark, the allocs/op counter is the number of heap
+// allocations per operation, counted by the replaced global operator new of this binary.
+// Build in Release, eg. cmake -DCMAKE_BUILD_TYPE=Release, and compare runs with the same feature options.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "dp_color.h"
+#include "dp_text.h"
+#include "uyat_core.h"
+#include "uyat_host_platform.h"
+
+namespace
+{
+
+uint64_t allocations = 0u;
+
+}
+
+void* operator new(std::size_t size)
+{
+  ++allocations;
+  if (void* ptr = std::malloc((size > 0u) ? size : 1u))
+  {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+namespace esphome::uyat::bench
+{
+
+// counts the allocations of the measured loop and reports them per iteration
+class AllocationCounter
+{
+public:
+  explicit AllocationCounter(benchmark::State& state):
+  state_(state),
+  start_(allocations)
+  {}
+
+  ~AllocationCounter()
+  {
+    this->state_.counters["allocs/op"] =
+        benchmark::Counter(static_cast<double>(allocations - this->start_), benchmark::Counter::kAvgIterations);
+  }
+
+private:
+  benchmark::State& state_;
+  const uint64_t start_;
+};
+
+class NullTransport : public UyatTransport
+{
+public:
+  std::size_t rx_available() override
+  {
+    return 0u;
+  }
+
+  bool rx_read(uint8_t&) override
+  {
+    return false;
+  }
+
+  void tx_write(const uint8_t*, std::size_t) override
+  {}
+};
+
+class CountingClock : public UyatClock
+{
+public:
+  uint32_t get_millis() override
+  {
+    return this->micros_ / 1000u;
+  }
+
+  uint32_t get_micros() override
+  {
+    return ++this->micros_;
+  }
+
+private:
+  uint32_t micros_{0};
+};
+
+class NullScheduler : public UyatScheduler
+{
+public:
+  void start_timer(const char*, uint32_t, bool, TimerCallback&&) override
+  {}
+
+  void stop_timer(const char*) override
+  {}
+};
+
+// Core past the init sequence, with access to the input path without the transport
+class BenchCore : public host::InitStateCore
+{
+public:
+  BenchCore():
+  InitStateCore(null_transport_, bench_clock_, null_scheduler_)
+  {
+    this->set_init_state(UyatInitState::INIT_DONE);
+  }
+
+  void feed(const std::vector<uint8_t>& bytes)
+  {
+    this->rx_message_.insert(this->rx_message_.end(), bytes.begin(), bytes.end());
+    this->handle_input_buffer_();
+  }
+
+  std::size_t validate(const std::vector<uint8_t>& bytes)
+  {
+    this->rx_message_.assign(bytes.begin(), bytes.end());
+    return this->validate_message_();
+  }
+
+  void dispatch(const std::deque<uint8_t>& datapoints)
+  {
+    this->handle_datapoints_frame_(datapoints, 0u, datapoints.size());
+  }
+
+private:
+  // static, so that they exist before the UyatCore base is constructed
+  static NullTransport null_transport_;
+  static CountingClock bench_clock_;
+  static NullScheduler null_scheduler_;
+};
+
+NullTransport BenchCore::null_transport_;
+CountingClock BenchCore::bench_clock_;
+NullScheduler BenchCore::null_scheduler_;
+
+// Stores the single listener of an entity, the values set by the entity are dropped
+class BenchHandler : public DatapointHandler
+{
+public:
+  void register_datapoint_listener(const MatchingDatapoint&, const OnDatapointCallback& callback) override
+  {
+    this->listener_ = callback;
+  }
+
+  void set_datapoint_value(const UyatDatapoint& dp, const bool) override
+  {
+    benchmark::DoNotOptimize(dp);
+  }
+
+  void deliver(const UyatDatapoint& dp)
+  {
+    this->listener_(dp);
+  }
+
+private:
+  OnDatapointCallback listener_;
+};
+
+std::vector<uint8_t> datapoint_bytes(const UyatDatapoint& datapoint)
+{
+  const auto value = datapoint.value_to_payload();
+  std::vector<uint8_t> bytes{datapoint.number, static_cast<uint8_t>(datapoint.get_type()),
+                             static_cast<uint8_t>(value.size() >> 8), static_cast<uint8_t>(value.size())};
+  bytes.insert(bytes.end(), value.begin(), value.end());
+  return bytes;
+}
+
+std::vector<uint8_t> frame_bytes(const uint8_t command, const std::vector<uint8_t>& payload)
+{
+  std::vector<uint8_t> frame{0x55, 0xAA, 0x03, command, static_cast<uint8_t>(payload.size() >> 8),
+                             static_cast<uint8_t>(payload.size())};
+  frame.insert(frame.end(), payload.begin(), payload.end());
+  uint8_t checksum = 0u;
+  for (const auto byte : frame)
+  {
+    checksum += byte;
+  }
+  frame.push_back(checksum);
+  return frame;
+}
+
+const std::vector<UyatDatapoint>& sample_datapoints()
+{
+  // one of each type, sized like the datapoints of real devices
+  static const std::vector<UyatDatapoint> datapoints{
+      UyatDatapoint{1, RawDatapointValue{{0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C}}},
+      UyatDatapoint{2, BoolDatapointValue{true}},
+      UyatDatapoint{3, UIntDatapointValue{2150}},
+      UyatDatapoint{4, StringDatapointValue{"000003e803e8"}},
+      UyatDatapoint{5, EnumDatapointValue{2}},
+      UyatDatapoint{6, BitmapDatapointValue{0x0104}},
+  };
+  return datapoints;
+}
+
+enum StreamKind : int64_t
+{
+  STREAM_SINGLE_REPORTS,  // one datapoint per frame, like a periodic power metering update
+  STREAM_FULL_REPORT,     // all datapoints in one frame, like the answer to DATAPOINT_QUERY
+  STREAM_NOISY,           // single reports with line noise in between
+};
+
+std::vector<uint8_t> make_stream(const StreamKind kind)
+{
+  std::vector<uint8_t> stream;
+  std::vector<uint8_t> all;
+  for (const auto& datapoint : sample_datapoints())
+  {
+    const auto bytes = datapoint_bytes(datapoint);
+    if (kind == STREAM_FULL_REPORT)
+    {
+      all.insert(all.end(), bytes.begin(), bytes.end());
+      continue;
+    }
+    if (kind == STREAM_NOISY)
+    {
+      stream.insert(stream.end(), {0x00, 0x55, 0xFF});
+    }
+    const auto frame = frame_bytes(0x07, bytes);
+    stream.insert(stream.end(), frame.begin(), frame.end());
+  }
+  if (kind == STREAM_FULL_REPORT)
+  {
+    stream = frame_bytes(0x07, all);
+  }
+  return stream;
+}
+
+void BM_HandleInputBuffer(benchmark::State& state)
+{
+  BenchCore core;
+  const auto stream = make_stream(static_cast<StreamKind>(state.range(0)));
+  // the cached datapoints reach their final size
+  core.feed(stream);
+  {
+    AllocationCounter counter(state);
+    for (auto _ : state)
+    {
+      core.feed(stream);
+    }
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * stream.size()));
+}
+BENCHMARK(BM_HandleInputBuffer)
+    ->ArgName("stream")
+    ->Arg(STREAM_SINGLE_REPORTS)
+    ->Arg(STREAM_FULL_REPORT)
+    ->Arg(STREAM_NOISY);
+
+// a frame still being received, the check done for every byte read until the frame is complete
+void BM_ValidateMessagePartial(benchmark::State& state)
+{
+  BenchCore core;
+  auto frame = make_stream(STREAM_FULL_REPORT);
+  frame.resize(frame.size() / 2u);
+  AllocationCounter counter(state);
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(core.validate(frame));
+  }
+}
+BENCHMARK(BM_ValidateMessagePartial);
+
+void BM_DatapointConstruct(benchmark::State& state)
+{
+  const auto& datapoint = sample_datapoints().at(static_cast<std::size_t>(state.range(0)));
+  state.SetLabel(datapoint.get_type_name());
+  const auto bytes = datapoint_bytes(datapoint);
+  const std::deque<uint8_t> buffer(bytes.begin(), bytes.end());
+  AllocationCounter counter(state);
+  for (auto _ : state)
+  {
+    std::size_t used_len = 0u;
+    benchmark::DoNotOptimize(UyatDatapoint::construct(buffer, 0u, buffer.size(), used_len));
+  }
+}
+BENCHMARK(BM_DatapointConstruct)->ArgName("type")->DenseRange(0, 5);
+
+void BM_DatapointToPayload(benchmark::State& state)
+{
+  const auto& datapoint = sample_datapoints().at(static_cast<std::size_t>(state.range(0)));
+  state.SetLabel(datapoint.get_type_name());
+  AllocationCounter counter(state);
+  for (auto _ : state)
+  {
+    benchmark::DoNotOptimize(datapoint.value_to_payload());
+  }
+}
+BENCHMARK(BM_DatapointToPayload)->ArgName("type")->DenseRange(0, 5);
+
+void BM_DpColorEncode(benchmark::State& state)
+{
+  const auto color_type = static_cast<UyatColorType>(state.range(0));
+  state.SetLabel(DpColor::color_type_to_string(color_type));
+  BenchHandler handler;
+  DpColor color([](const DpColor::Value&) {}, MatchingDatapoint{.number = 4, .types = {UyatDatapointType::STRING}}, color_type);
+  color.init(handler);
+  const DpColor::Value value{1.0f, 0.5f, 0.25f};
+  AllocationCounter counter(state);
+  for (auto _ : state)
+  {
+    color.set_value(value);
+  }
+}
+BENCHMARK(BM_DpColorEncode)->ArgName("color_type")->DenseRange(0, 2);
+
+void BM_DpColorDecode(benchmark::State& state)
+{
+  const auto color_type = static_cast<UyatColorType>(state.range(0));
+  state.SetLabel(DpColor::color_type_to_string(color_type));
+  BenchHandler handler;
+  DpColor color([](const DpColor::Value& value) { benchmark::DoNotOptimize(value); },
+                MatchingDatapoint{.number = 4, .types = {UyatDatapointType::STRING}}, color_type);
+  color.init(handler);
+  static const char* const RAW_VALUES[] = {"ff8040", "0014038403e8", "ff8040001403e8"};
+  const UyatDatapoint datapoint{4, StringDatapointValue{RAW_VALUES[state.range(0)]}};
+  AllocationCounter counter(state);
+  for (auto _ : state)
+  {
+    handler.deliver(datapoint);
+  }
+}
+BENCHMARK(BM_DpColorDecode)->ArgName("color_type")->DenseRange(0, 2);
+
+void BM_DpTextEncode(benchmark::State& state)
+{
+  const auto encoding = static_cast<TextDataEncoding>(state.range(0));
+  state.SetLabel(TextDataEncoding2String(encoding));
+  BenchHandler handler;
+  DpText text([](const std::string&) {}, MatchingDatapoint{.number = 1, .types = {UyatDatapointType::RAW}}, encoding);
+  text.init(handler);
+  const std::string value = (encoding == TextDataEncoding::AS_HEX) ? "0102030405060708090a0b0c0d0e0f10" :
+                                                                     "The quick brown fox jumps over";
+  AllocationCounter counter(state);
+  for (auto _ : state)
+  {
+    text.set_value(value);
+  }
+}
+
+void BM_DpTextDecode(benchmark::State& state)
+{
+  const auto encoding = static_cast<TextDataEncoding>(state.range(0));
+  state.SetLabel(TextDataEncoding2String(encoding));
+  BenchHandler handler;
+  DpText text([](const std::string& value) { benchmark::DoNotOptimize(value); },
+              MatchingDatapoint{.number = 1, .types = {UyatDatapointType::RAW}}, encoding);
+  text.init(handler);
+  const std::string raw = (encoding == TextDataEncoding::AS_BASE64) ? "VGhlIHF1aWNrIGJyb3duIGZveCBqdW1wcyBvdmVy" :
+                                                                      "The quick brown fox jumps over";
+  const UyatDatapoint datapoint{1, RawDatapointValue{std::vector<uint8_t>(raw.begin(), raw.end())}};
+  AllocationCounter counter(state);
+  for (auto _ : state)
+  {
+    handler.deliver(datapoint);
+  }
+}
+
+void text_encodings(benchmark::internal::Benchmark* benchmark)
+{
+  benchmark->ArgName("encoding");
+  for (const auto encoding : {TextDataEncoding::PLAIN, TextDataEncoding::AS_HEX, TextDataEncoding::AS_BASE64})
+  {
+    benchmark->Arg(static_cast<int64_t>(encoding));
+  }
+}
+BENCHMARK(BM_DpTextEncode)->Apply(text_encodings);
+BENCHMARK(BM_DpTextDecode)->Apply(text_encodings);
+
+// one reported datapoint, dispatched among the listeners of as many entities
+void BM_ListenerDispatch(benchmark::State& state)
+{
+  BenchCore core;
+  const auto listeners = static_cast<uint8_t>(state.range(0));
+  for (uint8_t number = 1u; number <= listeners; ++number)
+  {
+    core.register_datapoint_listener(number, [](const UyatDatapoint& datapoint) { benchmark::DoNotOptimize(datapoint); });
+  }
+  const auto bytes = datapoint_bytes(UyatDatapoint{listeners, UIntDatapointValue{2150}});
+  const std::deque<uint8_t> buffer(bytes.begin(), bytes.end());
+  core.dispatch(buffer);
+  AllocationCounter counter(state);
+  for (auto _ : state)
+  {
+    core.dispatch(buffer);
+  }
+}
+BENCHMARK(BM_ListenerDispatch)->ArgName("listeners")->Arg(1)->Arg(10)->Arg(50);
+
+// restarting a timer and running the due ones, like the core does on each heartbeat answer,
+// among as many pending timers
+void BM_TimerQueue(benchmark::State& state)
+{
+  host::ManualClock clock;
+  host::TimerQueue timers{clock};
+  const auto count = static_cast<std::size_t>(state.range(0));
+  std::vector<std::string> names;
+  for (std::size_t i = 0u; i < count; ++i)
+  {
+    names.push_back("timer" + std::to_string(i));
+    timers.start_timer(names.back().c_str(), 1000u + static_cast<uint32_t>(i), false, [] {});
+  }
+  std::size_t next = 0u;
+  AllocationCounter counter(state);
+  for (auto _ : state)
+  {
+    clock.advance_ms(1u);
+    timers.start_timer(names[next].c_str(), 1000u, false, [] {});
+    benchmark::DoNotOptimize(timers.run_due());
+    next = (next + 1u) % count;
+  }
+}
+BENCHMARK(BM_TimerQueue)->ArgName("timers")->Arg(1)->Arg(8)->Arg(32);
+
+// The MCU side of BM_SimulatedHour, answers each heartbeat right away
+class HeartbeatMcu
+{
+public:
+  void receive(const uint8_t* data, const std::size_t len)
+  {
+    if ((len > 3u) && (data[3] == 0x00))
+    {
+      ++this->heartbeats;
+      this->transport.push(this->answer_);
+    }
+  }
+
+  host::QueueTransport transport{[this](const uint8_t* data, const std::size_t len) { this->receive(data, len); }};
+  uint32_t heartbeats{0};
+
+private:
+  // MCU already running
+  const std::vector<uint8_t> answer_{frame_bytes(0x00, {0x01})};
+};
+
+// An hour of heartbeats on a simulated clock: polled at the interval of the esphome loop while a heartbeat
+// is exchanged, the idle time in between skipped. sim_s/s is the simulated time per second of wall time.
+void BM_SimulatedHour(benchmark::State& state)
+{
+  static constexpr uint32_t HOUR_MS = 3600u * 1000u;
+  static constexpr uint32_t LOOP_INTERVAL_MS = 16u;
+  uint32_t heartbeats = 0u;
+  AllocationCounter counter(state);
+  for (auto _ : state)
+  {
+    host::ManualClock clock;
+    host::TimerQueue timers{clock};
+    HeartbeatMcu mcu;
+    host::InitStateCore core{mcu.transport, clock, timers};
+    core.set_init_state(UyatInitState::INIT_DONE);
+    core.start();
+    while (clock.get_millis() < HOUR_MS)
+    {
+      core.poll();
+      timers.run_due();
+      uint32_t next_in = LOOP_INTERVAL_MS;
+      if (core.is_idle() && mcu.transport.rx.empty())
+      {
+        next_in = std::max(timers.get_next_due_in_ms().value_or(HOUR_MS), 1u);
+      }
+      clock.advance_ms(next_in);
+    }
+    heartbeats = mcu.heartbeats;
+  }
+  state.counters["heartbeats"] = heartbeats;
+  state.counters["sim_s/s"] = benchmark::Counter(static_cast<double>(state.iterations()) * (HOUR_MS / 1000u),
+                                                 benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_SimulatedHour)->Unit(benchmark::kMillisecond);
+
+}
+
+int main(int argc, char** argv)
+{
+  esphome::uyat::host::set_log_level(ESPHOME_LOG_LEVEL_NONE);
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+  {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,605 @@
+// Protocol conformance of the core against the simulated MCU: the order of the exchanged frames and
+// their timing, on a simulated clock with the polls at the interval of the esphome loop.
+//
+// The timing budgets below are the ones the init and the responses are expected to keep, a change making
+// the core slower (or faster, which may break MCUs expecting the usual pace) fails here.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "uyat_core.h"
+#include "uyat_host_platform.h"
+#include "uyat_mcu_simulator.h"
+
+namespace esphome::uyat::conformance
+{
+
+// the esphome main loop
+static constexpr uint32_t LOOP_INTERVAL_MS = 16u;
+// the first heartbeat is sent 1 s after the start, then 15 s after each answer
+static constexpr uint32_t FIRST_HEARTBEAT_MS = 1000u;
+static constexpr uint32_t HEARTBEAT_PERIOD_MS = 15000u;
+// an unanswered command is sent again after this time
+static constexpr uint32_t RESPONSE_TIMEOUT_MS = 300u;
+// from the first heartbeat response to INIT_DONE, at 9600 baud with an MCU answering in 5 ms
+static constexpr uint32_t INIT_BUDGET_MS = 250u;
+// from a frame of the MCU to the response of the module
+static constexpr uint32_t RESPONSE_BUDGET_MS = 2u * LOOP_INTERVAL_MS + 20u;
+
+enum Command : uint8_t
+{
+  HEARTBEAT = 0x00,
+  PRODUCT_QUERY = 0x01,
+  CONF_QUERY = 0x02,
+  WIFI_STATE = 0x03,
+  WIFI_RESET = 0x04,
+  WIFI_SELECT = 0x05,
+  DATAPOINT_DELIVER = 0x06,
+  DATAPOINT_REPORT_ASYNC = 0x07,
+  DATAPOINT_QUERY = 0x08,
+  DATAPOINT_REPORT_SYNC = 0x22,
+  DATAPOINT_REPORT_ACK = 0x23,
+  DISABLE_HEARTBEATS = 0x25,
+  EXTENDED_SERVICES = 0x34,
+};
+
+class ConformanceCore : public UyatCore
+{
+public:
+  using UyatCore::UyatCore;
+  using UyatCore::get_datapoint_;
+
+  std::optional<uint32_t> initialized_at_ms;
+  std::optional<int> status_pin;
+
+protected:
+  void on_initialized_() override
+  {
+    this->initialized_at_ms = this->clock_.get_millis();
+  }
+
+  void on_status_pin_reported_(const int pin) override
+  {
+    this->status_pin = pin;
+  }
+};
+
+class ConformanceTest : public ::testing::Test
+{
+protected:
+  static host::McuScript default_script()
+  {
+    host::McuScript script;
+    script.baud_rate = 9600u;
+    script.response_delay_ms = 5u;
+    script.datapoints.push_back(UyatDatapoint{1u, BoolDatapointValue{false}});
+    script.datapoints.push_back(UyatDatapoint{2u, UIntDatapointValue{215u}});
+    return script;
+  }
+
+  void SetUp() override
+  {
+    host::set_log_level(ESPHOME_LOG_LEVEL_WARN);
+  }
+
+  void start(host::McuScript script = default_script())
+  {
+    this->mcu = std::make_unique<host::McuSimulator>(std::move(script), this->clock);
+    this->mcu->set_record_received_frames(true);
+    this->transport.set_tx_sink([this](const uint8_t* data, const std::size_t len) { this->mcu->receive(data, len); });
+    this->core = std::make_unique<ConformanceCore>(this->transport, this->clock, this->timers);
+    this->core->register_datapoint_listener(2u, [this](const UyatDatapoint& datapoint) { this->reported.push_back(datapoint); });
+    this->core->start();
+    this->states.push_back({this->clock.get_millis(), this->core->get_init_state()});
+  }
+
+  void step()
+  {
+    this->clock.advance_ms(1u);
+    std::vector<uint8_t> line;
+    this->mcu->poll(line);
+    this->transport.push(line);
+    if ((this->clock.get_millis() % LOOP_INTERVAL_MS) == 0u)
+    {
+      this->core->poll();
+      this->timers.run_due();
+      if (this->core->get_init_state() != this->states.back().second)
+      {
+        this->states.push_back({this->clock.get_millis(), this->core->get_init_state()});
+      }
+    }
+  }
+
+  // With the core, the MCU and the line idle nothing can happen before the next timer or MCU action, the
+  // clock jumps to just before it - the hours between the heartbeats take no time. False when there is
+  // nothing to skip.
+  bool skip_idle_time(const uint32_t max_ms)
+  {
+    if (!this->core->is_idle() || !this->mcu->is_idle() || !this->transport.rx.empty())
+    {
+      return false;
+    }
+    uint32_t next_in = max_ms;
+    if (const auto timer_in = this->timers.get_next_due_in_ms())
+    {
+      next_in = std::min(next_in, *timer_in);
+    }
+    if (const auto action_in = this->mcu->get_next_action_in_ms())
+    {
+      next_in = std::min(next_in, *action_in);
+    }
+    if (next_in <= 1u)
+    {
+      return false;
+    }
+    this->clock.advance_ms(next_in - 1u);
+    this->skipped_ms += next_in - 1u;
+    return true;
+  }
+
+  void run_for(const uint32_t duration_ms)
+  {
+    const uint32_t end_ms = this->clock.get_millis() + duration_ms;
+    while (this->clock.get_millis() != end_ms)
+    {
+      if (!this->skip_idle_time(end_ms - this->clock.get_millis()))
+      {
+        this->step();
+      }
+    }
+  }
+
+  // false on timeout
+  bool run_until(const std::function<bool()>& done, const uint32_t timeout_ms)
+  {
+    const uint32_t end_ms = this->clock.get_millis() + timeout_ms;
+    while (this->clock.get_millis() != end_ms)
+    {
+      if (done())
+      {
+        return true;
+      }
+      if (!this->skip_idle_time(end_ms - this->clock.get_millis()))
+      {
+        this->step();
+      }
+    }
+    return done();
+  }
+
+  bool run_until_initialized(const uint32_t timeout_ms = 10000u)
+  {
+    return this->run_until([this] { return this->core->get_init_state() == UyatInitState::INIT_DONE; }, timeout_ms);
+  }
+
+  // the frames received by the MCU from the given index on
+  std::vector<uint8_t> received_commands(const std::size_t from = 0u) const
+  {
+    std::vector<uint8_t> commands;
+    const auto& frames = this->mcu->get_received_frames();
+    for (std::size_t i = from; i < frames.size(); ++i)
+    {
+      commands.push_back(frames[i].command);
+    }
+    return commands;
+  }
+
+  std::vector<const host::McuSimulator::ReceivedFrame*> received(const uint8_t command) const
+  {
+    std::vector<const host::McuSimulator::ReceivedFrame*> frames;
+    for (const auto& frame : this->mcu->get_received_frames())
+    {
+      if (frame.command == command)
+      {
+        frames.push_back(&frame);
+      }
+    }
+    return frames;
+  }
+
+  std::optional<uint32_t> state_entered_at(const UyatInitState state) const
+  {
+    for (const auto& [at_ms, entered] : this->states)
+    {
+      if (entered == state)
+      {
+        return at_ms;
+      }
+    }
+    return {};
+  }
+
+  // sends a frame to the module and runs till the MCU got the given command back
+  std::optional<uint32_t> response_time(const uint8_t command, const std::vector<uint8_t>& payload,
+                                        const uint8_t response)
+  {
+    const auto sent_at = this->clock.get_millis();
+    const auto before = this->received(response).size();
+    this->mcu->send_frame(command, payload);
+    if (!this->run_until([&] { return this->received(response).size() > before; }, 2000u))
+    {
+      return {};
+    }
+    return this->received(response).back()->at_ms - sent_at;
+  }
+
+  host::ManualClock clock;
+  host::TimerQueue timers{clock};
+  host::QueueTransport transport;
+  std::unique_ptr<host::McuSimulator> mcu;
+  std::unique_ptr<ConformanceCore> core;
+  std::vector<std::pair<uint32_t, UyatInitState>> states;
+  std::vector<UyatDatapoint> reported;
+  uint64_t skipped_ms{0};
+};
+
+TEST_F(ConformanceTest, InitSequenceOrder)
+{
+  this->start();
+  ASSERT_TRUE(this->run_until_initialized());
+
+  // without the status pin the module reports the WiFi state: configured, connected, cloud connected
+  const std::vector<uint8_t> expected{HEARTBEAT, PRODUCT_QUERY, CONF_QUERY, WIFI_STATE, WIFI_STATE, WIFI_STATE,
+                                      DATAPOINT_QUERY};
+  EXPECT_EQ(this->received_commands(), expected);
+  const auto wifi_states = this->received(WIFI_STATE);
+  ASSERT_EQ(wifi_states.size(), 3u);
+  EXPECT_EQ(wifi_states[0]->payload, std::vector<uint8_t>{UyatNetworkStatus::WIFI_CONFIGURED});
+  EXPECT_EQ(wifi_states[1]->payload, std::vector<uint8_t>{UyatNetworkStatus::WIFI_CONNECTED});
+  EXPECT_EQ(wifi_states[2]->payload, std::vector<uint8_t>{UyatNetworkStatus::CLOUD_CONNECTED});
+
+  // the states only move forward, INIT_WIFI passes within a single poll
+  for (std::size_t i = 1u; i < this->states.size(); ++i)
+  {
+    EXPECT_LT(this->states[i - 1u].second, this->states[i].second);
+  }
+  EXPECT_EQ(this->states.back().second, UyatInitState::INIT_DONE);
+  ASSERT_TRUE(this->core->initialized_at_ms.has_value());
+  EXPECT_EQ(this->reported.size(), 1u);
+}
+
+TEST_F(ConformanceTest, InitTiming)
+{
+  this->start();
+  ASSERT_TRUE(this->run_until_initialized());
+
+  const auto heartbeats = this->received(HEARTBEAT);
+  ASSERT_FALSE(heartbeats.empty());
+  EXPECT_GE(heartbeats[0]->at_ms, FIRST_HEARTBEAT_MS);
+  EXPECT_LE(heartbeats[0]->at_ms, FIRST_HEARTBEAT_MS + LOOP_INTERVAL_MS);
+
+  const auto heartbeat_answered = this->state_entered_at(UyatInitState::INIT_PRODUCT);
+  ASSERT_TRUE(heartbeat_answered.has_value());
+  ASSERT_TRUE(this->core->initialized_at_ms.has_value());
+  EXPECT_LT(*this->core->initialized_at_ms - *heartbeat_answered, INIT_BUDGET_MS);
+}
+
+TEST_F(ConformanceTest, InitWithStatusPin)
+{
+  auto script = default_script();
+  script.conf_pins = std::make_pair(uint8_t{14u}, uint8_t{0u});
+  this->start(std::move(script));
+  ASSERT_TRUE(this->run_until_initialized());
+
+  // the MCU drives the status LED, no WIFI_STATE
+  const std::vector<uint8_t> expected{HEARTBEAT, PRODUCT_QUERY, CONF_QUERY, DATAPOINT_QUERY};
+  EXPECT_EQ(this->received_commands(), expected);
+  EXPECT_EQ(this->core->status_pin, 14);
+}
+
+TEST_F(ConformanceTest, HeartbeatRetriedAfterTimeout)
+{
+  auto script = default_script();
+  script.init_failures[static_cast<std::size_t>(host::McuScript::InitStep::HEARTBEAT)] = 2u;
+  this->start(std::move(script));
+  ASSERT_TRUE(this->run_until_initialized());
+
+  const auto heartbeats = this->received(HEARTBEAT);
+  ASSERT_EQ(heartbeats.size(), 3u);
+  for (std::size_t i = 1u; i < heartbeats.size(); ++i)
+  {
+    const auto interval = heartbeats[i]->at_ms - heartbeats[i - 1u]->at_ms;
+    EXPECT_GT(interval, RESPONSE_TIMEOUT_MS);
+    EXPECT_LE(interval, RESPONSE_TIMEOUT_MS + 2u * LOOP_INTERVAL_MS);
+  }
+}
+
+TEST_F(ConformanceTest, UnansweredInitCommandRetriedAfterTimeout)
+{
+  auto script = default_script();
+  script.init_failures[static_cast<std::size_t>(host::McuScript::InitStep::PRODUCT)] = 1u;
+  this->start(std::move(script));
+  ASSERT_TRUE(this->run_until_initialized());
+
+  const auto queries = this->received(PRODUCT_QUERY);
+  ASSERT_EQ(queries.size(), 2u);
+  const auto interval = queries[1]->at_ms - queries[0]->at_ms;
+  EXPECT_GT(interval, RESPONSE_TIMEOUT_MS);
+  EXPECT_LE(interval, RESPONSE_TIMEOUT_MS + 2u * LOOP_INTERVAL_MS);
+}
+
+TEST_F(ConformanceTest, NoInitCommandRepeatedAfterInit)
+{
+  this->start();
+  ASSERT_TRUE(this->run_until_initialized());
+  EXPECT_FALSE(this->timers.is_pending("product"));
+  const auto frames_at_init = this->mcu->get_received_frames().size();
+  // longer than any of the init retry timers, shorter than the heartbeat period
+  this->run_for(HEARTBEAT_PERIOD_MS - 1000u);
+
+  EXPECT_EQ(this->received_commands(frames_at_init), std::vector<uint8_t>{});
+}
+
+TEST_F(ConformanceTest, HeartbeatCadence)
+{
+  this->start();
+  ASSERT_TRUE(this->run_until_initialized());
+  this->run_for(4u * HEARTBEAT_PERIOD_MS);
+
+  const auto heartbeats = this->received(HEARTBEAT);
+  ASSERT_EQ(heartbeats.size(), 5u);
+  // the period starts when the answer is handled
+  for (std::size_t i = 1u; i < heartbeats.size(); ++i)
+  {
+    const auto interval = heartbeats[i]->at_ms - heartbeats[i - 1u]->at_ms;
+    EXPECT_GT(interval, HEARTBEAT_PERIOD_MS);
+    EXPECT_LE(interval, HEARTBEAT_PERIOD_MS + RESPONSE_BUDGET_MS);
+  }
+}
+
+TEST_F(ConformanceTest, HeartbeatCadenceOverHours)
+{
+  static constexpr uint32_t DURATION_MS = 6u * 3600u * 1000u;
+  this->start();
+  ASSERT_TRUE(this->run_until_initialized());
+  const auto frames_at_init = this->mcu->get_received_frames().size();
+  this->run_for(DURATION_MS);
+
+  // nothing but the heartbeats, at the same pace all the time
+  const auto commands = this->received_commands(frames_at_init);
+  EXPECT_GE(commands.size(), DURATION_MS / (HEARTBEAT_PERIOD_MS + RESPONSE_BUDGET_MS));
+  EXPECT_EQ(std::count(commands.begin(), commands.end(), HEARTBEAT), static_cast<std::ptrdiff_t>(commands.size()));
+  const auto heartbeats = this->received(HEARTBEAT);
+  for (std::size_t i = 1u; i < heartbeats.size(); ++i)
+  {
+    const auto interval = heartbeats[i]->at_ms - heartbeats[i - 1u]->at_ms;
+    EXPECT_GT(interval, HEARTBEAT_PERIOD_MS);
+    EXPECT_LE(interval, HEARTBEAT_PERIOD_MS + RESPONSE_BUDGET_MS);
+  }
+  // only the exchanges were stepped through
+  EXPECT_GT(this->skipped_ms, DURATION_MS - DURATION_MS / 100u);
+}
+
+TEST_F(ConformanceTest, HeartbeatsDisabledByMcu)
+{
+  this->start();
+  ASSERT_TRUE(this->run_until_initialized());
+  this->mcu->send_frame(DISABLE_HEARTBEATS, {});
+  this->run_for(100u);
+  const auto heartbeats = this->received(HEARTBEAT).size();
+  this->run_for(3u * HEARTBEAT_PERIOD_MS);
+
+  EXPECT_EQ(this->received(HEARTBEAT).size(), heartbeats);
+}
+
+TEST_F(ConformanceTest, WifiResetAckedAndReinitialized)
+{
+  this->start();
+  ASSERT_TRUE(this->run_until_initialized());
+  const auto frames_before = this->mcu->get_received_frames().size();
+
+  const auto ack_time = this->response_time(WIFI_RESET, {}, WIFI_RESET);
+  ASSERT_TRUE(ack_time.has_value());
+  EXPECT_LE(*ack_time, RESPONSE_BUDGET_MS);
+  ASSERT_TRUE(this->run_until_initialized());
+
+  // acked first, then the init from the product query on
+  const std::vector<uint8_t> expected{WIFI_RESET, PRODUCT_QUERY, CONF_QUERY, WIFI_STATE, WIFI_STATE, WIFI_STATE,
+                                      DATAPOINT_QUERY};
+  EXPECT_EQ(this->received_commands(frames_before), expected);
+}
+
+TEST_F(ConformanceTest, WifiSelectEntersRequestedPairingMode)
+{
+  this->start();
+  ASSERT_TRUE(this->run_until_initialized());
+
+  for (const uint8_t mode : {uint8_t{0x01u}, uint8_t{0x00u}})
+  {
+    const auto frames_before = this->mcu->get_received_frames().size();
+    const auto ack_time = this->response_time(WIFI_SELECT, {mode}, WIFI_SELECT);
+    ASSERT_TRUE(ack_time.has_value());
+    EXPECT_LE(*ack_time, RESPONSE_BUDGET_MS);
+    ASSERT_TRUE(this->run_until_initialized());
+
+    const auto& frames = this->mcu->get_received_frames();
+    const auto first_wifi_state =
+        std::find_if(frames.begin() + frames_before, frames.end(),
+                     [](const host::McuSimulator::ReceivedFrame& frame) { return frame.command == WIFI_STATE; });
+    ASSERT_NE(first_wifi_state, frames.end());
+    const uint8_t expected_status = (mode == 0x01u) ? UyatNetworkStatus::AP_MODE : UyatNetworkStatus::SMARTCONFIG;
+    EXPECT_EQ(first_wifi_state->payload, std::vector<uint8_t>{expected_status});
+  }
+}
+
+TEST_F(ConformanceTest, SyncReportAcked)
+{
+  auto script = default_script();
+  script.sync_reports = true;
+  this->start(std::move(script));
+  ASSERT_TRUE(this->run_until_initialized());
+  ASSERT_TRUE(this->run_until([this] { return !this->received(DATAPOINT_REPORT_ACK).empty(); }, 1000u));
+
+  this->mcu->set_datapoint(UyatDatapoint{2u, UIntDatapointValue{230u}}, false);
+  const auto ack_time = this->response_time(DATAPOINT_REPORT_SYNC, {2u, 0x02u, 0x00u, 0x04u, 0x00u, 0x00u, 0x00u, 0xE6u},
+                                            DATAPOINT_REPORT_ACK);
+  ASSERT_TRUE(ack_time.has_value());
+  EXPECT_LE(*ack_time, RESPONSE_BUDGET_MS);
+  EXPECT_EQ(this->received(DATAPOINT_REPORT_ACK).back()->payload, std::vector<uint8_t>{0x01u});
+  ASSERT_FALSE(this->reported.empty());
+  EXPECT_EQ(this->reported.back().value, UyatDatapoint(2u, UIntDatapointValue{230u}).value);
+  // one ack per report, the report of the init included
+  EXPECT_EQ(this->received(DATAPOINT_REPORT_ACK).size(), 2u);
+}
+
+TEST_F(ConformanceTest, DatapointDeliveredAndEchoed)
+{
+  this->start();
+  ASSERT_TRUE(this->run_until_initialized());
+
+  const auto set_at = this->clock.get_millis();
+  this->core->set_datapoint_value(UyatDatapoint{2u, UIntDatapointValue{500u}}, false);
+  ASSERT_TRUE(this->run_until([this] { return !this->received(DATAPOINT_DELIVER).empty(); }, 1000u));
+  EXPECT_LE(this->received(DATAPOINT_DELIVER).front()->at_ms - set_at, LOOP_INTERVAL_MS);
+  const std::vector<uint8_t> payload{2u, 0x02u, 0x00u, 0x04u, 0x00u, 0x00u, 0x01u, 0xF4u};
+  EXPECT_EQ(this->received(DATAPOINT_DELIVER).front()->payload, payload);
+
+  ASSERT_TRUE(this->run_until([this] { return this->reported.size() == 2u; }, 1000u));
+  EXPECT_LE(this->clock.get_millis() - set_at, RESPONSE_BUDGET_MS);
+  EXPECT_EQ(this->mcu->get_datapoint(2u)->value, UyatDatapoint(2u, UIntDatapointValue{500u}).value);
+}
+
+TEST_F(ConformanceTest, LastValueDeferredByMinIntervalDelivered)
+{
+  static constexpr uint32_t MIN_INTERVAL_MS = 1000u;
+  this->start();
+  this->core->add_datapoint_policy(2u, DatapointPolicy{.min_interval_ms = MIN_INTERVAL_MS});
+  ASSERT_TRUE(this->run_until_initialized());
+  ASSERT_TRUE(this->run_until([this] { return !this->reported.empty(); }, 1000u));
+  const auto dispatched_at = this->clock.get_millis();
+  this->reported.clear();
+
+  // a dimmer moving 10 -> 20 -> 30 within the interval
+  for (const uint32_t value : {10u, 20u, 30u})
+  {
+    this->mcu->set_datapoint(UyatDatapoint{2u, UIntDatapointValue{value}}, true);
+    this->run_for(100u);
+  }
+  EXPECT_TRUE(this->reported.empty());
+  ASSERT_TRUE(this->core->get_datapoint_(2u).has_value());
+  EXPECT_EQ(this->core->get_datapoint_(2u)->value, UyatDatapoint(2u, UIntDatapointValue{30u}).value);
+
+  // only the latest value, once the interval expired
+  ASSERT_TRUE(this->run_until([this] { return !this->reported.empty(); }, 2u * MIN_INTERVAL_MS));
+  EXPECT_GE(this->clock.get_millis() - dispatched_at, MIN_INTERVAL_MS);
+  EXPECT_LE(this->clock.get_millis() - dispatched_at, MIN_INTERVAL_MS + LOOP_INTERVAL_MS);
+  EXPECT_EQ(this->reported.front().value, UyatDatapoint(2u, UIntDatapointValue{30u}).value);
+  this->run_for(3u * MIN_INTERVAL_MS);
+  EXPECT_EQ(this->reported.size(), 1u);
+}
+
+#ifdef UYAT_TRACE_EVENTS_ENABLED
+// the events of UyatTraceEvents as text, in the order they came
+class RecordingTraceEvents : public UyatTraceEvents
+{
+public:
+  void on_rx_frame(const uint8_t command, std::size_t, const uint32_t first_byte_us, const uint32_t handled_us) override
+  {
+    this->add("rx", command, first_byte_us, handled_us);
+  }
+
+  void on_dispatch(const uint8_t dp_number, const std::size_t listener, const uint32_t start_us,
+                   const uint32_t end_us) override
+  {
+    this->add("dispatch", dp_number, start_us, end_us);
+    this->listeners.push_back(listener);
+  }
+
+  void on_tx_frame(const uint8_t command, std::size_t, const uint32_t start_us, const uint32_t end_us) override
+  {
+    this->add("tx", command, start_us, end_us);
+  }
+
+  void on_response_wait(const uint8_t command, const uint32_t sent_us, const uint32_t end_us,
+                        const bool answered) override
+  {
+    this->add(answered ? "answered" : "timeout", command, sent_us, end_us);
+  }
+
+  struct Event
+  {
+    std::string kind;
+    uint8_t id;
+    uint32_t start_us;
+    uint32_t end_us;
+  };
+
+  void add(const char* kind, const uint8_t id, const uint32_t start_us, const uint32_t end_us)
+  {
+    this->events.push_back(Event{kind, id, start_us, end_us});
+  }
+
+  std::vector<Event> events;
+  std::vector<std::size_t> listeners;
+};
+
+TEST_F(ConformanceTest, TraceEventsOfADatapointWrite)
+{
+  RecordingTraceEvents trace;
+  this->start();
+  ASSERT_TRUE(this->run_until_initialized());
+  this->core->set_trace_events(&trace);
+
+  this->core->set_datapoint_value(UyatDatapoint{2u, UIntDatapointValue{500u}}, false);
+  ASSERT_TRUE(this->run_until([this] { return this->reported.size() == 2u; }, 1000u));
+  this->core->set_trace_events(nullptr);
+
+  // the command, its wait ended by the report, the report with the dispatch to the listener nested in it
+  std::vector<std::pair<std::string, uint8_t>> kinds;
+  for (const auto& event : trace.events)
+  {
+    kinds.emplace_back(event.kind, event.id);
+  }
+  const std::vector<std::pair<std::string, uint8_t>> expected{
+      {"tx", DATAPOINT_DELIVER}, {"answered", DATAPOINT_DELIVER}, {"dispatch", 2u}, {"rx", DATAPOINT_REPORT_ASYNC}};
+  ASSERT_EQ(kinds, expected);
+  EXPECT_EQ(trace.listeners, std::vector<std::size_t>{0u});
+  const auto& tx = trace.events[0];
+  const auto& wait = trace.events[1];
+  const auto& dispatch = trace.events[2];
+  const auto& rx = trace.events[3];
+  EXPECT_EQ(wait.start_us, tx.end_us);
+  EXPECT_GT(wait.end_us, wait.start_us);
+  EXPECT_LE(rx.start_us, dispatch.start_us);
+  EXPECT_LE(dispatch.end_us, rx.end_us);
+  EXPECT_LE(rx.end_us - tx.start_us, RESPONSE_BUDGET_MS * 1000u);
+}
+#endif
+
+TEST_F(ConformanceTest, ExtendedServicesResetNotification)
+{
+  this->start();
+  ASSERT_TRUE(this->run_until_initialized());
+
+  const auto response_time = this->response_time(EXTENDED_SERVICES, {0x04u}, EXTENDED_SERVICES);
+  ASSERT_TRUE(response_time.has_value());
+  EXPECT_LE(*response_time, RESPONSE_BUDGET_MS);
+  EXPECT_EQ(this->received(EXTENDED_SERVICES).back()->payload, (std::vector<uint8_t>{0x04u, 0x00u}));
+}
+
+TEST_F(ConformanceTest, ExtendedServicesModuleInformation)
+{
+  this->start();
+  ASSERT_TRUE(this->run_until_initialized());
+
+  const auto response_time = this->response_time(EXTENDED_SERVICES, {0x07u, 0x01u, 0x03u}, EXTENDED_SERVICES);
+  ASSERT_TRUE(response_time.has_value());
+  EXPECT_LE(*response_time, RESPONSE_BUDGET_MS);
+  const auto& payload = this->received(EXTENDED_SERVICES).back()->payload;
+  ASSERT_GE(payload.size(), 2u);
+  EXPECT_EQ(payload[0], 0x07u);
+  EXPECT_EQ(payload[1], 0x00u);
+  EXPECT_EQ(std::string(payload.begin() + 2, payload.end()), R"({"ap":"smartlife","sn":"1234567890"})");
+
+  // no known field requested
+  ASSERT_TRUE(this->response_time(EXTENDED_SERVICES, {0x07u, 0x09u}, EXTENDED_SERVICES).has_value());
+  EXPECT_EQ(this->received(EXTENDED_SERVICES).back()->payload, (std::vector<uint8_t>{0x07u, 0x01u}));
+}
+
+}
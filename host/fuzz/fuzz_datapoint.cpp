@@ -0,0 +1,50 @@
+// UyatDatapoint::construct on the payload of a datapoint report, walked like handle_datapoints_() does.
+// Every decoded datapoint must survive the round trip through to_payload().
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+
+#include "uyat_datapoint_types.h"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size)
+{
+  using namespace esphome::uyat;
+
+  const std::deque<uint8_t> buffer(data, data + size);
+  std::size_t offset = 0u;
+  std::size_t len = size;
+  while (len >= 4u)
+  {
+    std::size_t used_len = 0u;
+    const auto datapoint = UyatDatapoint::construct(buffer, offset, len, used_len);
+    if (used_len == 0u)
+    {
+      used_len = len;
+    }
+    len -= used_len;
+    offset += used_len;
+    if (!datapoint.has_value())
+    {
+      continue;
+    }
+
+    char text[64];
+    datapoint->format_to(text, sizeof(text));
+    (void) datapoint->to_string();
+
+    const auto value = datapoint->value_to_payload();
+    std::deque<uint8_t> encoded{datapoint->number, static_cast<uint8_t>(datapoint->get_type()),
+                                static_cast<uint8_t>(value.size() >> 8), static_cast<uint8_t>(value.size())};
+    encoded.insert(encoded.end(), value.begin(), value.end());
+    std::size_t encoded_len = 0u;
+    const auto decoded = UyatDatapoint::construct(encoded, 0u, encoded.size(), encoded_len);
+    if (!decoded.has_value() || (encoded_len != encoded.size()) || (decoded->number != datapoint->number) ||
+        !(decoded->value == datapoint->value))
+    {
+      abort();
+    }
+  }
+  return 0;
+}
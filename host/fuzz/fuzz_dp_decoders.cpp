@@ -0,0 +1,122 @@
+// The value decoders of the datapoint entities, reached through their listeners like in the device.
+//
+// The lower 7 bits of the first byte select the entity, the highest bit selects the STRING datapoint
+// type for the text entity (RAW otherwise). The rest is the reported value. The text entity also gets
+// the input to set, which runs its hex/base64 encoders.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "dp_color.h"
+#include "dp_text.h"
+#include "dp_vap.h"
+
+namespace esphome::uyat::fuzz
+{
+
+// the single listener of the entity, the values set by the entity are dropped
+class FuzzHandler : public DatapointHandler
+{
+public:
+  void register_datapoint_listener(const MatchingDatapoint&, const OnDatapointCallback& callback) override
+  {
+    this->listener_ = callback;
+  }
+
+  void set_datapoint_value(const UyatDatapoint& dp, const bool) override
+  {
+    (void) dp.value_to_payload();
+  }
+
+  void deliver(const UyatDatapoint& dp)
+  {
+    this->listener_(dp);
+  }
+
+private:
+  OnDatapointCallback listener_;
+};
+
+enum Decoder : uint8_t
+{
+  COLOR_RGB,
+  COLOR_HSV,
+  COLOR_RGBHSV,
+  VAP,
+  TEXT_PLAIN,
+  TEXT_BASE64,
+  TEXT_HEX,
+  NUM_DECODERS,
+};
+
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size)
+{
+  using namespace esphome::uyat;
+  using namespace esphome::uyat::fuzz;
+  static const bool initialized = []
+  {
+    host::set_log_level(ESPHOME_LOG_LEVEL_NONE);
+    return true;
+  }();
+  (void) initialized;
+
+  if (size == 0u)
+  {
+    return 0;
+  }
+
+  const auto decoder = static_cast<Decoder>((data[0] & 0x7Fu) % NUM_DECODERS);
+  const bool as_string = (data[0] & 0x80u) != 0u;
+  const std::vector<uint8_t> raw(data + 1, data + size);
+  const std::string text(raw.begin(), raw.end());
+  FuzzHandler handler;
+
+  switch (decoder)
+  {
+    case COLOR_RGB:
+    case COLOR_HSV:
+    case COLOR_RGBHSV:
+    {
+      DpColor color([](const DpColor::Value&) {}, MatchingDatapoint{.number = 1, .types = {UyatDatapointType::STRING}},
+                    static_cast<UyatColorType>(decoder - COLOR_RGB));
+      color.init(handler);
+      handler.deliver(UyatDatapoint{1, StringDatapointValue{text}});
+      break;
+    }
+    case VAP:
+    {
+      DpVAP vap([](const DpVAP::VAPValue&) {}, MatchingDatapoint{.number = 1, .types = {UyatDatapointType::RAW}});
+      vap.init(handler);
+      handler.deliver(UyatDatapoint{1, RawDatapointValue{raw}});
+      break;
+    }
+    case TEXT_PLAIN:
+    case TEXT_BASE64:
+    case TEXT_HEX:
+    {
+      static const TextDataEncoding ENCODINGS[] = {TextDataEncoding::PLAIN, TextDataEncoding::AS_BASE64,
+                                                   TextDataEncoding::AS_HEX};
+      const auto type = as_string ? UyatDatapointType::STRING : UyatDatapointType::RAW;
+      DpText dp_text([](const std::string&) {}, MatchingDatapoint{.number = 1, .types = {type}},
+                     ENCODINGS[decoder - TEXT_PLAIN]);
+      dp_text.init(handler);
+      if (as_string)
+      {
+        handler.deliver(UyatDatapoint{1, StringDatapointValue{text}});
+      }
+      else
+      {
+        handler.deliver(UyatDatapoint{1, RawDatapointValue{raw}});
+      }
+      dp_text.set_value(text);
+      break;
+    }
+    default:
+      break;
+  }
+  return 0;
+}
@@ -0,0 +1,119 @@
+// Arbitrary byte streams from the MCU through validate_message_() and handle_command_().
+//
+// The lower bits of the first byte select the init state the core starts in, the rest is fed in chunks
+// with the clock advancing between them, so that the timeouts and retries are reached as well.
+// With the highest bit of the first byte set, the rest is a list of [command][length][payload] records
+// which are framed with a valid checksum, so that the command handlers get arbitrary payloads instead
+// of mostly checksum errors.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "uyat_core.h"
+#include "uyat_host_platform.h"
+
+namespace esphome::uyat::fuzz
+{
+
+class FuzzClock : public UyatClock
+{
+public:
+  uint32_t get_millis() override
+  {
+    return this->millis;
+  }
+
+  uint32_t get_micros() override
+  {
+    return this->millis * 1000u;
+  }
+
+  uint32_t millis{0};
+};
+
+std::vector<uint8_t> frame_records(const uint8_t* data, const std::size_t size)
+{
+  std::vector<uint8_t> stream;
+  std::size_t pos = 0u;
+  while ((pos + 2u) <= size)
+  {
+    const uint8_t command = data[pos];
+    const std::size_t len = std::min<std::size_t>(data[pos + 1u], size - pos - 2u);
+    const auto frame_start = stream.size();
+    stream.insert(stream.end(), {0x55, 0xAA, 0x03, command, 0x00, static_cast<uint8_t>(len)});
+    stream.insert(stream.end(), data + pos + 2u, data + pos + 2u + len);
+    uint8_t checksum = 0u;
+    for (auto i = frame_start; i < stream.size(); ++i)
+    {
+      checksum += stream[i];
+    }
+    stream.push_back(checksum);
+    pos += 2u + len;
+  }
+  return stream;
+}
+
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size)
+{
+  using namespace esphome::uyat;
+  static const bool initialized = []
+  {
+    host::set_log_level(ESPHOME_LOG_LEVEL_NONE);
+    return true;
+  }();
+  (void) initialized;
+
+  if (size == 0u)
+  {
+    return 0;
+  }
+
+  host::QueueTransport transport;
+  fuzz::FuzzClock clock;
+  host::TimerQueue timers(clock);
+  host::InitStateCore core(transport, clock, timers);
+
+  for (uint8_t number = 1u; number <= 8u; ++number)
+  {
+    core.register_datapoint_listener(number, [](const UyatDatapoint& datapoint) { (void) datapoint.value_to_payload(); });
+  }
+  core.register_frame_end_listener([] {});
+  core.add_datapoint_policy(3u, DatapointPolicy{.ignore = true});
+
+  core.set_init_state(
+      static_cast<UyatInitState>((data[0] & 0x7Fu) % (static_cast<uint8_t>(UyatInitState::INIT_DONE) + 1u)));
+  core.start();
+
+  std::vector<uint8_t> stream;
+  if ((data[0] & 0x80u) != 0u)
+  {
+    stream = fuzz::frame_records(data + 1, size - 1u);
+  }
+  else
+  {
+    stream.assign(data + 1, data + size);
+  }
+
+  static const std::size_t CHUNK_SIZE = 16u;
+  for (std::size_t offset = 0u; offset < stream.size(); offset += CHUNK_SIZE)
+  {
+    const auto end = std::min(stream.size(), offset + CHUNK_SIZE);
+    transport.rx.insert(transport.rx.end(), stream.begin() + offset, stream.begin() + end);
+    core.poll();
+    clock.millis += 7u;
+    timers.run_due();
+  }
+
+  // let the pending responses time out
+  for (int i = 0; i < 10; ++i)
+  {
+    core.poll();
+    clock.millis += 500u;
+    timers.run_due();
+  }
+  return 0;
+}
@@ -0,0 +1,67 @@
+// Runs a fuzz target without libFuzzer: over the given files and directories (eg. a corpus or a
+// crash reproducer), or over stdin when there are none, which is how AFL runs its targets.
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size);
+
+static void run(const std::vector<char>& input)
+{
+  LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t*>(input.data()), input.size());
+}
+
+static bool run_file(const std::filesystem::path& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+  {
+    fprintf(stderr, "can't open %s\n", path.c_str());
+    return false;
+  }
+  run(std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()));
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 2)
+  {
+    run(std::vector<char>(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>()));
+    return 0;
+  }
+
+  std::size_t inputs = 0u;
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::filesystem::path path(argv[i]);
+    if (std::filesystem::is_directory(path))
+    {
+      for (const auto& entry : std::filesystem::recursive_directory_iterator(path))
+      {
+        if (entry.is_regular_file())
+        {
+          if (!run_file(entry.path()))
+          {
+            return 1;
+          }
+          ++inputs;
+        }
+      }
+    }
+    else
+    {
+      if (!run_file(path))
+      {
+        return 1;
+      }
+      ++inputs;
+    }
+  }
+  printf("%zu inputs run\n", inputs);
+  return 0;
+}
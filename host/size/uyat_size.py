@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+"""Code size and static RAM of the uyat component over a matrix of representative configs.
+
+Compiles the configs in configs/ with esphome, reads the linker map of each firmware and sums the
+input sections of the uyat object files:
+
+    text    code, flash (.text, .irom0.text, .literal)
+    rodata  constants, flash
+    data    initialised variables, flash and RAM
+    bss     zeroed variables, RAM
+
+The report is compared with the stored baseline, growing by more than the tolerance is a regression.
+
+    uyat_size.py [-c config]... [--map config=firmware.map]... [-o report.json]
+                 [--baseline baseline.json] [--tolerance bytes] [--update-baseline]
+
+Exits with 1 on a regression, 2 when a config fails to compile or a map can't be read.
+"""
+
+import argparse
+import json
+import re
+import subprocess
+import sys
+from pathlib import Path
+
+HERE = Path(__file__).resolve().parent
+CONFIGS_DIR = HERE / "configs"
+DEFAULT_BUILD_DIR = CONFIGS_DIR / "build"
+DEFAULT_BASELINE = HERE / "baseline.json"
+
+CATEGORIES = ("text", "rodata", "data", "bss")
+COMPONENT_PATH = "components/uyat/"
+
+# an input section: name, address, size and object file, the name on a line of its own when it's long
+SECTION_RE = re.compile(r"^ (?P<name>\.\S+|COMMON)(?:\s+0x(?P<address>[0-9a-f]+)\s+0x(?P<size>[0-9a-f]+)\s+(?P<object>\S.*))?$")
+CONTINUATION_RE = re.compile(r"^\s+0x(?P<address>[0-9a-f]+)\s+0x(?P<size>[0-9a-f]+)\s+(?P<object>\S.*)$")
+
+
+def classify(section):
+    """The category of an input section, None for the ones not in the image (debug info, ...)."""
+    if section == "COMMON" or section.startswith((".bss", ".sbss")):
+        return "bss"
+    if section.startswith((".rodata", ".srodata", ".irom0.rodata")):
+        return "rodata"
+    if section.startswith((".data", ".sdata")):
+        return "data"
+    if section.startswith((".text", ".irom0.text", ".irom.text", ".iram", ".literal", ".irom0.literal")):
+        return "text"
+    return None
+
+
+def object_name(path):
+    """The object file relative to the component, None when it's not one of the component."""
+    path = path.replace("\\", "/")
+    index = path.rfind(COMPONENT_PATH)
+    if index < 0:
+        return None
+    name = path[index + len(COMPONENT_PATH):]
+    return name[:-2] if name.endswith(".o") else name
+
+
+def empty_sizes():
+    return {category: 0 for category in CATEGORIES}
+
+
+def parse_map(path):
+    """The sizes per uyat object file and of the whole image from a GNU ld map."""
+    objects = {}
+    image = empty_sizes()
+    in_memory_map = False
+    pending = None
+    with open(path, encoding="utf-8", errors="replace") as map_file:
+        for line in map_file:
+            line = line.rstrip("\n")
+            if not in_memory_map:
+                in_memory_map = line.startswith("Linker script and memory map")
+                continue
+            match = CONTINUATION_RE.match(line) if pending is not None else None
+            if match is not None:
+                section, pending = pending, None
+            else:
+                pending = None
+                match = SECTION_RE.match(line)
+                if match is None:
+                    continue
+                section = match.group("name")
+                if match.group("size") is None:
+                    pending = section
+                    continue
+            category = classify(section)
+            size = int(match.group("size"), 16)
+            if (category is None) or (size == 0) or (int(match.group("address"), 16) == 0):
+                continue
+            image[category] += size
+            name = object_name(match.group("object"))
+            if name is not None:
+                objects.setdefault(name, empty_sizes())[category] += size
+    if not in_memory_map:
+        raise ValueError("no memory map in {}, not a GNU ld map?".format(path))
+    total = empty_sizes()
+    for sizes in objects.values():
+        for category in CATEGORIES:
+            total[category] += sizes[category]
+    return {"total": total, "objects": dict(sorted(objects.items())), "image": image}
+
+
+def flash(sizes):
+    return sizes["text"] + sizes["rodata"] + sizes["data"]
+
+
+def ram(sizes):
+    return sizes["data"] + sizes["bss"]
+
+
+def compile_config(config, build_dir):
+    """Compiles a config of the matrix, returns its map."""
+    config_path = CONFIGS_DIR / "{}.yaml".format(config)
+    command = ["esphome", "-s", "build_dir", str(build_dir), "compile", str(config_path)]
+    print("$ {}".format(" ".join(command)), flush=True)
+    subprocess.run(command, check=True)
+    maps = sorted((build_dir / config_name(config_path)).rglob("firmware.map"), key=lambda path: path.stat().st_mtime)
+    if not maps:
+        raise FileNotFoundError("no firmware.map under {}".format(build_dir / config_name(config_path)))
+    return maps[-1]
+
+
+def config_name(config_path):
+    """The node name of a config, which is its build directory."""
+    match = re.search(r"^\s+name:\s*(\S+)\s*$", config_path.read_text(), re.MULTILINE)
+    if match is None:
+        raise ValueError("no name in {}".format(config_path))
+    return match.group(1)
+
+
+def print_report(report):
+    for config, sizes in report.items():
+        total = sizes["total"]
+        print("\n{}: flash {} B, ram {} B (image: flash {} B, ram {} B)".format(
+            config, flash(total), ram(total), flash(sizes["image"]), ram(sizes["image"])))
+        print("  {:<40} {:>8} {:>8} {:>8} {:>8}".format("object", *CATEGORIES))
+        for name, object_sizes in sizes["objects"].items():
+            print("  {:<40} {:>8} {:>8} {:>8} {:>8}".format(name, *(object_sizes[category] for category in CATEGORIES)))
+
+
+def compare(report, baseline, tolerance):
+    """Prints the differences with the baseline, returns the regressions."""
+    regressions = []
+    for config, sizes in report.items():
+        if config not in baseline:
+            print("{}: not in the baseline".format(config))
+            continue
+        base = baseline[config]
+        for metric, measure in (("flash", flash), ("ram", ram)):
+            delta = measure(sizes["total"]) - measure(base["total"])
+            if delta != 0:
+                print("{}: {} {:+d} B ({} -> {})".format(config, metric, delta, measure(base["total"]), measure(sizes["total"])))
+            if delta > tolerance:
+                regressions.append("{} {}".format(config, metric))
+        names = set(sizes["objects"]) | set(base["objects"])
+        for name in sorted(names):
+            current = sizes["objects"].get(name, empty_sizes())
+            previous = base["objects"].get(name, empty_sizes())
+            deltas = ["{} {:+d}".format(category, current[category] - previous[category])
+                      for category in CATEGORIES if current[category] != previous[category]]
+            if deltas:
+                print("  {}: {}".format(name, ", ".join(deltas)))
+    return regressions
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(description="Code size and static RAM of the uyat component per config.")
+    parser.add_argument("-c", "--config", action="append", dest="configs", metavar="CONFIG",
+                        help="config of configs/ to measure, all by default")
+    parser.add_argument("--map", action="append", default=[], metavar="CONFIG=MAP",
+                        help="use an existing linker map instead of compiling the config")
+    parser.add_argument("--build-dir", type=Path, default=DEFAULT_BUILD_DIR, help="where esphome builds the configs")
+    parser.add_argument("-o", "--output", type=Path, help="write the report as json")
+    parser.add_argument("--baseline", type=Path, default=DEFAULT_BASELINE, help="the report to compare with")
+    parser.add_argument("--tolerance", type=int, default=0, help="growth in bytes not considered a regression")
+    parser.add_argument("--update-baseline", action="store_true", help="store the report as the new baseline")
+    return parser.parse_args()
+
+
+def main():
+    args = parse_args()
+    maps = {}
+    for entry in args.map:
+        config, separator, path = entry.partition("=")
+        if not separator:
+            print("--map {}: expected config=map".format(entry), file=sys.stderr)
+            return 2
+        maps[config] = Path(path)
+    configs = args.configs
+    if configs is None:
+        configs = list(maps) if maps else sorted(path.stem for path in CONFIGS_DIR.glob("*.yaml"))
+
+    report = {}
+    for config in configs:
+        try:
+            map_path = maps[config] if config in maps else compile_config(config, args.build_dir.resolve())
+            report[config] = parse_map(map_path)
+        except (OSError, ValueError, subprocess.CalledProcessError) as error:
+            print("{}: {}".format(config, error), file=sys.stderr)
+            return 2
+    print_report(report)
+
+    if args.output is not None:
+        args.output.write_text(json.dumps(report, indent=2) + "\n")
+    if args.update_baseline:
+        baseline = json.loads(args.baseline.read_text()) if args.baseline.exists() else {}
+        baseline.update(report)
+        args.baseline.write_text(json.dumps(baseline, indent=2, sort_keys=True) + "\n")
+        print("\nbaseline {} updated".format(args.baseline))
+        return 0
+    if not args.baseline.exists():
+        print("\nno baseline {}, record one with --update-baseline".format(args.baseline))
+        return 0
+
+    print()
+    regressions = compare(report, json.loads(args.baseline.read_text()), args.tolerance)
+    if regressions:
+        print("\nregressions: {}".format(", ".join(regressions)))
+        return 1
+    print("no regression")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
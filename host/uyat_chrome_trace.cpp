@@ -0,0 +1,159 @@
+#include "uyat_chrome_trace.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+namespace esphome::uyat::host
+{
+
+ChromeTraceWriter::ChromeTraceWriter(std::ostream& output):
+output_(output)
+{
+  this->output_ << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  this->output_ << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"uyat\"}}";
+  this->write_metadata_("thread_name", TRACK_RX, "rx");
+  this->write_metadata_("thread_name", TRACK_TX, "tx");
+  this->write_metadata_("thread_name", TRACK_RESPONSE, "response");
+}
+
+ChromeTraceWriter::~ChromeTraceWriter()
+{
+  this->finish();
+}
+
+void ChromeTraceWriter::finish()
+{
+  if (this->finished_)
+  {
+    return;
+  }
+  this->finished_ = true;
+  this->output_ << "\n]}\n";
+  this->output_.flush();
+}
+
+void ChromeTraceWriter::on_rx_frame(const uint8_t command, const std::size_t size, const uint32_t first_byte_us,
+                                    const uint32_t handled_us)
+{
+  const auto first_byte = this->unwrap_(first_byte_us);
+  const auto handled = this->unwrap_(handled_us);
+  // the spans of a track have to nest, a frame read together with the previous one waited for it
+  const auto start = std::max(first_byte, std::min(this->rx_end_us_, handled));
+  this->rx_end_us_ = std::max(this->rx_end_us_, handled);
+  char args[96];
+  snprintf(args, sizeof(args), "{\"command\":\"0x%02X\",\"bytes\":%zu,\"first_byte_us\":%" PRIu64 "}", command, size,
+           first_byte);
+  this->write_span_(TRACK_RX, std::string("rx ") + command_name(command), start, handled, args);
+}
+
+void ChromeTraceWriter::on_dispatch(const uint8_t dp_number, const std::size_t listener, const uint32_t start_us,
+                                    const uint32_t end_us)
+{
+  char name[48];
+  snprintf(name, sizeof(name), "dp %u listener %zu", dp_number, listener);
+  char args[64];
+  snprintf(args, sizeof(args), "{\"datapoint\":%u,\"listener\":%zu}", dp_number, listener);
+  this->write_span_(TRACK_RX, name, this->unwrap_(start_us), this->unwrap_(end_us), args);
+}
+
+void ChromeTraceWriter::on_tx_frame(const uint8_t command, const std::size_t size, const uint32_t start_us,
+                                    const uint32_t end_us)
+{
+  char args[64];
+  snprintf(args, sizeof(args), "{\"command\":\"0x%02X\",\"bytes\":%zu}", command, size);
+  this->write_span_(TRACK_TX, std::string("tx ") + command_name(command), this->unwrap_(start_us),
+                    this->unwrap_(end_us), args);
+}
+
+void ChromeTraceWriter::on_response_wait(const uint8_t command, const uint32_t sent_us, const uint32_t end_us,
+                                         const bool answered)
+{
+  char args[64];
+  snprintf(args, sizeof(args), "{\"command\":\"0x%02X\",\"answered\":%s}", command, answered ? "true" : "false");
+  this->write_span_(TRACK_RESPONSE, std::string(answered ? "wait " : "timeout ") + command_name(command),
+                    this->unwrap_(sent_us), this->unwrap_(end_us), args);
+}
+
+const char* ChromeTraceWriter::command_name(const uint8_t command)
+{
+  switch (command)
+  {
+    case 0x00:
+      return "HEARTBEAT";
+    case 0x01:
+      return "PRODUCT_QUERY";
+    case 0x02:
+      return "CONF_QUERY";
+    case 0x03:
+      return "WIFI_STATE";
+    case 0x04:
+      return "WIFI_RESET";
+    case 0x05:
+      return "WIFI_SELECT";
+    case 0x06:
+      return "DATAPOINT_DELIVER";
+    case 0x07:
+      return "DATAPOINT_REPORT_ASYNC";
+    case 0x08:
+      return "DATAPOINT_QUERY";
+    case 0x0E:
+      return "WIFI_TEST";
+    case 0x1C:
+      return "LOCAL_TIME_QUERY";
+    case 0x22:
+      return "DATAPOINT_REPORT_SYNC";
+    case 0x23:
+      return "DATAPOINT_REPORT_ACK";
+    case 0x24:
+      return "WIFI_RSSI";
+    case 0x25:
+      return "DISABLE_HEARTBEATS";
+    case 0x28:
+      return "VACUUM_MAP_UPLOAD";
+    case 0x2B:
+      return "GET_NETWORK_STATUS";
+    case 0x2D:
+      return "GET_MAC_ADDRESS";
+    case 0x34:
+      return "EXTENDED_SERVICES";
+    default:
+      return "UNKNOWN";
+  }
+}
+
+uint64_t ChromeTraceWriter::unwrap_(const uint32_t us)
+{
+  if (!this->started_)
+  {
+    this->started_ = true;
+    this->last_us_ = us;
+    return us;
+  }
+  // the events come in about the order of their times, never 35 minutes apart
+  const auto delta = static_cast<int32_t>(us - static_cast<uint32_t>(this->last_us_));
+  const auto unwrapped = static_cast<uint64_t>(static_cast<int64_t>(this->last_us_) + delta);
+  this->last_us_ = std::max(this->last_us_, unwrapped);
+  return unwrapped;
+}
+
+void ChromeTraceWriter::write_metadata_(const char* name, const Track track, const char* value)
+{
+  this->output_ << ",\n{\"name\":\"" << name << "\",\"ph\":\"M\",\"pid\":1,\"tid\":" << static_cast<unsigned>(track)
+                << ",\"args\":{\"name\":\"" << value << "\"}}";
+}
+
+void ChromeTraceWriter::write_span_(const Track track, const std::string& name, const uint64_t start_us,
+                                    const uint64_t end_us, const std::string& args)
+{
+  if (this->finished_)
+  {
+    return;
+  }
+  ++this->events_;
+  this->output_ << ",\n{\"name\":\"" << name << "\",\"cat\":\"uyat\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                << static_cast<unsigned>(track) << ",\"ts\":" << start_us
+                << ",\"dur\":" << ((end_us > start_us) ? (end_us - start_us) : 0u) << ",\"args\":" << args << "}";
+}
+
+}
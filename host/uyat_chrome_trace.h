@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "uyat_trace_events.h"
+
+namespace esphome::uyat::host
+{
+
+// Writes the timeline of a core (see UyatCore::set_trace_events()) as a Chrome trace_event JSON file, which
+// loads into Perfetto (ui.perfetto.dev) or chrome://tracing. Three tracks:
+//  - rx: the frames received, from the first byte read to the end of the handling, with the dispatch to
+//    each listener nested in them. A frame waiting in the buffer behind another one starts when the
+//    previous one ends, its first byte is in the args.
+//  - tx: the frames sent
+//  - response: the waits of the sent commands for their response, till it came or timed out
+//
+// The events are written as they come, the file is complete after finish() (or the destruction).
+class ChromeTraceWriter : public UyatTraceEvents
+{
+public:
+  explicit ChromeTraceWriter(std::ostream& output);
+  ~ChromeTraceWriter() override;
+
+  void on_rx_frame(uint8_t command, std::size_t size, uint32_t first_byte_us, uint32_t handled_us) override;
+  void on_dispatch(uint8_t dp_number, std::size_t listener, uint32_t start_us, uint32_t end_us) override;
+  void on_tx_frame(uint8_t command, std::size_t size, uint32_t start_us, uint32_t end_us) override;
+  void on_response_wait(uint8_t command, uint32_t sent_us, uint32_t end_us, bool answered) override;
+
+  // closes the JSON, no more events are written
+  void finish();
+
+  std::size_t get_event_count() const
+  {
+    return this->events_;
+  }
+
+  static const char* command_name(uint8_t command);
+
+protected:
+  enum Track : uint8_t
+  {
+    TRACK_RX = 1,
+    TRACK_TX = 2,
+    TRACK_RESPONSE = 3,
+  };
+
+  // the core clock wraps around after 71 minutes, the trace doesn't
+  uint64_t unwrap_(uint32_t us);
+  void write_metadata_(const char* name, Track track, const char* value);
+  void write_span_(Track track, const std::string& name, uint64_t start_us, uint64_t end_us, const std::string& args);
+
+  std::ostream& output_;
+  std::size_t events_{0};
+  bool started_{false};
+  uint64_t last_us_{0};
+  uint64_t rx_end_us_{0};
+  bool finished_{false};
+};
+
+}
@@ -0,0 +1,113 @@
+#include "uyat_host_platform.h"
+
+#include <algorithm>
+
+namespace esphome::uyat::host
+{
+
+std::size_t QueueTransport::rx_available()
+{
+  return this->rx.size();
+}
+
+bool QueueTransport::rx_read(uint8_t& byte)
+{
+  if (this->rx.empty())
+  {
+    return false;
+  }
+  byte = this->rx.front();
+  this->rx.pop_front();
+  return true;
+}
+
+void QueueTransport::tx_write(const uint8_t* data, const std::size_t len)
+{
+  if (this->tx_sink_)
+  {
+    this->tx_sink_(data, len);
+  }
+}
+
+std::size_t QueueTransport::push(const std::vector<uint8_t>& bytes)
+{
+  const auto space = this->rx_capacity_ - std::min(this->rx_capacity_, this->rx.size());
+  const auto accepted = std::min(space, bytes.size());
+  this->rx.insert(this->rx.end(), bytes.begin(), bytes.begin() + accepted);
+  return bytes.size() - accepted;
+}
+
+void TimerQueue::start_timer(const char* name, const uint32_t delay_ms, const bool repeat, TimerCallback&& callback)
+{
+  this->stop_timer(name);
+  this->timers_.push_back(Timer{name, this->clock_.get_millis() + delay_ms, delay_ms, repeat, std::move(callback)});
+}
+
+void TimerQueue::stop_timer(const char* name)
+{
+  this->timers_.erase(std::remove_if(this->timers_.begin(), this->timers_.end(),
+                                     [name](const Timer& timer) { return timer.name == name; }),
+                      this->timers_.end());
+}
+
+std::size_t TimerQueue::run_due()
+{
+  const uint32_t now = this->clock_.get_millis();
+  // bounded, so that a repeating timer with 0 interval can't keep the caller here forever
+  const std::size_t max_runs = this->timers_.size();
+  std::size_t runs = 0u;
+  while (runs < max_runs)
+  {
+    auto next = this->timers_.end();
+    for (auto it = this->timers_.begin(); it != this->timers_.end(); ++it)
+    {
+      if (not_after_(it->due_ms, now) && ((next == this->timers_.end()) || not_after_(it->due_ms, next->due_ms)))
+      {
+        next = it;
+      }
+    }
+    if (next == this->timers_.end())
+    {
+      break;
+    }
+
+    // the callback can start and stop timers, including itself, so the timer is updated first
+    TimerCallback callback;
+    if (next->repeat)
+    {
+      next->due_ms += std::max<uint32_t>(next->interval_ms, 1u);
+      callback = next->callback;
+    }
+    else
+    {
+      callback = std::move(next->callback);
+      this->timers_.erase(next);
+    }
+    callback();
+    ++runs;
+  }
+  return runs;
+}
+
+std::optional<uint32_t> TimerQueue::get_next_due_in_ms() const
+{
+  if (this->timers_.empty())
+  {
+    return {};
+  }
+  const uint32_t now = this->clock_.get_millis();
+  uint32_t next_in = UINT32_MAX;
+  for (const auto& timer : this->timers_)
+  {
+    next_in = std::min(next_in, not_after_(timer.due_ms, now) ? 0u : (timer.due_ms - now));
+  }
+  return next_in;
+}
+
+bool TimerQueue::is_pending(const char* name) const
+{
+  return std::any_of(this->timers_.begin(), this->timers_.end(),
+                     [name](const Timer& timer) { return timer.name == name; });
+}
+
+}
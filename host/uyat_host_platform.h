@@ -0,0 +1,154 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "uyat_core.h"
+
+namespace esphome::uyat::host
+{
+
+// Wall clock time since the construction, from std::chrono::steady_clock.
+class SteadyClock : public UyatClock
+{
+public:
+  uint32_t get_millis() override
+  {
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed_()).count());
+  }
+
+  uint32_t get_micros() override
+  {
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed_()).count());
+  }
+
+private:
+  std::chrono::steady_clock::duration elapsed_() const
+  {
+    return std::chrono::steady_clock::now() - this->start_;
+  }
+
+  const std::chrono::steady_clock::time_point start_{std::chrono::steady_clock::now()};
+};
+
+// Clock which only moves when advanced, for the host programs running faster than real time.
+class ManualClock : public UyatClock
+{
+public:
+  uint32_t get_millis() override
+  {
+    return static_cast<uint32_t>(this->now_us_ / 1000u);
+  }
+
+  uint32_t get_micros() override
+  {
+    return static_cast<uint32_t>(this->now_us_);
+  }
+
+  void advance_ms(const uint32_t ms)
+  {
+    this->now_us_ += static_cast<uint64_t>(ms) * 1000u;
+  }
+
+  void advance_us(const uint32_t us)
+  {
+    this->now_us_ += us;
+  }
+
+private:
+  uint64_t now_us_{0};
+};
+
+// The uart of a host program: the bytes from the MCU are queued in rx, the written ones are passed to the
+// tx sink - dropped without one. The rx capacity bounds the queue like the rx buffer of a real uart.
+class QueueTransport : public UyatTransport
+{
+public:
+  using TxSink = std::function<void(const uint8_t* data, std::size_t len)>;
+
+  QueueTransport() = default;
+
+  explicit QueueTransport(TxSink tx_sink, const std::size_t rx_capacity = std::numeric_limits<std::size_t>::max()):
+  tx_sink_(std::move(tx_sink)),
+  rx_capacity_(rx_capacity)
+  {}
+
+  std::size_t rx_available() override;
+  bool rx_read(uint8_t& byte) override;
+  void tx_write(const uint8_t* data, std::size_t len) override;
+
+  // Queues bytes from the MCU, returns the number of bytes which didn't fit.
+  std::size_t push(const std::vector<uint8_t>& bytes);
+
+  void set_tx_sink(TxSink tx_sink)
+  {
+    this->tx_sink_ = std::move(tx_sink);
+  }
+
+  std::deque<uint8_t> rx;
+
+private:
+  TxSink tx_sink_;
+  std::size_t rx_capacity_{std::numeric_limits<std::size_t>::max()};
+};
+
+// UyatCore whose init state can be set, to start it past the init sequence like a module joining a running MCU.
+class InitStateCore : public UyatCore
+{
+public:
+  using UyatCore::UyatCore;
+
+  void set_init_state(const UyatInitState state)
+  {
+    this->init_state_ = state;
+  }
+};
+
+// Timers of a single threaded host program, run by calling run_due() from its main loop
+// (next to UyatCore::poll()).
+class TimerQueue : public UyatScheduler
+{
+public:
+  explicit TimerQueue(UyatClock& clock):
+  clock_(clock)
+  {}
+
+  void start_timer(const char* name, uint32_t delay_ms, bool repeat, TimerCallback&& callback) override;
+  void stop_timer(const char* name) override;
+
+  // Runs the callbacks of the timers which are due, in the order of their due time.
+  // Returns the number of callbacks run.
+  std::size_t run_due();
+
+  // Time until the next timer is due (0 if already due), none if there are no timers.
+  std::optional<uint32_t> get_next_due_in_ms() const;
+
+  bool is_pending(const char* name) const;
+
+private:
+  struct Timer
+  {
+    std::string name;
+    uint32_t due_ms;
+    uint32_t interval_ms;
+    bool repeat;
+    TimerCallback callback;
+  };
+
+  // the wrap around safe "a is before or at b"
+  static bool not_after_(const uint32_t a, const uint32_t b)
+  {
+    return static_cast<int32_t>(b - a) >= 0;
+  }
+
+  UyatClock& clock_;
+  std::vector<Timer> timers_;
+};
+
+}
@@ -0,0 +1,142 @@
+// Virtual TuyaMCU on a pseudo-terminal, for an ESPHome host build or any other module talking to a serial port.
+//
+//   uyat_mcu_sim [-l link_path] [-v] script.sim
+//
+// The slave side of the pseudo-terminal is printed on start, -l additionally links it to a fixed path
+// which can be used as the uart port of the module.
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "uyat_host_platform.h"
+#include "uyat_mcu_simulator.h"
+
+using namespace esphome::uyat;
+
+static const char* const TAG = "uyat.sim";
+
+static volatile std::sig_atomic_t stop_requested = 0;
+
+static void on_signal(int)
+{
+  stop_requested = 1;
+}
+
+static int usage(const char* program)
+{
+  fprintf(stderr, "usage: %s [-l link_path] [-v] script.sim\n", program);
+  return 2;
+}
+
+int main(int argc, char** argv)
+{
+  std::string link_path;
+  int opt;
+  host::set_log_level(ESPHOME_LOG_LEVEL_INFO);
+  while ((opt = getopt(argc, argv, "l:v")) != -1)
+  {
+    switch (opt)
+    {
+      case 'l':
+        link_path = optarg;
+        break;
+      case 'v':
+        host::set_log_level(ESPHOME_LOG_LEVEL_VERBOSE);
+        break;
+      default:
+        return usage(argv[0]);
+    }
+  }
+  if (optind != (argc - 1))
+  {
+    return usage(argv[0]);
+  }
+
+  std::string error;
+  auto script = host::McuScript::load(argv[optind], error);
+  if (!script.has_value())
+  {
+    fprintf(stderr, "%s: %s\n", argv[optind], error.c_str());
+    return 1;
+  }
+
+  const int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if ((master < 0) || (grantpt(master) != 0) || (unlockpt(master) != 0))
+  {
+    perror("posix_openpt");
+    return 1;
+  }
+  const char* slave_name = ptsname(master);
+  // kept open, otherwise reading the master fails with EIO whenever the module closes the port
+  const int slave = open(slave_name, O_RDWR | O_NOCTTY);
+  termios attributes{};
+  if ((slave < 0) || (tcgetattr(slave, &attributes) != 0))
+  {
+    perror(slave_name);
+    return 1;
+  }
+  cfmakeraw(&attributes);
+  tcsetattr(slave, TCSANOW, &attributes);
+
+  if (!link_path.empty())
+  {
+    unlink(link_path.c_str());
+    if (symlink(slave_name, link_path.c_str()) != 0)
+    {
+      perror(link_path.c_str());
+      return 1;
+    }
+  }
+  ESP_LOGI(TAG, "MCU on %s%s%s", slave_name, link_path.empty() ? "" : ", linked from ", link_path.c_str());
+
+  signal(SIGINT, on_signal);
+  signal(SIGTERM, on_signal);
+
+  host::SteadyClock clock;
+  host::McuSimulator simulator(std::move(*script), clock);
+  std::vector<uint8_t> out;
+  uint8_t buffer[256];
+
+  while (!stop_requested)
+  {
+    pollfd descriptor{master, POLLIN, 0};
+    if (poll(&descriptor, 1, 1) > 0)
+    {
+      const auto len = read(master, buffer, sizeof(buffer));
+      if (len > 0)
+      {
+        simulator.receive(buffer, static_cast<std::size_t>(len));
+      }
+    }
+
+    out.clear();
+    simulator.poll(out);
+    std::size_t written = 0u;
+    while (written < out.size())
+    {
+      const auto len = write(master, out.data() + written, out.size() - written);
+      if (len <= 0)
+      {
+        break;
+      }
+      written += static_cast<std::size_t>(len);
+    }
+  }
+
+  simulator.log_statistics();
+  if (!link_path.empty())
+  {
+    unlink(link_path.c_str());
+  }
+  close(slave);
+  close(master);
+  return 0;
+}
@@ -0,0 +1,912 @@
+#include "uyat_mcu_simulator.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace esphome::uyat::host
+{
+
+static const char* const TAG = "uyat.sim";
+static const uint8_t MCU_PROTOCOL_VERSION = 0x03;
+static const std::size_t FRAME_OVERHEAD = 7u;
+
+namespace
+{
+
+enum : uint8_t
+{
+  CMD_HEARTBEAT = 0x00,
+  CMD_PRODUCT_QUERY = 0x01,
+  CMD_CONF_QUERY = 0x02,
+  CMD_WIFI_STATE = 0x03,
+  CMD_WIFI_RESET = 0x04,
+  CMD_WIFI_SELECT = 0x05,
+  CMD_DATAPOINT_DELIVER = 0x06,
+  CMD_DATAPOINT_REPORT_ASYNC = 0x07,
+  CMD_DATAPOINT_QUERY = 0x08,
+  CMD_WIFI_TEST = 0x0E,
+  CMD_LOCAL_TIME_QUERY = 0x1C,
+  CMD_DATAPOINT_REPORT_SYNC = 0x22,
+  CMD_DATAPOINT_REPORT_ACK = 0x23,
+  CMD_WIFI_RSSI = 0x24,
+  CMD_GET_NETWORK_STATUS = 0x2B,
+  CMD_GET_MAC_ADDRESS = 0x2D,
+  CMD_EXTENDED_SERVICES = 0x34,
+};
+
+struct Token
+{
+  std::string text;
+  std::size_t offset;  // in the line, to get the rest of the line for string values
+};
+
+std::vector<Token> tokenize(const std::string& line)
+{
+  std::vector<Token> tokens;
+  std::size_t pos = 0u;
+  while (pos < line.size())
+  {
+    const auto start = line.find_first_not_of(" \t", pos);
+    if (start == std::string::npos)
+    {
+      break;
+    }
+    auto end = line.find_first_of(" \t", start);
+    if (end == std::string::npos)
+    {
+      end = line.size();
+    }
+    tokens.push_back(Token{line.substr(start, end - start), start});
+    pos = end;
+  }
+  return tokens;
+}
+
+// comments start with a '#' at the beginning of the line or after a whitespace
+std::string strip_comment(const std::string& line)
+{
+  for (std::size_t i = 0u; i < line.size(); ++i)
+  {
+    if ((line[i] == '#') && ((i == 0u) || (line[i - 1u] == ' ') || (line[i - 1u] == '\t')))
+    {
+      return line.substr(0u, i);
+    }
+  }
+  return line;
+}
+
+std::string trim(const std::string& text)
+{
+  const auto start = text.find_first_not_of(" \t\r");
+  if (start == std::string::npos)
+  {
+    return "";
+  }
+  const auto end = text.find_last_not_of(" \t\r");
+  return text.substr(start, end - start + 1u);
+}
+
+std::optional<int64_t> parse_number(const std::string& text)
+{
+  if (text.empty())
+  {
+    return {};
+  }
+  char* end = nullptr;
+  const long long value = strtoll(text.c_str(), &end, 0);
+  if (*end != 0)
+  {
+    return {};
+  }
+  return value;
+}
+
+std::optional<uint32_t> parse_uint(const std::string& text, const uint32_t max_value)
+{
+  const auto value = parse_number(text);
+  if (!value.has_value() || (*value < 0) || (*value > max_value))
+  {
+    return {};
+  }
+  return static_cast<uint32_t>(*value);
+}
+
+std::optional<double> parse_probability(const std::string& text)
+{
+  char* end = nullptr;
+  const double value = strtod(text.c_str(), &end);
+  if (text.empty() || (*end != 0) || (value < 0.0) || (value > 1.0))
+  {
+    return {};
+  }
+  return value;
+}
+
+std::optional<std::vector<uint8_t>> parse_hex_bytes(const std::string& text)
+{
+  if ((text.size() % 2u) != 0u)
+  {
+    return {};
+  }
+  std::vector<uint8_t> bytes(text.size() / 2u);
+  if (parse_hex(text.c_str(), text.size(), bytes.data(), bytes.size()) != text.size())
+  {
+    return {};
+  }
+  return bytes;
+}
+
+// "<type> <value>", the value of a string is the rest of the line
+std::optional<UyatDatapoint> parse_datapoint(const uint8_t number, const std::string& type, const std::string& value)
+{
+  if (type == "bool")
+  {
+    if ((value == "1") || (value == "true") || (value == "on"))
+    {
+      return UyatDatapoint{number, BoolDatapointValue{true}};
+    }
+    if ((value == "0") || (value == "false") || (value == "off"))
+    {
+      return UyatDatapoint{number, BoolDatapointValue{false}};
+    }
+    return {};
+  }
+  if (type == "value")
+  {
+    const auto parsed = parse_number(value);
+    if (!parsed.has_value() || (*parsed < INT32_MIN) || (*parsed > UINT32_MAX))
+    {
+      return {};
+    }
+    return UyatDatapoint{number, UIntDatapointValue{static_cast<uint32_t>(*parsed)}};
+  }
+  if (type == "enum")
+  {
+    const auto parsed = parse_uint(value, 0xFFu);
+    if (!parsed.has_value())
+    {
+      return {};
+    }
+    return UyatDatapoint{number, EnumDatapointValue{static_cast<uint8_t>(*parsed)}};
+  }
+  if (type == "bitmap")
+  {
+    const auto parsed = parse_uint(value, UINT32_MAX);
+    if (!parsed.has_value())
+    {
+      return {};
+    }
+    return UyatDatapoint{number, BitmapDatapointValue{*parsed}};
+  }
+  if (type == "string")
+  {
+    return UyatDatapoint{number, StringDatapointValue{value}};
+  }
+  if (type == "raw")
+  {
+    const auto parsed = parse_hex_bytes(value);
+    if (!parsed.has_value() || parsed->empty())
+    {
+      return {};
+    }
+    return UyatDatapoint{number, RawDatapointValue{*parsed}};
+  }
+  return {};
+}
+
+std::optional<McuScript::InitStep> parse_init_step(const std::string& text)
+{
+  if (text == "heartbeat")
+  {
+    return McuScript::InitStep::HEARTBEAT;
+  }
+  if (text == "product")
+  {
+    return McuScript::InitStep::PRODUCT;
+  }
+  if (text == "conf")
+  {
+    return McuScript::InitStep::CONF;
+  }
+  if (text == "wifi_state")
+  {
+    return McuScript::InitStep::WIFI_STATE;
+  }
+  if (text == "query")
+  {
+    return McuScript::InitStep::DATAPOINT_QUERY;
+  }
+  return {};
+}
+
+const UyatDatapoint* find_datapoint(const std::vector<UyatDatapoint>& datapoints, const uint8_t number)
+{
+  const auto it = std::find_if(datapoints.begin(), datapoints.end(),
+                               [number](const UyatDatapoint& dp) { return dp.number == number; });
+  return (it != datapoints.end()) ? &(*it) : nullptr;
+}
+
+// the tokens from index first on, the model is needed for the type of the SET values
+std::optional<McuScript::Action> parse_action(const std::vector<Token>& tokens, const std::size_t first,
+                                              const std::string& line, const std::vector<UyatDatapoint>& model,
+                                              std::string& error)
+{
+  if (tokens.size() <= first)
+  {
+    error = "missing action";
+    return {};
+  }
+  const auto& name = tokens[first].text;
+  const auto args = tokens.size() - first - 1u;
+  McuScript::Action action{};
+
+  auto parse_dp_number = [&](const std::size_t index) -> bool
+  {
+    const auto number = parse_uint(tokens[index].text, 0xFFu);
+    if (!number.has_value() || (find_datapoint(model, *number) == nullptr))
+    {
+      error = "unknown datapoint " + tokens[index].text + ", declare it with 'dp' first";
+      return false;
+    }
+    action.dp_number = static_cast<uint8_t>(*number);
+    return true;
+  };
+
+  if ((name == "set") && (args >= 2u))
+  {
+    action.type = McuScript::ActionType::SET;
+    if (!parse_dp_number(first + 1u))
+    {
+      return {};
+    }
+    const auto* declared = find_datapoint(model, action.dp_number);
+    static const char* const TYPE_NAMES[] = {"raw", "bool", "value", "string", "enum", "bitmap"};
+    const auto value = trim(line.substr(tokens[first + 2u].offset));
+    action.value = parse_datapoint(action.dp_number, TYPE_NAMES[declared->value.index()], value);
+    if (!action.value.has_value())
+    {
+      error = "invalid value '" + value + "' for datapoint " + tokens[first + 1u].text;
+      return {};
+    }
+    return action;
+  }
+  if ((name == "inc") && (args == 2u))
+  {
+    action.type = McuScript::ActionType::INC;
+    const auto delta = parse_number(tokens[first + 2u].text);
+    if (!parse_dp_number(first + 1u) || !delta.has_value())
+    {
+      error = error.empty() ? "invalid delta" : error;
+      return {};
+    }
+    action.delta = static_cast<int32_t>(*delta);
+    return action;
+  }
+  if (((name == "toggle") || (name == "report")) && (args == 1u))
+  {
+    action.type = (name == "toggle") ? McuScript::ActionType::TOGGLE : McuScript::ActionType::REPORT;
+    if (!parse_dp_number(first + 1u))
+    {
+      return {};
+    }
+    return action;
+  }
+  if ((name == "report_all") && (args == 0u))
+  {
+    action.type = McuScript::ActionType::REPORT_ALL;
+    return action;
+  }
+  if ((name == "wifi_reset") && (args == 0u))
+  {
+    action.type = McuScript::ActionType::WIFI_RESET;
+    return action;
+  }
+  if ((name == "wifi_select") && (args == 1u) &&
+      ((tokens[first + 1u].text == "ap") || (tokens[first + 1u].text == "smartconfig")))
+  {
+    action.type = McuScript::ActionType::WIFI_SELECT;
+    action.ap_mode = (tokens[first + 1u].text == "ap");
+    return action;
+  }
+  if ((name == "time_query") && (args == 0u))
+  {
+    action.type = McuScript::ActionType::TIME_QUERY;
+    return action;
+  }
+  if ((name == "send") && ((args == 1u) || (args == 2u)))
+  {
+    action.type = McuScript::ActionType::SEND;
+    const auto command = parse_hex_bytes(tokens[first + 1u].text);
+    const auto payload = (args == 2u) ? parse_hex_bytes(tokens[first + 2u].text) : std::vector<uint8_t>{};
+    if (!command.has_value() || (command->size() != 1u) || !payload.has_value())
+    {
+      error = "send expects a hex command byte and an optional hex payload";
+      return {};
+    }
+    action.command = command->front();
+    action.payload = *payload;
+    return action;
+  }
+
+  error = "unknown action or wrong arguments: " + name;
+  return {};
+}
+
+}
+
+std::optional<McuScript> McuScript::parse(std::istream& input, std::string& error)
+{
+  McuScript script{};
+  std::string raw_line;
+  std::size_t line_number = 0u;
+
+  auto fail = [&](const std::string& message) -> std::optional<McuScript>
+  {
+    error = "line " + std::to_string(line_number) + ": " + message;
+    return {};
+  };
+
+  while (std::getline(input, raw_line))
+  {
+    ++line_number;
+    const auto line = strip_comment(raw_line);
+    const auto tokens = tokenize(line);
+    if (tokens.empty())
+    {
+      continue;
+    }
+    const auto& keyword = tokens[0].text;
+    const auto args = tokens.size() - 1u;
+
+    if ((keyword == "product") && (args >= 1u))
+    {
+      script.product = trim(line.substr(tokens[1].offset));
+    }
+    else if ((keyword == "conf") && (args == 0u))
+    {
+      script.conf_pins.reset();
+    }
+    else if ((keyword == "conf") && (args == 2u))
+    {
+      const auto status_pin = parse_uint(tokens[1].text, 0xFFu);
+      const auto reset_pin = parse_uint(tokens[2].text, 0xFFu);
+      if (!status_pin.has_value() || !reset_pin.has_value())
+      {
+        return fail("invalid pin numbers");
+      }
+      script.conf_pins = std::make_pair(static_cast<uint8_t>(*status_pin), static_cast<uint8_t>(*reset_pin));
+    }
+    else if (((keyword == "baud") || (keyword == "delay") || (keyword == "jitter") || (keyword == "seed")) &&
+             (args == 1u))
+    {
+      const auto value = parse_uint(tokens[1].text, UINT32_MAX);
+      if (!value.has_value())
+      {
+        return fail("invalid number " + tokens[1].text);
+      }
+      auto& target = (keyword == "baud") ? script.baud_rate :
+                     (keyword == "delay") ? script.response_delay_ms :
+                     (keyword == "jitter") ? script.jitter_ms : script.seed;
+      target = *value;
+    }
+    else if (((keyword == "drop") || (keyword == "corrupt")) && (args == 1u))
+    {
+      const auto probability = parse_probability(tokens[1].text);
+      if (!probability.has_value())
+      {
+        return fail("probability must be between 0 and 1");
+      }
+      ((keyword == "drop") ? script.drop_probability : script.corrupt_probability) = *probability;
+    }
+    else if ((keyword == "fail") && (args == 2u))
+    {
+      const auto step = parse_init_step(tokens[1].text);
+      const auto count = parse_uint(tokens[2].text, UINT32_MAX);
+      if (!step.has_value() || !count.has_value())
+      {
+        return fail("expected: fail <heartbeat|product|conf|wifi_state|query> <count>");
+      }
+      script.init_failures[static_cast<std::size_t>(*step)] = *count;
+    }
+    else if ((keyword == "sync_reports") && (args == 0u))
+    {
+      script.sync_reports = true;
+    }
+    else if ((keyword == "dp") && (args >= 3u))
+    {
+      const auto number = parse_uint(tokens[1].text, 0xFFu);
+      if (!number.has_value())
+      {
+        return fail("invalid datapoint number " + tokens[1].text);
+      }
+      if (find_datapoint(script.datapoints, *number) != nullptr)
+      {
+        return fail("datapoint " + tokens[1].text + " declared twice");
+      }
+      const auto value = trim(line.substr(tokens[3].offset));
+      const auto datapoint = parse_datapoint(static_cast<uint8_t>(*number), tokens[2].text, value);
+      if (!datapoint.has_value())
+      {
+        return fail("invalid datapoint type or value");
+      }
+      script.datapoints.push_back(*datapoint);
+    }
+    else if (((keyword == "at") || (keyword == "every")) && (args >= 2u))
+    {
+      const auto time_ms = parse_uint(tokens[1].text, UINT32_MAX);
+      if (!time_ms.has_value() || ((keyword == "every") && (*time_ms == 0u)))
+      {
+        return fail("invalid time " + tokens[1].text);
+      }
+      std::string action_error;
+      const auto action = parse_action(tokens, 2u, line, script.datapoints, action_error);
+      if (!action.has_value())
+      {
+        return fail(action_error);
+      }
+      script.schedule.push_back(ScheduledAction{*time_ms, (keyword == "every") ? *time_ms : 0u, *action});
+    }
+    else
+    {
+      return fail("unknown statement or wrong arguments: " + keyword);
+    }
+  }
+  return script;
+}
+
+std::optional<McuScript> McuScript::load(const std::string& path, std::string& error)
+{
+  std::ifstream input(path);
+  if (!input)
+  {
+    error = "can't open " + path;
+    return {};
+  }
+  return parse(input, error);
+}
+
+McuSimulator::McuSimulator(McuScript script, UyatClock& clock):
+script_(std::move(script)),
+clock_(clock),
+random_(script_.seed),
+start_ms_(clock.get_millis()),
+init_failures_left_(script_.init_failures)
+{}
+
+void McuSimulator::receive(const uint8_t* data, const std::size_t len)
+{
+  this->rx_buffer_.insert(this->rx_buffer_.end(), data, data + len);
+
+  while (this->rx_buffer_.size() >= FRAME_OVERHEAD)
+  {
+    if ((this->rx_buffer_[0] != 0x55) || (this->rx_buffer_[1] != 0xAA))
+    {
+      this->rx_buffer_.erase(this->rx_buffer_.begin());
+      ++this->statistics_.garbage_bytes;
+      continue;
+    }
+    const std::size_t length = encode_uint16(this->rx_buffer_[4], this->rx_buffer_[5]);
+    if (this->rx_buffer_.size() < (length + FRAME_OVERHEAD))
+    {
+      return;
+    }
+    uint8_t checksum = 0u;
+    for (std::size_t i = 0u; i < (length + 6u); ++i)
+    {
+      checksum += this->rx_buffer_[i];
+    }
+    if (checksum != this->rx_buffer_[length + 6u])
+    {
+      ESP_LOGW(TAG, "Checksum error in frame from the module");
+      ++this->statistics_.checksum_errors;
+      this->rx_buffer_.erase(this->rx_buffer_.begin());
+      continue;
+    }
+
+    const uint8_t command = this->rx_buffer_[3];
+    const std::vector<uint8_t> payload(this->rx_buffer_.begin() + 6, this->rx_buffer_.begin() + 6 + length);
+    this->rx_buffer_.erase(this->rx_buffer_.begin(), this->rx_buffer_.begin() + length + FRAME_OVERHEAD);
+    this->handle_frame_(command, payload);
+  }
+}
+
+void McuSimulator::poll(std::vector<uint8_t>& out)
+{
+  const uint32_t now_ms = this->clock_.get_millis() - this->start_ms_;
+  auto& schedule = this->script_.schedule;
+  for (std::size_t i = 0u; i < schedule.size();)
+  {
+    auto& scheduled = schedule[i];
+    if (static_cast<int32_t>(now_ms - scheduled.at_ms) < 0)
+    {
+      ++i;
+      continue;
+    }
+    this->run_action_(scheduled.action);
+    if (scheduled.period_ms > 0u)
+    {
+      scheduled.at_ms += scheduled.period_ms;
+      ++i;
+    }
+    else
+    {
+      schedule.erase(schedule.begin() + i);
+    }
+  }
+
+  const uint32_t now_us = this->clock_.get_micros();
+  this->move_due_frames_(now_us);
+  while (!this->line_.empty() && (static_cast<int32_t>(now_us - this->line_.front().release_us) >= 0))
+  {
+    out.push_back(this->line_.front().value);
+    this->line_.pop_front();
+  }
+}
+
+std::optional<uint32_t> McuSimulator::get_next_action_in_ms() const
+{
+  if (this->script_.schedule.empty())
+  {
+    return {};
+  }
+  const uint32_t now_ms = this->clock_.get_millis() - this->start_ms_;
+  uint32_t next_in = UINT32_MAX;
+  for (const auto& scheduled : this->script_.schedule)
+  {
+    const auto in = static_cast<int32_t>(scheduled.at_ms - now_ms);
+    next_in = std::min(next_in, (in < 0) ? 0u : static_cast<uint32_t>(in));
+  }
+  return next_in;
+}
+
+void McuSimulator::send_frame(const uint8_t command, const std::vector<uint8_t>& payload)
+{
+  std::vector<uint8_t> frame{0x55, 0xAA, MCU_PROTOCOL_VERSION, command, static_cast<uint8_t>(payload.size() >> 8),
+                             static_cast<uint8_t>(payload.size())};
+  frame.insert(frame.end(), payload.begin(), payload.end());
+  uint8_t checksum = 0u;
+  for (const auto byte : frame)
+  {
+    checksum += byte;
+  }
+  frame.push_back(checksum);
+
+  uint32_t delay_ms = this->script_.response_delay_ms;
+  if (this->script_.jitter_ms > 0u)
+  {
+    delay_ms += std::uniform_int_distribution<uint32_t>(0u, this->script_.jitter_ms)(this->random_);
+  }
+  uint32_t due_us = this->clock_.get_micros() + (delay_ms * 1000u);
+  // the MCU answers in order, the jitter can't reorder the frames
+  if (!this->pending_.empty() && (static_cast<int32_t>(due_us - this->last_due_us_) < 0))
+  {
+    due_us = this->last_due_us_;
+  }
+  this->last_due_us_ = due_us;
+
+  ESP_LOGV(TAG, "Sending CMD=0x%02X DATA=[%s] in %ums", command, format_hex_pretty(payload).c_str(), delay_ms);
+  ++this->statistics_.frames_sent;
+  this->pending_.push_back(PendingFrame{due_us, std::move(frame)});
+}
+
+void McuSimulator::set_datapoint(const UyatDatapoint& datapoint, const bool report)
+{
+  auto& model = this->script_.datapoints;
+  auto it = std::find_if(model.begin(), model.end(),
+                         [&datapoint](const UyatDatapoint& dp) { return dp.number == datapoint.number; });
+  if (it == model.end())
+  {
+    model.push_back(datapoint);
+  }
+  else
+  {
+    *it = datapoint;
+  }
+  if (report)
+  {
+    this->report_datapoint(datapoint.number);
+  }
+}
+
+void McuSimulator::report_datapoint(const uint8_t dp_number)
+{
+  const auto* datapoint = find_datapoint(this->script_.datapoints, dp_number);
+  if (datapoint == nullptr)
+  {
+    ESP_LOGW(TAG, "Datapoint %u is not in the model", dp_number);
+    return;
+  }
+  const auto value = datapoint->value_to_payload();
+  std::vector<uint8_t> payload{datapoint->number, static_cast<uint8_t>(datapoint->get_type()),
+                               static_cast<uint8_t>(value.size() >> 8), static_cast<uint8_t>(value.size())};
+  payload.insert(payload.end(), value.begin(), value.end());
+  ++this->statistics_.datapoints_reported;
+  this->send_frame(this->script_.sync_reports ? CMD_DATAPOINT_REPORT_SYNC : CMD_DATAPOINT_REPORT_ASYNC, payload);
+}
+
+void McuSimulator::report_all_datapoints()
+{
+  // a single frame, like the answer to DATAPOINT_QUERY of most MCUs
+  std::vector<uint8_t> payload;
+  for (const auto& datapoint : this->script_.datapoints)
+  {
+    const auto value = datapoint.value_to_payload();
+    payload.insert(payload.end(), {datapoint.number, static_cast<uint8_t>(datapoint.get_type()),
+                                   static_cast<uint8_t>(value.size() >> 8), static_cast<uint8_t>(value.size())});
+    payload.insert(payload.end(), value.begin(), value.end());
+    ++this->statistics_.datapoints_reported;
+  }
+  if (!payload.empty())
+  {
+    this->send_frame(this->script_.sync_reports ? CMD_DATAPOINT_REPORT_SYNC : CMD_DATAPOINT_REPORT_ASYNC, payload);
+  }
+}
+
+std::optional<UyatDatapoint> McuSimulator::get_datapoint(const uint8_t dp_number) const
+{
+  const auto* datapoint = find_datapoint(this->script_.datapoints, dp_number);
+  if (datapoint == nullptr)
+  {
+    return {};
+  }
+  return *datapoint;
+}
+
+void McuSimulator::log_statistics() const
+{
+  const auto& stats = this->statistics_;
+  ESP_LOGI(TAG, "Frames received: %u, sent: %u, checksum errors: %u, garbage bytes: %u", stats.frames_received,
+           stats.frames_sent, stats.checksum_errors, stats.garbage_bytes);
+  ESP_LOGI(TAG, "Datapoints delivered: %u, reported: %u, sync reports acked: %u", stats.datapoints_delivered,
+           stats.datapoints_reported, stats.sync_reports_acked);
+  ESP_LOGI(TAG, "Ignored init commands: %u, bytes dropped: %u, bytes corrupted: %u", stats.ignored_init_commands,
+           stats.bytes_dropped, stats.bytes_corrupted);
+  for (std::size_t command = 0u; command < stats.received_commands.size(); ++command)
+  {
+    if (stats.received_commands[command] > 0u)
+    {
+      ESP_LOGI(TAG, "  CMD 0x%02X received %u times", static_cast<unsigned>(command), stats.received_commands[command]);
+    }
+  }
+}
+
+void McuSimulator::handle_frame_(const uint8_t command, const std::vector<uint8_t>& payload)
+{
+  ESP_LOGV(TAG, "Received CMD=0x%02X DATA=[%s]", command, format_hex_pretty(payload).c_str());
+  ++this->statistics_.frames_received;
+  ++this->statistics_.received_commands[command];
+  if (this->record_received_frames_)
+  {
+    this->received_frames_.push_back(ReceivedFrame{this->clock_.get_millis() - this->start_ms_, command, payload});
+  }
+
+  switch (command)
+  {
+    case CMD_HEARTBEAT:
+      if (!this->fail_init_step_(McuScript::InitStep::HEARTBEAT))
+      {
+        // the first answer after a restart is 0x00
+        this->send_frame(CMD_HEARTBEAT, {static_cast<uint8_t>(this->heartbeat_answered_ ? 0x01 : 0x00)});
+        this->heartbeat_answered_ = true;
+      }
+      break;
+    case CMD_PRODUCT_QUERY:
+      if (!this->fail_init_step_(McuScript::InitStep::PRODUCT))
+      {
+        this->send_frame(CMD_PRODUCT_QUERY, std::vector<uint8_t>(this->script_.product.begin(),
+                                                                 this->script_.product.end()));
+      }
+      break;
+    case CMD_CONF_QUERY:
+      if (!this->fail_init_step_(McuScript::InitStep::CONF))
+      {
+        if (this->script_.conf_pins.has_value())
+        {
+          this->send_frame(CMD_CONF_QUERY, {this->script_.conf_pins->first, this->script_.conf_pins->second});
+        }
+        else
+        {
+          this->send_frame(CMD_CONF_QUERY, {});
+        }
+      }
+      break;
+    case CMD_WIFI_STATE:
+      if (!payload.empty())
+      {
+        this->wifi_status_ = payload[0];
+        ESP_LOGD(TAG, "WiFi status %u", payload[0]);
+      }
+      if (!this->fail_init_step_(McuScript::InitStep::WIFI_STATE))
+      {
+        this->send_frame(CMD_WIFI_STATE, {});
+      }
+      break;
+    case CMD_WIFI_RESET:
+    case CMD_WIFI_SELECT:
+      ESP_LOGI(TAG, "Module acknowledged %s", (command == CMD_WIFI_RESET) ? "WIFI_RESET" : "WIFI_SELECT");
+      break;
+    case CMD_DATAPOINT_DELIVER:
+      this->handle_deliver_(payload);
+      break;
+    case CMD_DATAPOINT_QUERY:
+      if (!this->fail_init_step_(McuScript::InitStep::DATAPOINT_QUERY))
+      {
+        this->report_all_datapoints();
+      }
+      break;
+    case CMD_DATAPOINT_REPORT_ACK:
+      ++this->statistics_.sync_reports_acked;
+      break;
+    case CMD_LOCAL_TIME_QUERY:
+      if ((payload.size() == 8u) && (payload[0] == 0x01))
+      {
+        ESP_LOGI(TAG, "Local time: 20%02u-%02u-%02u %02u:%02u:%02u, day of week %u", payload[1], payload[2],
+                 payload[3], payload[4], payload[5], payload[6], payload[7]);
+      }
+      else
+      {
+        ESP_LOGI(TAG, "Module has no valid local time");
+      }
+      break;
+    case CMD_WIFI_TEST:
+    case CMD_WIFI_RSSI:
+    case CMD_GET_NETWORK_STATUS:
+    case CMD_GET_MAC_ADDRESS:
+      ESP_LOGI(TAG, "Response to CMD=0x%02X: [%s]", command, format_hex_pretty(payload).c_str());
+      break;
+    case CMD_EXTENDED_SERVICES:
+      if (!payload.empty() && (payload[0] == 0x05))
+      {
+        // factory reset requested by the module, acked with the subcommand alone
+        ESP_LOGI(TAG, "Factory reset requested, type %u", (payload.size() > 1u) ? payload[1] : 0u);
+        this->send_frame(CMD_EXTENDED_SERVICES, {0x05});
+      }
+      else
+      {
+        ESP_LOGI(TAG, "Extended services response: [%s]", format_hex_pretty(payload).c_str());
+      }
+      break;
+    default:
+      ESP_LOGW(TAG, "Unexpected CMD=0x%02X from the module", command);
+      break;
+  }
+}
+
+void McuSimulator::handle_deliver_(const std::vector<uint8_t>& payload)
+{
+  const std::deque<uint8_t> buffer(payload.begin(), payload.end());
+  std::size_t offset = 0u;
+  while (offset < buffer.size())
+  {
+    std::size_t used_len = 0u;
+    const auto datapoint = UyatDatapoint::construct(buffer, offset, buffer.size() - offset, used_len);
+    offset += std::max<std::size_t>(used_len, 1u);
+    if (!datapoint.has_value())
+    {
+      ESP_LOGW(TAG, "Malformed datapoint in DATAPOINT_DELIVER: [%s]", format_hex_pretty(payload).c_str());
+      continue;
+    }
+
+    ++this->statistics_.datapoints_delivered;
+    const auto current = this->get_datapoint(datapoint->number);
+    if (!current.has_value())
+    {
+      ESP_LOGW(TAG, "Module set unknown datapoint %u", datapoint->number);
+      continue;
+    }
+    if (current->get_type() != datapoint->get_type())
+    {
+      ESP_LOGW(TAG, "Module set datapoint %u as %s, it is %s", datapoint->number, datapoint->get_type_name(),
+               current->get_type_name());
+      continue;
+    }
+    ESP_LOGD(TAG, "Module set %s", datapoint->to_string().c_str());
+    // real MCUs confirm the new value with a report
+    this->set_datapoint(*datapoint, true);
+  }
+}
+
+bool McuSimulator::fail_init_step_(const McuScript::InitStep step)
+{
+  auto& left = this->init_failures_left_[static_cast<std::size_t>(step)];
+  if (left == 0u)
+  {
+    return false;
+  }
+  --left;
+  ++this->statistics_.ignored_init_commands;
+  ESP_LOGI(TAG, "Ignoring init command (%u more to ignore)", left);
+  return true;
+}
+
+void McuSimulator::run_action_(const McuScript::Action& action)
+{
+  switch (action.type)
+  {
+    case McuScript::ActionType::SET:
+      this->set_datapoint(*action.value, true);
+      break;
+    case McuScript::ActionType::INC:
+    {
+      auto datapoint = this->get_datapoint(action.dp_number);
+      auto* value = std::get_if<UIntDatapointValue>(&datapoint->value);
+      if (value == nullptr)
+      {
+        ESP_LOGW(TAG, "inc needs a value datapoint, %u is %s", action.dp_number, datapoint->get_type_name());
+        break;
+      }
+      value->value += static_cast<uint32_t>(action.delta);
+      this->set_datapoint(*datapoint, true);
+      break;
+    }
+    case McuScript::ActionType::TOGGLE:
+    {
+      auto datapoint = this->get_datapoint(action.dp_number);
+      auto* value = std::get_if<BoolDatapointValue>(&datapoint->value);
+      if (value == nullptr)
+      {
+        ESP_LOGW(TAG, "toggle needs a bool datapoint, %u is %s", action.dp_number, datapoint->get_type_name());
+        break;
+      }
+      value->value = !value->value;
+      this->set_datapoint(*datapoint, true);
+      break;
+    }
+    case McuScript::ActionType::REPORT:
+      this->report_datapoint(action.dp_number);
+      break;
+    case McuScript::ActionType::REPORT_ALL:
+      this->report_all_datapoints();
+      break;
+    case McuScript::ActionType::WIFI_RESET:
+      this->send_frame(CMD_WIFI_RESET, {});
+      break;
+    case McuScript::ActionType::WIFI_SELECT:
+      this->send_frame(CMD_WIFI_SELECT, {static_cast<uint8_t>(action.ap_mode ? 0x01 : 0x00)});
+      break;
+    case McuScript::ActionType::TIME_QUERY:
+      this->send_frame(CMD_LOCAL_TIME_QUERY, {});
+      break;
+    case McuScript::ActionType::SEND:
+      this->send_frame(action.command, action.payload);
+      break;
+  }
+}
+
+void McuSimulator::move_due_frames_(const uint32_t now_us)
+{
+  const uint32_t byte_time_us = (this->script_.baud_rate > 0u) ? (10000000u / this->script_.baud_rate) : 0u;
+  std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+  while (!this->pending_.empty() && (static_cast<int32_t>(now_us - this->pending_.front().due_us) >= 0))
+  {
+    const auto frame = std::move(this->pending_.front());
+    this->pending_.pop_front();
+
+    uint32_t release_us = frame.due_us;
+    if ((byte_time_us > 0u) && (static_cast<int32_t>(this->line_free_us_ - release_us) > 0))
+    {
+      release_us = this->line_free_us_;  // the line is still busy with the previous frame
+    }
+    for (auto value : frame.bytes)
+    {
+      if ((this->script_.drop_probability > 0.0) && (chance(this->random_) < this->script_.drop_probability))
+      {
+        ++this->statistics_.bytes_dropped;
+        continue;
+      }
+      if ((this->script_.corrupt_probability > 0.0) && (chance(this->random_) < this->script_.corrupt_probability))
+      {
+        value ^= static_cast<uint8_t>(1u << std::uniform_int_distribution<int>(0, 7)(this->random_));
+        ++this->statistics_.bytes_corrupted;
+      }
+      release_us += byte_time_us;
+      this->line_.push_back(LineByte{release_us, value});
+    }
+    this->line_free_us_ = release_us;
+  }
+}
+
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "uyat_core.h"
+
+namespace esphome::uyat::host
+{
+
+// The MCU side of the protocol, driven by a script. See host/scenarios/example.sim for the syntax.
+struct McuScript
+{
+  enum class ActionType : uint8_t
+  {
+    SET,          // set a datapoint of the model and report it
+    INC,          // add to a value datapoint and report it
+    TOGGLE,       // negate a bool datapoint and report it
+    REPORT,       // report a datapoint
+    REPORT_ALL,
+    WIFI_RESET,
+    WIFI_SELECT,
+    TIME_QUERY,
+    SEND,         // any frame
+  };
+
+  struct Action
+  {
+    ActionType type;
+    uint8_t dp_number{0};
+    std::optional<UyatDatapoint> value{};  // SET
+    int32_t delta{0};                       // INC
+    bool ap_mode{false};                    // WIFI_SELECT
+    uint8_t command{0};                     // SEND
+    std::vector<uint8_t> payload{};         // SEND
+  };
+
+  struct ScheduledAction
+  {
+    uint32_t at_ms;
+    uint32_t period_ms;  // 0 for a single run
+    Action action;
+  };
+
+  // the init commands which can be set to fail (left unanswered) for a number of times
+  enum class InitStep : uint8_t
+  {
+    HEARTBEAT,
+    PRODUCT,
+    CONF,
+    WIFI_STATE,
+    DATAPOINT_QUERY,
+    NUM_STEPS,
+  };
+
+  std::string product{R"({"p":"uyat.simulator","v":"1.0.0","m":0})"};
+  // pins reported in the CONF_QUERY response, none if the module reports the WiFi state
+  std::optional<std::pair<uint8_t, uint8_t>> conf_pins{};
+  uint32_t baud_rate{0};  // 0: no pacing, the bytes are written as soon as the frame is due
+  uint32_t response_delay_ms{0};
+  uint32_t jitter_ms{0};
+  double drop_probability{0.0};
+  double corrupt_probability{0.0};
+  uint32_t seed{1};
+  bool sync_reports{false};
+  std::array<uint32_t, static_cast<std::size_t>(InitStep::NUM_STEPS)> init_failures{};
+  std::vector<UyatDatapoint> datapoints{};
+  std::vector<ScheduledAction> schedule{};
+
+  static std::optional<McuScript> parse(std::istream& input, std::string& error);
+  static std::optional<McuScript> load(const std::string& path, std::string& error);
+};
+
+class McuSimulator
+{
+public:
+  struct Statistics
+  {
+    uint32_t frames_received{0};
+    uint32_t frames_sent{0};
+    uint32_t checksum_errors{0};
+    uint32_t garbage_bytes{0};
+    uint32_t ignored_init_commands{0};
+    uint32_t datapoints_delivered{0};
+    uint32_t datapoints_reported{0};
+    uint32_t sync_reports_acked{0};
+    uint32_t bytes_dropped{0};
+    uint32_t bytes_corrupted{0};
+    std::array<uint32_t, 256> received_commands{};
+  };
+
+  struct ReceivedFrame
+  {
+    uint32_t at_ms;  // from the simulator start
+    uint8_t command;
+    std::vector<uint8_t> payload;
+  };
+
+  McuSimulator(McuScript script, UyatClock& clock);
+
+  // bytes written by the module
+  void receive(const uint8_t* data, std::size_t len);
+  // runs the due script actions and appends the bytes due on the line to out
+  void poll(std::vector<uint8_t>& out);
+
+  // queues a frame to the module, after the configured response delay
+  void send_frame(uint8_t command, const std::vector<uint8_t>& payload);
+  void set_datapoint(const UyatDatapoint& datapoint, bool report);
+  void report_datapoint(uint8_t dp_number);
+  void report_all_datapoints();
+  std::optional<UyatDatapoint> get_datapoint(uint8_t dp_number) const;
+
+  // the last status reported by WIFI_STATE, none before the first one
+  std::optional<uint8_t> get_wifi_status() const
+  {
+    return this->wifi_status_;
+  }
+
+  // bytes still waiting for their time to be written
+  bool is_idle() const
+  {
+    return this->pending_.empty() && this->line_.empty();
+  }
+
+  // time until the next scheduled action is due (0 if already due), none if there are no more
+  std::optional<uint32_t> get_next_action_in_ms() const;
+
+  const Statistics& get_statistics() const
+  {
+    return this->statistics_;
+  }
+
+  // keeps the frames received from the module, off by default as the simulator of the pty runs for long
+  void set_record_received_frames(const bool record)
+  {
+    this->record_received_frames_ = record;
+  }
+
+  const std::vector<ReceivedFrame>& get_received_frames() const
+  {
+    return this->received_frames_;
+  }
+
+  void log_statistics() const;
+
+protected:
+  struct PendingFrame
+  {
+    uint32_t due_us;
+    std::vector<uint8_t> bytes;
+  };
+
+  struct LineByte
+  {
+    uint32_t release_us;
+    uint8_t value;
+  };
+
+  void handle_frame_(uint8_t command, const std::vector<uint8_t>& payload);
+  void handle_deliver_(const std::vector<uint8_t>& payload);
+  bool fail_init_step_(McuScript::InitStep step);
+  void run_action_(const McuScript::Action& action);
+  void move_due_frames_(uint32_t now_us);
+
+  McuScript script_;
+  UyatClock& clock_;
+  std::mt19937 random_;
+  const uint32_t start_ms_;
+  std::vector<uint8_t> rx_buffer_;
+  std::deque<PendingFrame> pending_;
+  std::deque<LineByte> line_;
+  uint32_t last_due_us_{0};
+  uint32_t line_free_us_{0};
+  bool heartbeat_answered_{false};
+  std::optional<uint8_t> wifi_status_{};
+  std::array<uint32_t, static_cast<std::size_t>(McuScript::InitStep::NUM_STEPS)> init_failures_left_{};
+  Statistics statistics_{};
+  bool record_received_frames_{false};
+  std::vector<ReceivedFrame> received_frames_;
+};
+
+}
@@ -0,0 +1,467 @@
+#include "uyat_replay.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+
+#include "uyat_frame_trace.h"
+#include "uyat_host_platform.h"
+
+namespace esphome::uyat::host
+{
+
+static const char* const TAG = "uyat.replay";
+
+namespace
+{
+
+std::optional<std::vector<uint8_t>> parse_hex_text(const std::string& text)
+{
+  std::string digits;
+  for (std::size_t i = 0u; i < text.size(); ++i)
+  {
+    const char c = text[i];
+    if ((c == '0') && ((i + 1u) < text.size()) && ((text[i + 1u] == 'x') || (text[i + 1u] == 'X')))
+    {
+      ++i;
+      continue;
+    }
+    if (std::isxdigit(static_cast<unsigned char>(c)))
+    {
+      digits.push_back(c);
+    }
+    else if ((c != ' ') && (c != '\t') && (c != ':') && (c != '.') && (c != ',') && (c != '-') && (c != '\r'))
+    {
+      return {};
+    }
+  }
+  if ((digits.size() % 2u) != 0u)
+  {
+    return {};
+  }
+  std::vector<uint8_t> bytes(digits.size() / 2u);
+  parse_hex(digits.c_str(), digits.size(), bytes.data(), bytes.size());
+  return bytes;
+}
+
+// "1200" (ms) or "12:00:01" / "12:00:01.234" (time of day)
+std::optional<uint32_t> parse_timestamp(const std::string& text)
+{
+  char* end = nullptr;
+  if (text.find(':') == std::string::npos)
+  {
+    const unsigned long ms = strtoul(text.c_str(), &end, 10);
+    return (!text.empty() && (*end == 0)) ? std::optional<uint32_t>(ms) : std::nullopt;
+  }
+  unsigned hours = 0u, minutes = 0u, seconds = 0u, millis = 0u;
+  int consumed = 0;
+  if (sscanf(text.c_str(), "%u:%u:%u%n", &hours, &minutes, &seconds, &consumed) != 3)
+  {
+    return {};
+  }
+  if (text[consumed] == '.')
+  {
+    const auto fraction = text.substr(consumed + 1u);
+    if (fraction.empty() || (fraction.size() > 3u) ||
+        (fraction.find_first_not_of("0123456789") != std::string::npos))
+    {
+      return {};
+    }
+    millis = static_cast<unsigned>(strtoul((fraction + std::string(3u - fraction.size(), '0')).c_str(), nullptr, 10));
+  }
+  else if (text[consumed] != 0)
+  {
+    return {};
+  }
+  return ((((hours * 60u) + minutes) * 60u) + seconds) * 1000u + millis;
+}
+
+// the core with its platform, wired for a replay
+struct ReplayRig
+{
+  ReplayRig(UyatClock& clock, const CaptureReplay::Options& options, std::vector<CaptureReplay::TimelineEntry>& timeline,
+            CaptureReplay::Statistics& statistics):
+  clock(clock),
+  timeline(timeline),
+  statistics(statistics),
+  timers(clock),
+  core(transport, clock, timers)
+  {
+    if (options.record_timeline)
+    {
+      for (unsigned number = 0u; number <= 0xFFu; ++number)
+      {
+        this->core.register_datapoint_listener(MatchingDatapoint{.number = static_cast<uint8_t>(number), .types = {}},
+                                               [this](const UyatDatapoint& datapoint) { this->on_datapoint(datapoint); });
+      }
+    }
+    this->core.register_frame_end_listener([this] { ++this->statistics.datapoint_frames; });
+    if (!options.from_boot)
+    {
+      this->core.set_init_state(UyatInitState::INIT_DONE);
+    }
+#ifdef UYAT_TRACE_EVENTS_ENABLED
+    this->core.set_trace_events(options.trace_events);
+#endif
+    this->core.start();
+  }
+
+  void on_datapoint(const UyatDatapoint& datapoint)
+  {
+    auto& last = this->last_values[datapoint.number];
+    if (!last.has_value() || !(last->value == datapoint.value))
+    {
+      last = datapoint;
+      this->timeline.push_back(CaptureReplay::TimelineEntry{this->clock.get_millis(), datapoint});
+    }
+  }
+
+  UyatClock& clock;
+  std::vector<CaptureReplay::TimelineEntry>& timeline;
+  CaptureReplay::Statistics& statistics;
+  // the MCU of a recording doesn't listen
+  host::QueueTransport transport;
+  TimerQueue timers;
+  host::InitStateCore core;
+  std::array<std::optional<UyatDatapoint>, 256> last_values{};
+};
+
+void poll_measured(ReplayRig& rig, TimingHistogram& poll_us)
+{
+  if (rig.transport.rx.empty())
+  {
+    rig.core.poll();
+    return;
+  }
+  const auto start = std::chrono::steady_clock::now();
+  rig.core.poll();
+  poll_us.add(static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count()));
+}
+
+}
+
+std::size_t Capture::get_total_bytes() const
+{
+  std::size_t total = 0u;
+  for (const auto& chunk : this->chunks)
+  {
+    total += chunk.bytes.size();
+  }
+  return total;
+}
+
+std::optional<Capture> Capture::parse_hex_log(std::istream& input, std::string& error)
+{
+  Capture capture;
+  std::optional<uint32_t> first_ms;
+  uint32_t last_ms = 0u;
+  std::string line;
+  std::size_t line_number = 0u;
+
+  while (std::getline(input, line))
+  {
+    ++line_number;
+    line = line.substr(0u, line.find('#'));
+    if (line.find(">>>") != std::string::npos)
+    {
+      continue;  // sent to the MCU
+    }
+
+    std::optional<uint32_t> timestamp;
+    std::string data = line;
+    const auto start = line.find_first_not_of(" \t");
+    if ((start != std::string::npos) && (line[start] == '['))
+    {
+      const auto close = line.find(']', start);
+      if (close == std::string::npos)
+      {
+        error = "line " + std::to_string(line_number) + ": unterminated time";
+        return {};
+      }
+      timestamp = parse_timestamp(line.substr(start + 1u, close - start - 1u));
+      if (!timestamp.has_value())
+      {
+        error = "line " + std::to_string(line_number) + ": invalid time " + line.substr(start, close - start + 1u);
+        return {};
+      }
+      data = line.substr(close + 1u);
+    }
+    const auto marker = data.find("<<<");
+    if (marker != std::string::npos)
+    {
+      data = data.substr(marker + 3u);
+    }
+    else if ((data.find("]:") != std::string::npos) || (data.find_first_not_of(" \t\r") == std::string::npos))
+    {
+      continue;  // some other log line, or nothing
+    }
+
+    const auto bytes = parse_hex_text(data);
+    if (!bytes.has_value())
+    {
+      error = "line " + std::to_string(line_number) + ": invalid hex data";
+      return {};
+    }
+    if (bytes->empty())
+    {
+      continue;
+    }
+
+    if (timestamp.has_value())
+    {
+      if (!first_ms.has_value())
+      {
+        first_ms = *timestamp;
+      }
+      // the time of day wraps at midnight, the order of the lines is what matters
+      last_ms = std::max(last_ms, *timestamp - std::min(*first_ms, *timestamp));
+    }
+    if (!capture.chunks.empty() && (capture.chunks.back().at_ms == last_ms))
+    {
+      auto& previous = capture.chunks.back().bytes;
+      previous.insert(previous.end(), bytes->begin(), bytes->end());
+    }
+    else
+    {
+      capture.chunks.push_back(Chunk{last_ms, *bytes});
+    }
+  }
+  return capture;
+}
+
+std::optional<Capture> Capture::parse_frame_trace(const std::vector<uint8_t>& encoded, std::string& error)
+{
+  if ((encoded.size() < FrameTrace::HEADER_SIZE) || (encoded[0] != 'U') || (encoded[1] != 'T'))
+  {
+    error = "not a frame trace";
+    return {};
+  }
+  if (encoded[2] != FrameTrace::FORMAT_VERSION)
+  {
+    error = "unsupported frame trace version " + std::to_string(encoded[2]);
+    return {};
+  }
+  const std::size_t payload_bytes = encoded[3];
+  const std::size_t count = encode_uint16(encoded[4], encoded[5]);
+
+  Capture capture;
+  std::optional<uint32_t> first_ms;
+  std::size_t pos = FrameTrace::HEADER_SIZE;
+  for (std::size_t i = 0u; i < count; ++i)
+  {
+    if ((pos + FrameTrace::FRAME_HEADER_SIZE) > encoded.size())
+    {
+      error = "frame trace truncated at frame " + std::to_string(i);
+      return {};
+    }
+    const uint32_t timestamp = encode_uint32(encoded[pos], encoded[pos + 1u], encoded[pos + 2u], encoded[pos + 3u]);
+    const auto direction = static_cast<FrameDirection>(encoded[pos + 4u]);
+    const uint8_t command = encoded[pos + 5u];
+    const std::size_t length = encode_uint16(encoded[pos + 6u], encoded[pos + 7u]);
+    const std::size_t stored = std::min(length, payload_bytes);
+    pos += FrameTrace::FRAME_HEADER_SIZE;
+    if ((pos + stored) > encoded.size())
+    {
+      error = "frame trace truncated at frame " + std::to_string(i);
+      return {};
+    }
+
+    if (direction == FrameDirection::RX)
+    {
+      if (stored < length)
+      {
+        ++capture.skipped_frames;
+      }
+      else
+      {
+        if (!first_ms.has_value())
+        {
+          first_ms = timestamp;
+        }
+        // the version isn't traced, every known MCU sends 3
+        std::vector<uint8_t> frame{0x55, 0xAA, 0x03, command, static_cast<uint8_t>(length >> 8),
+                                   static_cast<uint8_t>(length)};
+        frame.insert(frame.end(), encoded.begin() + pos, encoded.begin() + pos + stored);
+        uint8_t checksum = 0u;
+        for (const auto byte : frame)
+        {
+          checksum += byte;
+        }
+        frame.push_back(checksum);
+        capture.chunks.push_back(Chunk{timestamp - *first_ms, std::move(frame)});
+      }
+    }
+    pos += stored;
+  }
+  return capture;
+}
+
+std::optional<Capture> Capture::load(const std::string& path, std::string& error)
+{
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+  {
+    error = "can't open " + path;
+    return {};
+  }
+  const std::vector<uint8_t> content{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+  if ((content.size() >= 3u) && (content[0] == 'U') && (content[1] == 'T') && (content[2] == FrameTrace::FORMAT_VERSION))
+  {
+    return parse_frame_trace(content, error);
+  }
+
+  // the log of the dump_frame_trace action
+  std::istringstream text(std::string(content.begin(), content.end()));
+  std::string line;
+  std::string trace_hex;
+  while (std::getline(text, line))
+  {
+    // not the "Frame trace: N of M frames" line before them
+    static const std::string TRACE_PREFIX = "trace: ";
+    const auto found = line.find(TRACE_PREFIX);
+    if ((found != std::string::npos) && ((found == 0u) || (line[found - 1u] == ' ')) &&
+        ((found < 2u) || (line[found - 2u] == ':')))
+    {
+      trace_hex += line.substr(found + TRACE_PREFIX.size());
+    }
+  }
+  if (!trace_hex.empty())
+  {
+    const auto encoded = parse_hex_text(trace_hex);
+    if (!encoded.has_value())
+    {
+      error = "invalid hex in the trace lines";
+      return {};
+    }
+    return parse_frame_trace(*encoded, error);
+  }
+
+  text.clear();
+  text.seekg(0);
+  return parse_hex_log(text, error);
+}
+
+std::string CaptureReplay::TimelineEntry::to_string() const
+{
+  return str_sprintf("%u %s", this->at_ms, this->datapoint.to_string().c_str());
+}
+
+CaptureReplay::CaptureReplay(const Capture& capture, const Options& options):
+capture_(capture),
+options_(options)
+{}
+
+const CaptureReplay::Statistics& CaptureReplay::run()
+{
+  this->timeline_.clear();
+  this->statistics_ = Statistics{};
+  this->statistics_.bytes = this->capture_.get_total_bytes();
+  this->statistics_.capture_ms = this->capture_.get_duration_ms();
+
+  const auto start = std::chrono::steady_clock::now();
+  if (this->options_.speed == Speed::FAST)
+  {
+    this->run_fast_();
+  }
+  else
+  {
+    this->run_original_();
+  }
+  this->statistics_.wall_us = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+  return this->statistics_;
+}
+
+void CaptureReplay::run_fast_()
+{
+  ManualClock clock;
+  ReplayRig rig(clock, this->options_, this->timeline_, this->statistics_);
+  const auto& chunks = this->capture_.chunks;
+  const uint32_t end_ms = this->capture_.get_duration_ms() + this->options_.tail_ms;
+  std::size_t next = 0u;
+
+  while (true)
+  {
+    const uint32_t now = clock.get_millis();
+    for (; (next < chunks.size()) && (chunks[next].at_ms <= now); ++next)
+    {
+      rig.transport.push(chunks[next].bytes);
+    }
+    poll_measured(rig, this->statistics_.poll_us);
+    rig.timers.run_due();
+    if ((next >= chunks.size()) && (now >= end_ms))
+    {
+      break;
+    }
+
+    // when idle the time jumps to the next chunk or timer, otherwise it runs in 1 ms steps
+    uint32_t step = 1u;
+    if (rig.core.is_idle() && rig.transport.rx.empty())
+    {
+      uint32_t target = (next < chunks.size()) ? chunks[next].at_ms : end_ms;
+      const auto timer_due = rig.timers.get_next_due_in_ms();
+      if (timer_due.has_value())
+      {
+        target = std::min(target, now + *timer_due);
+      }
+      step = std::max(1u, target - now);
+    }
+    clock.advance_ms(step);
+  }
+  this->statistics_.final_init_state = rig.core.get_init_state();
+}
+
+void CaptureReplay::run_original_()
+{
+  SteadyClock clock;
+  ReplayRig rig(clock, this->options_, this->timeline_, this->statistics_);
+  const auto& chunks = this->capture_.chunks;
+  const uint32_t end_ms = this->capture_.get_duration_ms() + this->options_.tail_ms;
+  std::size_t next = 0u;
+
+  while (true)
+  {
+    const uint32_t now = clock.get_millis();
+    for (; (next < chunks.size()) && (chunks[next].at_ms <= now); ++next)
+    {
+      rig.transport.push(chunks[next].bytes);
+    }
+    poll_measured(rig, this->statistics_.poll_us);
+    rig.timers.run_due();
+    if ((next >= chunks.size()) && (now >= end_ms))
+    {
+      break;
+    }
+    // the core's own timeouts are in the tens of ms, it can wait for the wall clock like on the device
+    if (rig.transport.rx.empty())
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  this->statistics_.final_init_state = rig.core.get_init_state();
+}
+
+void CaptureReplay::log_statistics() const
+{
+  const auto& stats = this->statistics_;
+  ESP_LOGI(TAG, "Replayed %zu bytes, %u ms of capture, in %.3f ms", stats.bytes, stats.capture_ms,
+           stats.wall_us / 1000.0);
+  ESP_LOGI(TAG, "Datapoint frames: %u, timeline entries: %zu, final init state: %u", stats.datapoint_frames,
+           this->timeline_.size(), static_cast<unsigned>(stats.final_init_state));
+  ESP_LOGI(TAG, "Polls with input: %s", stats.poll_us.to_string().c_str());
+  if (stats.wall_us > 0u)
+  {
+    ESP_LOGI(TAG, "Throughput: %.0f bytes/s, %.0f datapoint frames/s", stats.bytes * 1e6 / stats.wall_us,
+             stats.datapoint_frames * 1e6 / stats.wall_us);
+  }
+}
+
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "uyat_core.h"
+#include "uyat_timing_histogram.h"
+#include "uyat_trace_events.h"
+
+namespace esphome::uyat::host
+{
+
+// The bytes received from the MCU during a recorded session.
+//
+// Supported recordings:
+// - hex logs, one chunk of received bytes per line, the bytes in hex with optional separators (' ', ':', '.', ',', '-'):
+//     [1200] 55 AA 03 07 00 05 01 01 00 01 01 11  # time in ms in the first bracket
+//     [12:00:01.234][D][uart_debug:114]: <<< 55:AA:03:07:...  # esphome uart debug, '>>>' (TX) lines are skipped
+//     55 AA 03 ...  # no time, same as the previous line
+// - the binary export format of the frame trace (see FrameTrace), as a file or as the "trace: <hex>" log lines
+//   of the dump_frame_trace action. Only the RX frames are replayed, the ones with a truncated payload are skipped.
+struct Capture
+{
+  struct Chunk
+  {
+    uint32_t at_ms;  // from the first chunk
+    std::vector<uint8_t> bytes;
+  };
+
+  std::vector<Chunk> chunks;
+  std::size_t skipped_frames{0};  // frame trace entries with truncated payload
+
+  std::size_t get_total_bytes() const;
+  uint32_t get_duration_ms() const
+  {
+    return this->chunks.empty() ? 0u : this->chunks.back().at_ms;
+  }
+
+  static std::optional<Capture> parse_hex_log(std::istream& input, std::string& error);
+  static std::optional<Capture> parse_frame_trace(const std::vector<uint8_t>& encoded, std::string& error);
+  // detects the format
+  static std::optional<Capture> load(const std::string& path, std::string& error);
+};
+
+// Replays a capture into a UyatCore and records the resulting datapoint state timeline.
+class CaptureReplay
+{
+public:
+  enum class Speed : uint8_t
+  {
+    ORIGINAL,  // the chunks are fed at their recorded time, on the wall clock
+    FAST,      // as fast as possible, on a simulated clock with the recorded timing
+  };
+
+  struct Options
+  {
+    Speed speed{Speed::FAST};
+    // run the init sequence (the capture starts with the MCU boot), otherwise the core starts initialized
+    bool from_boot{false};
+    bool record_timeline{true};
+    // time the core keeps running after the last chunk
+    uint32_t tail_ms{1000};
+    // receives the timeline of the core, needs UYAT_TRACE_EVENTS_ENABLED
+    UyatTraceEvents* trace_events{nullptr};
+  };
+
+  // a change of a datapoint value, the first report of each datapoint included
+  struct TimelineEntry
+  {
+    uint32_t at_ms;
+    UyatDatapoint datapoint;
+
+    std::string to_string() const;
+  };
+
+  struct Statistics
+  {
+    std::size_t bytes{0};
+    uint32_t capture_ms{0};
+    uint32_t datapoint_frames{0};
+    uint64_t wall_us{0};
+    TimingHistogram poll_us;  // the polls with received input
+    UyatInitState final_init_state{UyatInitState::INIT_HEARTBEAT};
+  };
+
+  CaptureReplay(const Capture& capture, const Options& options);
+
+  const Statistics& run();
+
+  const std::vector<TimelineEntry>& get_timeline() const
+  {
+    return this->timeline_;
+  }
+
+  const Statistics& get_statistics() const
+  {
+    return this->statistics_;
+  }
+
+  void log_statistics() const;
+
+protected:
+  void run_fast_();
+  void run_original_();
+
+  const Capture& capture_;
+  const Options options_;
+  std::vector<TimelineEntry> timeline_;
+  Statistics statistics_;
+};
+
+}
@@ -0,0 +1,172 @@
+// Replays recorded MCU traffic into the protocol core.
+//
+//   uyat_replay [-r] [-b] [-n] [-o timeline] [-e expected_timeline] [-t trace.json] [-v] capture
+//
+// Prints the datapoint state timeline and logs the timing statistics. With -e the timeline is
+// compared with an expected one instead, which turns a capture into a regression test. -t writes
+// the timeline of the core as a Chrome trace (see ChromeTraceWriter).
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "uyat_chrome_trace.h"
+#include "uyat_replay.h"
+
+using namespace esphome::uyat;
+
+static int usage(const char* program)
+{
+  fprintf(stderr,
+          "usage: %s [-r] [-b] [-n] [-o timeline] [-e expected_timeline] [-t trace.json] [-v] capture\n"
+          "  -r  replay at the original speed instead of as fast as possible\n"
+          "  -b  the capture starts with the MCU boot, run the init sequence\n"
+          "  -n  don't record the timeline (for throughput measurements)\n"
+          "  -o  write the timeline to a file instead of stdout\n"
+          "  -e  compare the timeline with an expected one, exit with 1 when they differ\n"
+          "  -t  write the frames, the dispatch to the listeners and the response waits as a Chrome trace\n"
+          "  -v  log the protocol at the verbose level\n",
+          program);
+  return 2;
+}
+
+int main(int argc, char** argv)
+{
+  host::CaptureReplay::Options options;
+  std::string output_path;
+  std::string expected_path;
+  std::string trace_path;
+  int opt;
+  host::set_log_level(ESPHOME_LOG_LEVEL_WARN);
+  while ((opt = getopt(argc, argv, "rbno:e:t:v")) != -1)
+  {
+    switch (opt)
+    {
+      case 'r':
+        options.speed = host::CaptureReplay::Speed::ORIGINAL;
+        break;
+      case 'b':
+        options.from_boot = true;
+        break;
+      case 'n':
+        options.record_timeline = false;
+        break;
+      case 'o':
+        output_path = optarg;
+        break;
+      case 'e':
+        expected_path = optarg;
+        break;
+      case 't':
+        trace_path = optarg;
+        break;
+      case 'v':
+        host::set_log_level(ESPHOME_LOG_LEVEL_VERBOSE);
+        break;
+      default:
+        return usage(argv[0]);
+    }
+  }
+  if (optind != (argc - 1))
+  {
+    return usage(argv[0]);
+  }
+
+  std::string error;
+  const auto capture = host::Capture::load(argv[optind], error);
+  if (!capture.has_value())
+  {
+    fprintf(stderr, "%s: %s\n", argv[optind], error.c_str());
+    return 1;
+  }
+  if (capture->skipped_frames > 0u)
+  {
+    fprintf(stderr, "%zu frames with truncated payload skipped\n", capture->skipped_frames);
+  }
+
+  std::ofstream trace_file;
+  std::unique_ptr<host::ChromeTraceWriter> trace;
+  if (!trace_path.empty())
+  {
+#ifdef UYAT_TRACE_EVENTS_ENABLED
+    trace_file.open(trace_path);
+    if (!trace_file)
+    {
+      fprintf(stderr, "can't write %s\n", trace_path.c_str());
+      return 1;
+    }
+    trace = std::make_unique<host::ChromeTraceWriter>(trace_file);
+    options.trace_events = trace.get();
+#else
+    fprintf(stderr, "-t needs the UYAT_TRACE_EVENTS build option\n");
+    return 2;
+#endif
+  }
+
+  host::CaptureReplay replay(*capture, options);
+  replay.run();
+  if (trace)
+  {
+    trace->finish();
+  }
+  // the statistics are the point of the tool, logged regardless of the log level
+  const auto log_level = host::get_log_level();
+  host::set_log_level(ESPHOME_LOG_LEVEL_INFO);
+  replay.log_statistics();
+  host::set_log_level(log_level);
+
+  if (!expected_path.empty())
+  {
+    std::ifstream expected(expected_path);
+    if (!expected)
+    {
+      fprintf(stderr, "can't open %s\n", expected_path.c_str());
+      return 1;
+    }
+    std::string line;
+    std::size_t index = 0u;
+    for (; std::getline(expected, line); ++index)
+    {
+      if (index >= replay.get_timeline().size())
+      {
+        fprintf(stderr, "timeline line %zu missing, expected: %s\n", index + 1u, line.c_str());
+        return 1;
+      }
+      const auto actual = replay.get_timeline()[index].to_string();
+      if (actual != line)
+      {
+        fprintf(stderr, "timeline line %zu differs\n  expected: %s\n  actual:   %s\n", index + 1u, line.c_str(),
+                actual.c_str());
+        return 1;
+      }
+    }
+    if (index != replay.get_timeline().size())
+    {
+      fprintf(stderr, "timeline has %zu more lines than expected, first: %s\n", replay.get_timeline().size() - index,
+              replay.get_timeline()[index].to_string().c_str());
+      return 1;
+    }
+    return 0;
+  }
+
+  std::ofstream output_file;
+  if (!output_path.empty())
+  {
+    output_file.open(output_path);
+    if (!output_file)
+    {
+      fprintf(stderr, "can't write %s\n", output_path.c_str());
+      return 1;
+    }
+  }
+  std::ostream& output = output_path.empty() ? std::cout : output_file;
+  for (const auto& entry : replay.get_timeline())
+  {
+    output << entry.to_string() << '\n';
+  }
+  return 0;
+}
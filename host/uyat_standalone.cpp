@@ -0,0 +1,276 @@
+#include "uyat_standalone.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace esphome
+{
+
+static const char* const BASE64_CHARS = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+std::string str_sprintf(const char* fmt, ...)
+{
+  std::string result;
+  va_list args;
+  va_start(args, fmt);
+  va_list args_copy;
+  va_copy(args_copy, args);
+  const int length = vsnprintf(nullptr, 0, fmt, args_copy);
+  va_end(args_copy);
+  if (length > 0)
+  {
+    result.resize(static_cast<std::size_t>(length));
+    vsnprintf(result.data(), result.size() + 1u, fmt, args);
+  }
+  va_end(args);
+  return result;
+}
+
+std::string format_hex(const uint8_t* data, const std::size_t length)
+{
+  static const char* const HEX_DIGITS = "0123456789abcdef";
+  std::string result;
+  result.reserve(length * 2u);
+  for (std::size_t i = 0u; i < length; ++i)
+  {
+    result += HEX_DIGITS[data[i] >> 4];
+    result += HEX_DIGITS[data[i] & 0x0F];
+  }
+  return result;
+}
+
+std::string format_hex(const std::vector<uint8_t>& data)
+{
+  return format_hex(data.data(), data.size());
+}
+
+std::string format_hex_pretty(const uint8_t* data, const std::size_t length, const char separator,
+                              const bool show_length)
+{
+  static const char* const HEX_DIGITS = "0123456789ABCDEF";
+  if ((data == nullptr) || (length == 0u))
+  {
+    return "";
+  }
+  std::string result;
+  result.reserve(length * 3u);
+  for (std::size_t i = 0u; i < length; ++i)
+  {
+    if ((i > 0u) && (separator != 0))
+    {
+      result += separator;
+    }
+    result += HEX_DIGITS[data[i] >> 4];
+    result += HEX_DIGITS[data[i] & 0x0F];
+  }
+  if (show_length && (length > 4u))
+  {
+    result += " (" + std::to_string(length) + ")";
+  }
+  return result;
+}
+
+std::string format_hex_pretty(const char* data, const std::size_t length, const char separator, const bool show_length)
+{
+  return format_hex_pretty(reinterpret_cast<const uint8_t*>(data), length, separator, show_length);
+}
+
+std::string format_hex_pretty(const std::vector<uint8_t>& data, const char separator, const bool show_length)
+{
+  return format_hex_pretty(data.data(), data.size(), separator, show_length);
+}
+
+std::size_t parse_hex(const char* str, const std::size_t length, uint8_t* data, const std::size_t count)
+{
+  // a shorter string fills the last bytes, same as the esphome implementation
+  const std::size_t chars = std::min(length, 2u * count);
+  for (std::size_t i = (2u * count) - chars; i < (2u * count); ++i, ++str)
+  {
+    uint8_t value;
+    if ((*str >= 'A') && (*str <= 'F'))
+    {
+      value = *str - 'A' + 10;
+    }
+    else if ((*str >= 'a') && (*str <= 'f'))
+    {
+      value = *str - 'a' + 10;
+    }
+    else if ((*str >= '0') && (*str <= '9'))
+    {
+      value = *str - '0';
+    }
+    else
+    {
+      return 0u;
+    }
+    data[i >> 1] = ((i & 1u) == 0u) ? (value << 4) : (data[i >> 1] | value);
+  }
+  return chars;
+}
+
+std::string base64_encode(const uint8_t* data, const std::size_t length)
+{
+  std::string result;
+  result.reserve(((length + 2u) / 3u) * 4u);
+  std::size_t i = 0u;
+  for (; (i + 2u) < length; i += 3u)
+  {
+    const uint32_t triple = (uint32_t(data[i]) << 16) | (uint32_t(data[i + 1u]) << 8) | data[i + 2u];
+    result += BASE64_CHARS[(triple >> 18) & 0x3F];
+    result += BASE64_CHARS[(triple >> 12) & 0x3F];
+    result += BASE64_CHARS[(triple >> 6) & 0x3F];
+    result += BASE64_CHARS[triple & 0x3F];
+  }
+  if (i < length)
+  {
+    const uint32_t triple = (uint32_t(data[i]) << 16) | (((i + 1u) < length) ? (uint32_t(data[i + 1u]) << 8) : 0u);
+    result += BASE64_CHARS[(triple >> 18) & 0x3F];
+    result += BASE64_CHARS[(triple >> 12) & 0x3F];
+    result += ((i + 1u) < length) ? BASE64_CHARS[(triple >> 6) & 0x3F] : '=';
+    result += '=';
+  }
+  return result;
+}
+
+std::string base64_encode(const std::vector<uint8_t>& data)
+{
+  return base64_encode(data.data(), data.size());
+}
+
+std::vector<uint8_t> base64_decode(const std::string& encoded)
+{
+  std::vector<uint8_t> result;
+  result.reserve((encoded.size() / 4u) * 3u);
+  uint32_t accumulator = 0u;
+  int bits = 0;
+  for (const char c : encoded)
+  {
+    const char* found = (c != 0) ? std::char_traits<char>::find(BASE64_CHARS, 64u, c) : nullptr;
+    if (found == nullptr)
+    {
+      break;  // padding or garbage
+    }
+    accumulator = (accumulator << 6) | static_cast<uint32_t>(found - BASE64_CHARS);
+    bits += 6;
+    if (bits >= 8)
+    {
+      bits -= 8;
+      result.push_back(static_cast<uint8_t>(accumulator >> bits));
+    }
+  }
+  return result;
+}
+
+void rgb_to_hsv(const float red, const float green, const float blue, int& hue, float& saturation, float& value)
+{
+  const float max_value = std::max(std::max(red, green), blue);
+  const float min_value = std::min(std::min(red, green), blue);
+  const float delta = max_value - min_value;
+
+  if (delta == 0.0f)
+  {
+    hue = 0;
+  }
+  else if (max_value == red)
+  {
+    hue = int(std::fmod(((60.0f * ((green - blue) / delta)) + 360.0f), 360.0f));
+  }
+  else if (max_value == green)
+  {
+    hue = int(std::fmod(((60.0f * ((blue - red) / delta)) + 120.0f), 360.0f));
+  }
+  else
+  {
+    hue = int(std::fmod(((60.0f * ((red - green) / delta)) + 240.0f), 360.0f));
+  }
+
+  saturation = (max_value == 0.0f) ? 0.0f : (delta / max_value);
+  value = max_value;
+}
+
+void hsv_to_rgb(const int hue, const float saturation, const float value, float& red, float& green, float& blue)
+{
+  const float chroma = value * saturation;
+  const float hue_prime = std::fmod(hue / 60.0f, 6.0f);
+  const float intermediate = chroma * (1.0f - std::fabs(std::fmod(hue_prime, 2.0f) - 1.0f));
+  const float delta = value - chroma;
+
+  red = green = blue = 0.0f;
+  if ((0.0f <= hue_prime) && (hue_prime < 1.0f))
+  {
+    red = chroma;
+    green = intermediate;
+  }
+  else if ((1.0f <= hue_prime) && (hue_prime < 2.0f))
+  {
+    red = intermediate;
+    green = chroma;
+  }
+  else if ((2.0f <= hue_prime) && (hue_prime < 3.0f))
+  {
+    green = chroma;
+    blue = intermediate;
+  }
+  else if ((3.0f <= hue_prime) && (hue_prime < 4.0f))
+  {
+    green = intermediate;
+    blue = chroma;
+  }
+  else if ((4.0f <= hue_prime) && (hue_prime < 5.0f))
+  {
+    red = intermediate;
+    blue = chroma;
+  }
+  else if ((5.0f <= hue_prime) && (hue_prime < 6.0f))
+  {
+    red = chroma;
+    blue = intermediate;
+  }
+
+  red += delta;
+  green += delta;
+  blue += delta;
+}
+
+namespace uyat::host
+{
+
+static void default_log_handler(const int level, const char* tag, const char* message)
+{
+  static const char LEVEL_LETTERS[] = "-EWICDVV";
+  const char letter = ((level >= 0) && (level <= ESPHOME_LOG_LEVEL_VERY_VERBOSE)) ? LEVEL_LETTERS[level] : '?';
+  fprintf(stderr, "[%c][%s]: %s\n", letter, tag, message);
+}
+
+static int log_level = ESPHOME_LOG_LEVEL_INFO;
+static LogHandler log_handler = &default_log_handler;
+
+void set_log_level(const int level)
+{
+  log_level = level;
+}
+
+int get_log_level()
+{
+  return log_level;
+}
+
+void set_log_handler(const LogHandler handler)
+{
+  log_handler = (handler != nullptr) ? handler : &default_log_handler;
+}
+
+void log_printf(const int level, const char* tag, const char* fmt, ...)
+{
+  char message[512];
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(message, sizeof(message), fmt, args);
+  va_end(args);
+  log_handler(level, tag, message);
+}
+
+}
+
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+// The subset of esphome/core/helpers.h and esphome/core/log.h used by the protocol core, for the
+// standalone (UYAT_STANDALONE) host build. The behaviour follows the esphome implementations, so
+// logs and encoded payloads look the same on the host as on the device.
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#define ESPHOME_LOG_LEVEL_NONE 0
+#define ESPHOME_LOG_LEVEL_ERROR 1
+#define ESPHOME_LOG_LEVEL_WARN 2
+#define ESPHOME_LOG_LEVEL_INFO 3
+#define ESPHOME_LOG_LEVEL_CONFIG 4
+#define ESPHOME_LOG_LEVEL_DEBUG 5
+#define ESPHOME_LOG_LEVEL_VERBOSE 6
+#define ESPHOME_LOG_LEVEL_VERY_VERBOSE 7
+
+#ifndef ESPHOME_LOG_LEVEL
+#define ESPHOME_LOG_LEVEL ESPHOME_LOG_LEVEL_VERBOSE
+#endif
+
+#define TRUEFALSE(b) ((b) ? "TRUE" : "FALSE")
+#define ONOFF(b) ((b) ? "ON" : "OFF")
+#define YESNO(b) ((b) ? "YES" : "NO")
+
+namespace esphome
+{
+
+template<typename T>
+using optional = std::optional<T>;
+
+std::string str_sprintf(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+
+std::string format_hex(const uint8_t* data, std::size_t length);
+std::string format_hex(const std::vector<uint8_t>& data);
+
+// Upper case bytes split by the separator (none if 0), with " (N)" appended for more than 4 bytes.
+std::string format_hex_pretty(const uint8_t* data, std::size_t length, char separator = '.', bool show_length = true);
+std::string format_hex_pretty(const char* data, std::size_t length, char separator = '.', bool show_length = true);
+std::string format_hex_pretty(const std::vector<uint8_t>& data, char separator = '.', bool show_length = true);
+
+constexpr uint16_t encode_uint16(const uint8_t msb, const uint8_t lsb)
+{
+  return (static_cast<uint16_t>(msb) << 8) | lsb;
+}
+
+constexpr uint32_t encode_uint32(const uint8_t byte1, const uint8_t byte2, const uint8_t byte3, const uint8_t byte4)
+{
+  return (static_cast<uint32_t>(byte1) << 24) | (static_cast<uint32_t>(byte2) << 16) |
+         (static_cast<uint32_t>(byte3) << 8) | byte4;
+}
+
+// Parses up to count bytes from the hex string, returns the number of characters used (0 on invalid input).
+std::size_t parse_hex(const char* str, std::size_t length, uint8_t* data, std::size_t count);
+
+inline bool parse_hex(const char* str, std::vector<uint8_t>& data, const std::size_t count)
+{
+  data.resize(count);
+  return parse_hex(str, std::char_traits<char>::length(str), data.data(), count) == (2u * count);
+}
+
+template<typename T, std::enable_if_t<std::is_unsigned_v<T>, int> = 0>
+optional<T> parse_hex(const std::string& str)
+{
+  if (str.empty() || (str.size() > (2u * sizeof(T))))
+  {
+    return {};
+  }
+  T value = 0;
+  for (const char c : str)
+  {
+    uint8_t nibble;
+    if ((c >= '0') && (c <= '9'))
+    {
+      nibble = c - '0';
+    }
+    else if ((c >= 'A') && (c <= 'F'))
+    {
+      nibble = c - 'A' + 10;
+    }
+    else if ((c >= 'a') && (c <= 'f'))
+    {
+      nibble = c - 'a' + 10;
+    }
+    else
+    {
+      return {};
+    }
+    value = static_cast<T>((value << 4) | nibble);
+  }
+  return value;
+}
+
+std::string base64_encode(const uint8_t* data, std::size_t length);
+std::string base64_encode(const std::vector<uint8_t>& data);
+// Stops at the first character which is not part of the base64 alphabet.
+std::vector<uint8_t> base64_decode(const std::string& encoded);
+
+// hue in degrees (0-360), saturation and value 0-1
+void rgb_to_hsv(float red, float green, float blue, int& hue, float& saturation, float& value);
+void hsv_to_rgb(int hue, float saturation, float value, float& red, float& green, float& blue);
+
+namespace uyat::host
+{
+
+using LogHandler = void (*)(int level, const char* tag, const char* message);
+
+// Messages above the level are dropped at runtime, the default is ESPHOME_LOG_LEVEL_INFO.
+void set_log_level(int level);
+int get_log_level();
+// Replaces the default handler, which prints "[D][tag]: message" lines to stderr. nullptr restores it.
+void set_log_handler(LogHandler handler);
+
+void log_printf(int level, const char* tag, const char* fmt, ...) __attribute__((format(printf, 3, 4)));
+
+}
+
+}
+
+#define UYAT_HOST_LOG(level, tag, ...) \
+  do \
+  { \
+    if (((level) <= ESPHOME_LOG_LEVEL) && ((level) <= ::esphome::uyat::host::get_log_level())) \
+    { \
+      ::esphome::uyat::host::log_printf(level, tag, __VA_ARGS__); \
+    } \
+  } while (false)
+
+#define ESP_LOGE(tag, ...) UYAT_HOST_LOG(ESPHOME_LOG_LEVEL_ERROR, tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) UYAT_HOST_LOG(ESPHOME_LOG_LEVEL_WARN, tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) UYAT_HOST_LOG(ESPHOME_LOG_LEVEL_INFO, tag, __VA_ARGS__)
+#define ESP_LOGCONFIG(tag, ...) UYAT_HOST_LOG(ESPHOME_LOG_LEVEL_CONFIG, tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) UYAT_HOST_LOG(ESPHOME_LOG_LEVEL_DEBUG, tag, __VA_ARGS__)
+#define ESP_LOGV(tag, ...) UYAT_HOST_LOG(ESPHOME_LOG_LEVEL_VERBOSE, tag, __VA_ARGS__)
+#define ESP_LOGVV(tag, ...) UYAT_HOST_LOG(ESPHOME_LOG_LEVEL_VERY_VERBOSE, tag, __VA_ARGS__)
@@ -0,0 +1,258 @@
+#include "uyat_stress.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "uyat_host_platform.h"
+#include "uyat_mcu_simulator.h"
+
+#if !defined(UYAT_DIAGNOSTICS_ENABLED) || !defined(UYAT_LATENCY_ENABLED)
+#error "The stress test needs the diagnostics and the latency tracking of the core"
+#endif
+
+namespace esphome::uyat::host
+{
+
+static const char* const TAG = "uyat.stress";
+
+namespace
+{
+
+class StressCore : public InitStateCore
+{
+public:
+  using InitStateCore::InitStateCore;
+
+  std::size_t get_rx_message_size() const
+  {
+    return this->rx_message_.size();
+  }
+
+  const UyatStatistics& get_statistics() const
+  {
+    return this->statistics_;
+  }
+
+  const UyatLatencyTracker& get_latency() const
+  {
+    return this->latency_;
+  }
+};
+
+// the datapoints of the MCU, the value ones are set by the module
+const uint8_t FIRST_SET_DATAPOINT = 2u;
+const uint8_t NUM_SET_DATAPOINTS = 4u;
+
+McuScript make_script(const StressTest::Options& options)
+{
+  McuScript script;
+  script.product = R"({"p":"uyat.stress","v":"1.0.0","m":0})";
+  script.baud_rate = options.baud_rate;
+  script.datapoints.push_back(UyatDatapoint{1u, BoolDatapointValue{false}});
+  for (uint8_t i = 0u; i < NUM_SET_DATAPOINTS; ++i)
+  {
+    script.datapoints.push_back(UyatDatapoint{static_cast<uint8_t>(FIRST_SET_DATAPOINT + i), UIntDatapointValue{0u}});
+  }
+  script.datapoints.push_back(UyatDatapoint{6u, EnumDatapointValue{1u}});
+  script.datapoints.push_back(UyatDatapoint{7u, StringDatapointValue{"stress test"}});
+  script.datapoints.push_back(UyatDatapoint{8u, RawDatapointValue{std::vector<uint8_t>(16u, 0xA5u)}});
+  return script;
+}
+
+struct MetricDefinition
+{
+  const char* name;
+  uint32_t (*get)(const StressTest::Results& results);
+};
+
+const MetricDefinition METRICS[] = {
+    {"dropped_frames", [](const StressTest::Results& r) { return r.get_dropped_frames(); }},
+    {"checksum_errors", [](const StressTest::Results& r) { return r.checksum_errors; }},
+    {"rx_bytes_dropped", [](const StressTest::Results& r) { return r.rx_bytes_dropped; }},
+    {"rx_buffer_high_water", [](const StressTest::Results& r) { return static_cast<uint32_t>(r.rx_buffer_high_water); }},
+    {"rx_message_high_water", [](const StressTest::Results& r) { return static_cast<uint32_t>(r.rx_message_high_water); }},
+    {"queue_high_water", [](const StressTest::Results& r) { return r.command_queue_high_water; }},
+    {"undelivered_sets", [](const StressTest::Results& r) { return r.get_undelivered_sets(); }},
+    {"response_timeouts", [](const StressTest::Results& r) { return r.response_timeouts; }},
+    {"loop_max_us", [](const StressTest::Results& r) { return r.poll_us.max_us(); }},
+    {"loop_p99_us", [](const StressTest::Results& r) { return r.poll_us.percentile_us(99u); }},
+    {"rx_to_dispatch_p99_us", [](const StressTest::Results& r) { return r.rx_to_dispatch_us.percentile_us(99u); }},
+    {"set_to_tx_p99_us", [](const StressTest::Results& r) { return r.set_to_tx_us.percentile_us(99u); }},
+    {"tx_to_report_p99_us", [](const StressTest::Results& r) { return r.tx_to_report_us.percentile_us(99u); }},
+};
+
+std::string percentiles_to_string(const TimingHistogram& histogram)
+{
+  return str_sprintf("n=%u p50=%uus p95=%uus p99=%uus max=%uus", histogram.count(), histogram.percentile_us(50u),
+                     histogram.percentile_us(95u), histogram.percentile_us(99u), histogram.max_us());
+}
+
+}
+
+StressTest::StressTest(const Options& options):
+options_(options)
+{}
+
+const StressTest::Results& StressTest::run()
+{
+  this->results_ = Results{};
+  auto& results = this->results_;
+
+  ManualClock clock;
+  McuSimulator mcu(make_script(this->options_), clock);
+  // a bounded rx buffer filled by the MCU, the written bytes go straight to the MCU
+  QueueTransport transport([&mcu](const uint8_t* data, const std::size_t len) { mcu.receive(data, len); },
+                           this->options_.rx_buffer_size);
+  TimerQueue timers(clock);
+  StressCore core(transport, clock, timers);
+  // listeners like the ones of the entities
+  for (uint8_t number = 1u; number <= 8u; ++number)
+  {
+    core.register_datapoint_listener(number, [](const UyatDatapoint& datapoint) { (void) datapoint.value_to_payload(); });
+  }
+  // the load is on a running device, not on the init sequence
+  core.set_init_state(UyatInitState::INIT_DONE);
+#ifdef UYAT_TRACE_EVENTS_ENABLED
+  core.set_trace_events(this->options_.trace_events);
+#endif
+  core.start();
+
+  // one step per byte on the line, at least one per ms
+  const uint32_t byte_time_us = (this->options_.baud_rate > 0u) ? (10000000u / this->options_.baud_rate) : 1000u;
+  const uint32_t step_us = std::clamp<uint32_t>(byte_time_us, 1u, 1000u);
+  const uint64_t load_end_us = static_cast<uint64_t>(this->options_.duration_ms) * 1000u;
+  const uint64_t end_us = load_end_us + static_cast<uint64_t>(this->options_.drain_ms) * 1000u;
+  const uint64_t loop_interval_us = std::max<uint64_t>(this->options_.loop_interval_ms, 1u) * 1000u;
+  const uint64_t set_interval_us =
+      (this->options_.sets_per_second > 0u) ? (1000000u / this->options_.sets_per_second) : UINT64_MAX;
+  const uint64_t query_interval_us =
+      (this->options_.query_period_ms > 0u) ? (static_cast<uint64_t>(this->options_.query_period_ms) * 1000u) : UINT64_MAX;
+
+  uint64_t next_poll_us = loop_interval_us;
+  uint64_t next_set_us = set_interval_us;
+  uint64_t next_query_us = query_interval_us;
+  uint8_t next_report = 0u;
+  uint32_t set_value = 0u;
+  std::vector<uint8_t> line;
+
+  for (uint64_t now_us = 0u; now_us < end_us; now_us += step_us)
+  {
+    clock.advance_us(step_us);
+    const bool loaded = now_us < load_end_us;
+
+    // the MCU floods: the next report is queued as soon as the line is free
+    if (loaded && mcu.is_idle())
+    {
+      mcu.report_datapoint(static_cast<uint8_t>((next_report++ % 8u) + 1u));
+    }
+    line.clear();
+    mcu.poll(line);
+    results.rx_bytes_dropped += transport.push(line);
+    results.rx_buffer_high_water = std::max(results.rx_buffer_high_water, transport.rx.size());
+
+    if (now_us < next_poll_us)
+    {
+      continue;
+    }
+    next_poll_us += loop_interval_us;
+
+    // the other components of the loop
+    for (; loaded && (next_set_us <= now_us); next_set_us += set_interval_us)
+    {
+      const auto number = static_cast<uint8_t>(FIRST_SET_DATAPOINT + (results.sets % NUM_SET_DATAPOINTS));
+      core.set_datapoint_value(UyatDatapoint{number, UIntDatapointValue{++set_value}}, false);
+      ++results.sets;
+    }
+    for (; loaded && (next_query_us <= now_us); next_query_us += query_interval_us)
+    {
+      core.send_generic_command(UyatCommand{.cmd = UyatCommandType::DATAPOINT_QUERY, .payload = {}});
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    core.poll();
+    timers.run_due();
+    results.poll_us.add(static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count()));
+    results.rx_message_high_water = std::max(results.rx_message_high_water, core.get_rx_message_size());
+  }
+
+  const auto& mcu_statistics = mcu.get_statistics();
+  const auto& core_statistics = core.get_statistics();
+  results.frames_sent = mcu_statistics.frames_sent;
+  results.frames_received = core_statistics.get_frames_received();
+  results.checksum_errors = core_statistics.get_checksum_errors();
+  results.command_queue_high_water = core_statistics.get_queue_high_water_mark();
+  results.response_timeouts = core_statistics.get_response_timeouts();
+  results.sets_delivered = mcu_statistics.datapoints_delivered;
+  const auto& latency = core.get_latency();
+  results.rx_to_dispatch_us = latency.get(UyatLatencyTracker::Interval::RX_TO_DISPATCH);
+  results.set_to_tx_us = latency.get(UyatLatencyTracker::Interval::SET_TO_TX);
+  results.tx_to_report_us = latency.get(UyatLatencyTracker::Interval::TX_TO_REPORT);
+  return results;
+}
+
+void StressTest::log_results() const
+{
+  const auto& results = this->results_;
+  ESP_LOGI(TAG, "%u baud, %u ms of load, polls every %u ms, rx buffer %zu bytes, %u sets/s, query every %u ms",
+           this->options_.baud_rate, this->options_.duration_ms, this->options_.loop_interval_ms,
+           this->options_.rx_buffer_size, this->options_.sets_per_second, this->options_.query_period_ms);
+  ESP_LOGI(TAG, "Frames sent by the MCU: %u, received: %u, dropped: %u, checksum errors: %u", results.frames_sent,
+           results.frames_received, results.get_dropped_frames(), results.checksum_errors);
+  ESP_LOGI(TAG, "Rx buffer: high water %zu bytes, %u bytes dropped, unhandled input high water %zu bytes",
+           results.rx_buffer_high_water, results.rx_bytes_dropped, results.rx_message_high_water);
+  ESP_LOGI(TAG, "Sets: %u, delivered: %u, command queue high water: %u, response timeouts: %u", results.sets,
+           results.sets_delivered, results.command_queue_high_water, results.response_timeouts);
+  ESP_LOGI(TAG, "Loop: %s", percentiles_to_string(results.poll_us).c_str());
+  ESP_LOGI(TAG, "rx_to_dispatch: %s", percentiles_to_string(results.rx_to_dispatch_us).c_str());
+  ESP_LOGI(TAG, "set_to_tx: %s", percentiles_to_string(results.set_to_tx_us).c_str());
+  ESP_LOGI(TAG, "tx_to_report: %s", percentiles_to_string(results.tx_to_report_us).c_str());
+}
+
+const std::vector<std::string>& StressTest::get_metric_names()
+{
+  static const std::vector<std::string> NAMES = []
+  {
+    std::vector<std::string> names;
+    for (const auto& metric : METRICS)
+    {
+      names.emplace_back(metric.name);
+    }
+    return names;
+  }();
+  return NAMES;
+}
+
+std::optional<uint32_t> StressTest::get_metric(const std::string& metric) const
+{
+  for (const auto& definition : METRICS)
+  {
+    if (metric == definition.name)
+    {
+      return definition.get(this->results_);
+    }
+  }
+  return {};
+}
+
+bool StressTest::check_budgets(const std::vector<Budget>& budgets) const
+{
+  bool within = true;
+  for (const auto& budget : budgets)
+  {
+    const auto value = this->get_metric(budget.metric);
+    if (!value.has_value())
+    {
+      ESP_LOGE(TAG, "Unknown metric %s", budget.metric.c_str());
+      within = false;
+    }
+    else if (*value > budget.limit)
+    {
+      ESP_LOGE(TAG, "Budget exceeded: %s = %u > %u", budget.metric.c_str(), *value, budget.limit);
+      within = false;
+    }
+  }
+  return within;
+}
+
+}
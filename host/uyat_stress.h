@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "uyat_timing_histogram.h"
+#include "uyat_trace_events.h"
+
+namespace esphome::uyat::host
+{
+
+// Sustained load on the protocol core: the simulated MCU (McuSimulator) reports datapoints back to back,
+// at the line rate of the baud rate, and answers the full dumps (DATAPOINT_QUERY) the module asks for
+// every now and then, while the module sets datapoints at a high rate.
+//
+// Runs on a simulated clock, as fast as possible. The bytes go through a uart rx buffer of the given size,
+// which is read by the polls at the loop interval like on the device - the bytes arriving while it's full
+// are lost. Only the poll durations are measured on the wall clock.
+class StressTest
+{
+public:
+  struct Options
+  {
+    uint32_t baud_rate{115200};
+    uint32_t duration_ms{10000};
+    uint32_t loop_interval_ms{16};     // between the polls, like the esphome main loop
+    std::size_t rx_buffer_size{256};  // the uart rx buffer, 256 by default in esphome
+    uint32_t sets_per_second{20};
+    uint32_t query_period_ms{1000};  // 0 for no DATAPOINT_QUERY
+    // time the core keeps running after the load stopped, for the queued commands to be sent
+    uint32_t drain_ms{3000};
+    // receives the timeline of the core, needs UYAT_TRACE_EVENTS_ENABLED
+    UyatTraceEvents* trace_events{nullptr};
+  };
+
+  struct Results
+  {
+    uint32_t frames_sent{0};      // by the MCU
+    uint32_t frames_received{0};  // by the core
+    uint32_t checksum_errors{0};
+    uint32_t rx_bytes_dropped{0};  // rx buffer overflow
+    std::size_t rx_buffer_high_water{0};
+    std::size_t rx_message_high_water{0};  // the bytes waiting to be handled by the core
+    uint32_t command_queue_high_water{0};
+    uint32_t sets{0};
+    uint32_t sets_delivered{0};  // the datapoints received by the MCU
+    uint32_t response_timeouts{0};
+    TimingHistogram poll_us;  // wall clock
+    // simulated clock, see UyatLatencyTracker
+    TimingHistogram rx_to_dispatch_us;
+    TimingHistogram set_to_tx_us;
+    TimingHistogram tx_to_report_us;
+
+    uint32_t get_dropped_frames() const
+    {
+      return (this->frames_sent > this->frames_received) ? (this->frames_sent - this->frames_received) : 0u;
+    }
+
+    uint32_t get_undelivered_sets() const
+    {
+      return (this->sets > this->sets_delivered) ? (this->sets - this->sets_delivered) : 0u;
+    }
+  };
+
+  // a limit of one of the metrics, see get_metric_names()
+  struct Budget
+  {
+    std::string metric;
+    uint32_t limit;
+  };
+
+  explicit StressTest(const Options& options);
+
+  const Results& run();
+
+  const Results& get_results() const
+  {
+    return this->results_;
+  }
+
+  void log_results() const;
+
+  static const std::vector<std::string>& get_metric_names();
+  std::optional<uint32_t> get_metric(const std::string& metric) const;
+
+  // logs the exceeded budgets, returns false if there was any
+  bool check_budgets(const std::vector<Budget>& budgets) const;
+
+protected:
+  const Options options_;
+  Results results_;
+};
+
+}
@@ -0,0 +1,152 @@
+// Sustained load on the protocol core, see StressTest.
+//
+//   uyat_stress [-b baud] [-d duration_ms] [-l loop_ms] [-u rx_buffer] [-s sets_per_s] [-q query_ms]
+//               [-B metric=limit]... [-t trace.json] [-v]
+//
+// Logs the results, exits with 1 when one of the budgets (-B) is exceeded. -t writes the timeline of
+// the core as a Chrome trace (see ChromeTraceWriter).
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "uyat_chrome_trace.h"
+#include "uyat_host_platform.h"
+#include "uyat_stress.h"
+
+using namespace esphome::uyat;
+
+static int usage(const char* program)
+{
+  fprintf(stderr,
+          "usage: %s [-b baud] [-d duration_ms] [-l loop_ms] [-u rx_buffer] [-s sets_per_s] [-q query_ms]\n"
+          "          [-B metric=limit]... [-t trace.json] [-v]\n"
+          "  -b  baud rate of the line the MCU floods (115200)\n"
+          "  -d  duration of the load in ms (10000)\n"
+          "  -l  interval of the polls in ms, the esphome loop (16)\n"
+          "  -u  size of the uart rx buffer in bytes (256)\n"
+          "  -s  datapoints set per second by the module (20)\n"
+          "  -q  interval of the DATAPOINT_QUERY full dumps in ms, 0 for none (1000)\n"
+          "  -B  fail when the metric exceeds the limit, metrics:\n",
+          program);
+  for (const auto& metric : host::StressTest::get_metric_names())
+  {
+    fprintf(stderr, "        %s\n", metric.c_str());
+  }
+  fprintf(stderr,
+          "  -t  write the frames, the dispatch to the listeners and the response waits as a Chrome trace\n"
+          "  -v  log the protocol at the verbose level\n");
+  return 2;
+}
+
+static bool parse_number(const char* text, uint32_t& value)
+{
+  char* end = nullptr;
+  const auto parsed = strtoul(text, &end, 10);
+  if ((end == text) || (*end != 0) || (parsed > UINT32_MAX))
+  {
+    return false;
+  }
+  value = static_cast<uint32_t>(parsed);
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  host::StressTest::Options options;
+  std::vector<host::StressTest::Budget> budgets;
+  uint32_t rx_buffer_size = options.rx_buffer_size;
+  std::string trace_path;
+  int opt;
+  host::set_log_level(ESPHOME_LOG_LEVEL_WARN);
+  while ((opt = getopt(argc, argv, "b:d:l:u:s:q:B:t:v")) != -1)
+  {
+    bool valid = true;
+    switch (opt)
+    {
+      case 'b':
+        valid = parse_number(optarg, options.baud_rate);
+        break;
+      case 'd':
+        valid = parse_number(optarg, options.duration_ms);
+        break;
+      case 'l':
+        valid = parse_number(optarg, options.loop_interval_ms);
+        break;
+      case 'u':
+        valid = parse_number(optarg, rx_buffer_size);
+        break;
+      case 's':
+        valid = parse_number(optarg, options.sets_per_second);
+        break;
+      case 'q':
+        valid = parse_number(optarg, options.query_period_ms);
+        break;
+      case 'B':
+      {
+        const std::string budget = optarg;
+        const auto separator = budget.find('=');
+        host::StressTest::Budget parsed{budget.substr(0u, separator), 0u};
+        valid = (separator != std::string::npos) && parse_number(budget.c_str() + separator + 1u, parsed.limit);
+        budgets.push_back(parsed);
+        break;
+      }
+      case 't':
+        trace_path = optarg;
+        break;
+      case 'v':
+        host::set_log_level(ESPHOME_LOG_LEVEL_VERBOSE);
+        break;
+      default:
+        valid = false;
+        break;
+    }
+    if (!valid)
+    {
+      return usage(argv[0]);
+    }
+  }
+  if (optind != argc)
+  {
+    return usage(argv[0]);
+  }
+  options.rx_buffer_size = rx_buffer_size;
+
+  std::ofstream trace_file;
+  std::unique_ptr<host::ChromeTraceWriter> trace;
+  if (!trace_path.empty())
+  {
+#ifdef UYAT_TRACE_EVENTS_ENABLED
+    trace_file.open(trace_path);
+    if (!trace_file)
+    {
+      fprintf(stderr, "can't write %s\n", trace_path.c_str());
+      return 1;
+    }
+    trace = std::make_unique<host::ChromeTraceWriter>(trace_file);
+    options.trace_events = trace.get();
+#else
+    fprintf(stderr, "-t needs the UYAT_TRACE_EVENTS build option\n");
+    return 2;
+#endif
+  }
+
+  host::StressTest test(options);
+  test.run();
+  if (trace)
+  {
+    trace->finish();
+  }
+  // the results are the point of the tool, logged regardless of the log level
+  const auto log_level = host::get_log_level();
+  host::set_log_level(ESPHOME_LOG_LEVEL_INFO);
+  test.log_results();
+  const bool within_budgets = test.check_budgets(budgets);
+  host::set_log_level(log_level);
+  return within_budgets ? 0 : 1;
+}